@@ -25,6 +25,7 @@ namespace config {
 Option<bool> DynarecEnabled("Dynarec.Enabled", true);
 Option<bool> DynarecIdleSkip("Dynarec.idleskip", true);
 Option<bool> DynarecSafeMode("Dynarec.safe-mode");
+Option<bool> DynarecSuperblocks("Dynarec.Superblocks", true);
 
 // General
 
@@ -54,6 +55,8 @@ Option<bool> AutoLatency("aica.AutoLatency",
 		false
 #endif
 		);
+Option<bool> ThreadedAica("aica.Threaded");
+Option<int> AicaSyncWindow("aica.SyncWindow", 4);
 
 OptionString AudioBackend("backend", "auto", "audio");
 AudioVolumeOption AudioVolume;
@@ -98,6 +101,7 @@ Option<bool> VSync("rend.vsync", true);
 Option<u64> PixelBufferSize("rend.PixelBufferSize", 512 * 1024 * 1024);
 Option<int> AnisotropicFiltering("rend.AnisotropicFiltering", 1);
 Option<bool> ThreadedRendering("rend.ThreadedRendering", true);
+Option<bool> ShaderPrecompile("rend.ShaderPrecompile", true);
 
 // Misc
 
@@ -105,6 +109,9 @@ Option<bool> SerialConsole("Debug.SerialConsoleEnabled");
 Option<bool> SerialPTY("Debug.SerialPTY");
 Option<bool> UseReios("UseReios");
 Option<bool> FastGDRomLoad("FastGDRomLoad", false);
+Option<bool> InstantGDRomLoad("InstantGDRomLoad", false);
+Option<bool> GDRomReadAhead("GDRomReadAhead", true);
+Option<bool> PreDecryptRoms("PreDecryptRoms", false);
 
 Option<bool> OpenGlChecks("OpenGlChecks", false, "validate");
 
@@ -347,6 +347,7 @@ using OptionString = Option<std::string>;
 extern Option<bool> DynarecEnabled;
 extern Option<bool> DynarecIdleSkip;
 extern Option<bool> DynarecSafeMode;
+extern Option<bool> DynarecSuperblocks;
 
 // General
 
@@ -367,6 +368,8 @@ extern Option<bool> DSPEnabled;
 extern Option<bool> DisableSound;
 extern Option<int> AudioBufferSize;	//In samples ,*4 for bytes
 extern Option<bool> AutoLatency;
+extern Option<bool> ThreadedAica;
+extern Option<int> AicaSyncWindow;	// max number of 32-sample batches the AICA thread can lag behind
 
 extern OptionString AudioBackend;
 
@@ -473,6 +476,7 @@ extern Option<bool> VSync;
 extern Option<u64> PixelBufferSize;
 extern Option<int> AnisotropicFiltering;
 extern Option<bool> ThreadedRendering;
+extern Option<bool> ShaderPrecompile;
 
 // Misc
 
@@ -480,6 +484,9 @@ extern Option<bool> SerialConsole;
 extern Option<bool> SerialPTY;
 extern Option<bool> UseReios;
 extern Option<bool> FastGDRomLoad;
+extern Option<bool> InstantGDRomLoad;
+extern Option<bool> GDRomReadAhead;
+extern Option<bool> PreDecryptRoms;
 
 extern Option<bool> OpenGlChecks;
 
@@ -533,6 +533,8 @@ static void *dc_run_thread(void*)
 		sh4_cpu.Stop();
 		lastError = e.what();
 	}
+	// The aica thread may still be pushing samples
+	libAICA_Sync();
 
     TermAudio();
 
@@ -707,9 +709,7 @@ bool dc_loadstate(const void **data, u32 size)
 	aicaarm::recompiler::flush();
 #endif
 	mmu_flush_table();
-#if FEAT_SHREC != DYNAREC_NONE
 	bm_Reset();
-#endif
 
 	u32 usedSize = 0;
 	if (!dc_unserialize((void **)data, &usedSize))
@@ -7,6 +7,13 @@
 #include "hw/sh4/sh4_sched.h"
 #include "hw/arm7/arm7.h"
 #include "hw/arm7/arm_mem.h"
+#include "hw/mem/_vmem.h"
+#include "cfg/option.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 
 #define SH4_IRQ_BIT (1 << (holly_SPU_IRQ & 31))
 
@@ -66,10 +73,9 @@ static void update_arm_interrupts()
 }
 
 //sh4 side
-static void UpdateSh4Ints()
+static void SetSh4Interrupt(bool pending)
 {
-	u32 p_ints = MCIEB->full & MCIPD->full;
-	if (p_ints)
+	if (pending)
 	{
 		if ((SB_ISTEXT & SH4_IRQ_BIT) == 0)
 			//if no interrupt is already pending then raise one :)
@@ -82,15 +88,143 @@ static void UpdateSh4Ints()
 	}
 }
 
+static void RunBatch()
+{
+	aicaarm::run(32);
+	if (!settings.aica.NoBatch)
+		AICA_Sample32();
+}
+
+//Threaded mode
+//The arm7, sound generator and dsp run on their own thread, at most config::AicaSyncWindow batches behind the sh4.
+//Batches are posted by the sh4 scheduler so the aica never runs ahead. The sh4 waits for the aica thread
+//to catch up before accessing the aica registers or wave memory, so that it sees the same state as in inline mode.
+//The sh4 views of the wave memory are protected while the thread runs so that the dynarecs don't access it directly.
+//Interrupts raised by the aica thread are delivered to the sh4 on the next batch or sync.
+namespace aicathread
+{
+static std::thread thread;
+static std::mutex mutex;
+static std::condition_variable cond;
+static std::atomic<u32> pending;	// batches posted and not yet completed
+static bool stopping;
+static bool active;					// only changed on the sh4 thread
+// sh4 interrupt state requested by the aica thread: -1 unchanged, 0 cancel, 1 raise
+static std::atomic<int> sh4Interrupt;
+
+static bool onThread()
+{
+	return active && std::this_thread::get_id() == thread.get_id();
+}
+
+static void threadMain()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	for (;;)
+	{
+		cond.wait(lock, []() { return pending > 0 || stopping; });
+		if (pending == 0)
+			break;
+		lock.unlock();
+		RunBatch();
+		lock.lock();
+		pending--;
+		cond.notify_all();
+	}
+}
+
+static void deliverInterrupts()
+{
+	int irq = sh4Interrupt.exchange(-1);
+	if (irq != -1)
+		SetSh4Interrupt(irq == 1);
+}
+
+static void start()
+{
+	verify(!active);
+	pending = 0;
+	stopping = false;
+	sh4Interrupt = -1;
+	_vmem_protect_aram(true);
+	thread = std::thread(threadMain);
+	active = true;
+	INFO_LOG(AICA, "AICA thread started");
+}
+
+static void stop()
+{
+	if (!active)
+		return;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	cond.notify_all();
+	thread.join();
+	active = false;
+	_vmem_protect_aram(false);
+	deliverInterrupts();
+	INFO_LOG(AICA, "AICA thread stopped");
+}
+
+static void post()
+{
+	u32 window = std::max(1, (int)config::AicaSyncWindow);
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		cond.wait(lock, [window]() { return pending < window; });
+		pending++;
+	}
+	cond.notify_all();
+	deliverInterrupts();
+}
+
+static void sync()
+{
+	if (pending != 0)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		cond.wait(lock, []() { return pending == 0; });
+	}
+	deliverInterrupts();
+}
+}
+
+static void UpdateSh4Ints()
+{
+	u32 p_ints = MCIEB->full & MCIPD->full;
+	if (aicathread::onThread())
+		aicathread::sh4Interrupt = p_ints != 0 ? 1 : 0;
+	else
+		SetSh4Interrupt(p_ints != 0);
+}
+
+//Waits for the aica thread to complete all the posted batches.
+//Must be called by the sh4 thread before accessing the aica state.
+void libAICA_Sync()
+{
+	if (aicathread::active && !aicathread::onThread())
+		aicathread::sync();
+}
+
 AicaTimer timers[3];
 int aica_schid = -1;
 const int AICA_TICK = 145125;	// 44.1 KHz / 32
 
 static int AicaUpdate(int tag, int c, int j)
 {
-	aicaarm::run(32);
-	if (!settings.aica.NoBatch)
-		AICA_Sample32();
+	if (config::ThreadedAica)
+	{
+		if (!aicathread::active)
+			aicathread::start();
+		aicathread::post();
+	}
+	else
+	{
+		aicathread::stop();
+		RunBatch();
+	}
 
 	return AICA_TICK;
 }
@@ -270,9 +404,13 @@ void libAICA_Reset(bool hard)
 {
 	if (hard)
 	{
+		// the memory mappings may be recreated before the next batch
+		aicathread::stop();
 		init_mem();
 		sgc_Init();
 	}
+	else
+		libAICA_Sync();
 	for (u32 i = 0; i < 3; i++)
 		timers[i].Init(aica_reg, i);
 	aica_Reset(hard);
@@ -280,6 +418,7 @@ void libAICA_Reset(bool hard)
 
 void libAICA_Term()
 {
+	aicathread::stop();
 	sgc_Term();
 	term_mem();
 }
@@ -88,6 +88,7 @@ void WriteMem_aica_rtc(u32 addr, u32 data, u32 sz)
 
 u32 ReadMem_aica_reg(u32 addr, u32 sz)
 {
+	libAICA_Sync();
 	addr &= 0x7FFF;
 	if (sz == 1)
 	{
@@ -115,6 +116,7 @@ static void ArmSetRST()
 
 void WriteMem_aica_reg(u32 addr,u32 data,u32 sz)
 {
+	libAICA_Sync();
 	addr &= 0x7FFF;
 
 	if (sz == 1)
@@ -358,6 +360,7 @@ static void Write_SB_ADST(u32 addr, u32 data)
 			else
 				DEBUG_LOG(AICA, "AICA-DMA : SB_ADDIR==0:DMA Write to 0x%X from 0x%X %x bytes", dst, src, SB_ADLEN);
 
+			libAICA_Sync();
 			WriteMemBlock_nommu_dma(dst, src, len);
 
 			// indicate that dma is in progress
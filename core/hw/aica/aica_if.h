@@ -22,3 +22,4 @@ s32 libAICA_Init();
 void libAICA_Reset(bool hard);
 void libAICA_Term();
 void libAICA_TimeStep();
+void libAICA_Sync();
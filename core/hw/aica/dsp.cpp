@@ -21,6 +21,7 @@ namespace dsp
 {
 
 DSPState state;
+StepInfo stepInfo[128];
 
 //float format is ?
 u16 DYNACALL PACK(s32 val)
@@ -96,6 +97,60 @@ void DecodeInst(const u32 *IPtr, Instruction *i)
 	i->NXADR = IPtr[3] & 0x80;
 }
 
+static bool readsShifted(const Instruction& op, const StepInfo& info, int step)
+{
+	return op.TWT || op.EWT || info.frcUsed || (info.adrsUsed && op.SHIFT == 3)
+			|| ((step & 1) && op.MWT);
+}
+
+// FRC_REG, Y_REG, ADRS_REG and ACC are reset at the start of each sample, so
+// their liveness only depends on the program. TEMP, MEMS, memory, EFREG and MEMVAL
+// are either persistent or visible outside of the DSP and are always considered live.
+void AnalyseProgram()
+{
+	bool accLive = false;
+	bool frcLive = false;
+	bool yregLive = false;
+	bool adrsLive = false;
+
+	for (int step = 127; step >= 0; step--)
+	{
+		Instruction op;
+		DecodeInst(&DSPData->MPRO[step * 4], &op);
+		StepInfo& info = stepInfo[step];
+		bool memOp = (step & 1) && (op.MRD || op.MWT);
+
+		// ACC is only read by the next step
+		info.accUsed = accLive;
+		// registers are written after being read in the same step
+		info.frcUsed = op.FRCL && frcLive;
+		if (op.FRCL)
+			frcLive = false;
+		info.yregUsed = op.YRL && yregLive;
+		if (op.YRL)
+			yregLive = false;
+		info.adrsUsed = op.ADRL && adrsLive;
+		if (op.ADRL)
+			adrsLive = false;
+
+		info.inputsUsed = (op.XSEL && info.accUsed) || info.yregUsed || (info.adrsUsed && op.SHIFT != 3);
+		info.nop = !info.accUsed && !info.frcUsed && !info.yregUsed && !info.adrsUsed
+				&& !op.TWT && !op.IWT && !op.EWT && !memOp;
+
+		if (info.accUsed)
+		{
+			if (op.YSEL == 0)
+				frcLive = true;
+			else if (op.YSEL >= 2)
+				yregLive = true;
+		}
+		if (memOp && op.ADREB)
+			adrsLive = true;
+		// ACC computed by the previous step is read by the shifter or by B
+		accLive = !info.nop && (readsShifted(op, info, step) || (info.accUsed && !op.ZERO && op.BSEL));
+	}
+}
+
 #if FEAT_DSPREC == DYNAREC_NONE
 void recInit() {
 }
@@ -139,7 +194,10 @@ void step()
 				break;
 			}
 		if (!state.stopped)
+		{
+			AnalyseProgram();
 			recompile();
+		}
 	}
 	if (state.stopped)
 		return;
@@ -70,6 +70,7 @@ void writeProg(u32 addr);
 void recInit();
 void runStep();
 void recompile();
+void runStepInterpreter();
 
 struct Instruction
 {
@@ -102,7 +103,20 @@ struct Instruction
 	bool NXADR; //MRQ set
 };
 
+// Result of the dataflow analysis of the microprogram
+struct StepInfo
+{
+	bool nop;			// step has no observable effect and can be skipped
+	bool accUsed;		// ACC computed by this step is read by the next step
+	bool inputsUsed;	// INPUTS is used by this step
+	bool frcUsed;		// FRC_REG written by this step is read by a later step
+	bool yregUsed;		// Y_REG written by this step is read by a later step
+	bool adrsUsed;		// ADRS_REG written by this step is read by a later step
+};
+extern StepInfo stepInfo[128];
+
 void DecodeInst(const u32 *IPtr, Instruction *i);
+void AnalyseProgram();
 u16 DYNACALL PACK(s32 val);
 s32 DYNACALL UNPACK(u16 val);
 
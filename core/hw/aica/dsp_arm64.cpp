@@ -98,12 +98,19 @@ public:
 
 		for (int step = 0; step < 128; ++step)
 		{
+			const StepInfo& info = stepInfo[step];
+			if (info.nop)
+				continue;
 			u32 *mpro = &DSPData->MPRO[step * 4];
 			Instruction op;
 			DecodeInst(mpro, &op);
 			const u32 COEF = step;
+			// drop writes to registers that are never read
+			op.FRCL = info.frcUsed;
+			op.YRL = info.yregUsed;
+			op.ADRL = info.adrsUsed;
 
-			if (op.XSEL || op.YRL || (op.ADRL && op.SHIFT != 3))
+			if (info.inputsUsed)
 			{
 				if (op.IRA <= 0x1f)
 					//INPUTS = DSP->MEMS[op.IRA];
@@ -133,72 +140,6 @@ public:
 				Str(w1, dsp_operand(DSP->MEMS, op.IWA));
 			}
 
-			// Operand sel
-			// B
-			if (!op.ZERO)
-			{
-				if (op.BSEL)
-					//B = ACC;
-					Mov(B, ACC);
-				else
-				{
-					//B = DSP->TEMP[(TRA + DSP->MDEC_CT) & 0x7F];
-					if (op.TRA)
-						Add(w1, MDEC_CT, op.TRA);
-					else
-						Mov(w1, MDEC_CT);
-					Bfc(w1, 7, 25);
-					Ldr(B, dsp_operand(DSP->TEMP, x1));
-				}
-				if (op.NEGB)
-					//B = 0 - B;
-					Neg(B, B);
-			}
-
-			// X
-			const Register* X_alias = &X;
-			if (op.XSEL)
-				//X = INPUTS;
-				X_alias = &INPUTS;
-			else
-			{
-				//X = DSP->TEMP[(TRA + DSP->MDEC_CT) & 0x7F];
-				if (!op.ZERO && !op.BSEL && !op.NEGB)
-					X_alias = &B;
-				else
-				{
-					if (op.TRA)
-						Add(w1, MDEC_CT, op.TRA);
-					else
-						Mov(w1, MDEC_CT);
-					Bfc(w1, 7, 25);
-					Ldr(X, dsp_operand(DSP->TEMP, x1));
-				}
-			}
-
-			// Y
-			if (op.YSEL == 0)
-			{
-				//Y = FRC_REG;
-				Mov(Y, FRC_REG);
-			}
-			else if (op.YSEL == 1)
-			{
-				//Y = DSPData->COEF[COEF] >> 3;	//COEF is 16 bits
-				Ldr(Y, dspdata_operand(DSPData->COEF, COEF));
-				Sbfx(Y, Y, 3, 13);
-			}
-			else if (op.YSEL == 2)
-				//Y = Y_REG >> 11;
-				Asr(Y, Y_REG, 11);
-			else if (op.YSEL == 3)
-				//Y = (Y_REG >> 4) & 0x0FFF;
-				Ubfx(Y, Y_REG, 4, 12);
-
-			if (op.YRL)
-				//Y_REG = INPUTS;
-				Mov(Y_REG, INPUTS);
-
 			if (op.TWT || op.FRCL || op.MWT || (op.ADRL && op.SHIFT == 3) || op.EWT)
 			{
 				// Shifter
@@ -239,19 +180,89 @@ public:
 				}
 			}
 
-			// ACCUM
-			//ACC = (((s64)X * (s64)Y) >> 12) + B;
-			const Register& X64 = Register::GetXRegFromCode(X_alias->GetCode());
-			const Register& Y64 = Register::GetXRegFromCode(Y.GetCode());
-			Sxtw(X64, *X_alias);
-			Sxtw(Y64, Y);
-			Mul(x0, X64, Y64);
-			Asr(x0, x0, 12);
-			if (op.ZERO)
-				Mov(ACC, w0);
-			else
-				Add(ACC, w0, B);
+			// The accumulator is only computed if the next step uses it.
+			// This must be done after the shifter since it overwrites ACC, and before YRL.
+			if (info.accUsed)
+			{
+				// Operand sel
+				// B
+				if (!op.ZERO)
+				{
+					if (op.BSEL)
+						//B = ACC;
+						Mov(B, ACC);
+					else
+					{
+						//B = DSP->TEMP[(TRA + DSP->MDEC_CT) & 0x7F];
+						if (op.TRA)
+							Add(w1, MDEC_CT, op.TRA);
+						else
+							Mov(w1, MDEC_CT);
+						Bfc(w1, 7, 25);
+						Ldr(B, dsp_operand(DSP->TEMP, x1));
+					}
+					if (op.NEGB)
+						//B = 0 - B;
+						Neg(B, B);
+				}
+
+				// X
+				const Register* X_alias = &X;
+				if (op.XSEL)
+					//X = INPUTS;
+					X_alias = &INPUTS;
+				else
+				{
+					//X = DSP->TEMP[(TRA + DSP->MDEC_CT) & 0x7F];
+					if (!op.ZERO && !op.BSEL && !op.NEGB)
+						X_alias = &B;
+					else
+					{
+						if (op.TRA)
+							Add(w1, MDEC_CT, op.TRA);
+						else
+							Mov(w1, MDEC_CT);
+						Bfc(w1, 7, 25);
+						Ldr(X, dsp_operand(DSP->TEMP, x1));
+					}
+				}
 
+				// Y
+				if (op.YSEL == 0)
+				{
+					//Y = FRC_REG;
+					Mov(Y, FRC_REG);
+				}
+				else if (op.YSEL == 1)
+				{
+					//Y = DSPData->COEF[COEF] >> 3;	//COEF is 16 bits
+					Ldr(Y, dspdata_operand(DSPData->COEF, COEF));
+					Sbfx(Y, Y, 3, 13);
+				}
+				else if (op.YSEL == 2)
+					//Y = Y_REG >> 11;
+					Asr(Y, Y_REG, 11);
+				else if (op.YSEL == 3)
+					//Y = (Y_REG >> 4) & 0x0FFF;
+					Ubfx(Y, Y_REG, 4, 12);
+
+				// ACCUM
+				//ACC = (((s64)X * (s64)Y) >> 12) + B;
+				const Register& X64 = Register::GetXRegFromCode(X_alias->GetCode());
+				const Register& Y64 = Register::GetXRegFromCode(Y.GetCode());
+				Sxtw(X64, *X_alias);
+				Sxtw(Y64, Y);
+				Mul(x0, X64, Y64);
+				Asr(x0, x0, 12);
+				if (op.ZERO)
+					Mov(ACC, w0);
+				else
+					Add(ACC, w0, B);
+			}
+
+			if (op.YRL)
+				//Y_REG = INPUTS;
+				Mov(Y_REG, INPUTS);
 			if (op.TWT)
 			{
 				//DSP->TEMP[(op.TWA + DSP->MDEC_CT) & 0x7F] = SHIFTED;
@@ -6,9 +6,6 @@
 //
 
 #include "build.h"
-
-#if FEAT_DSPREC != DYNAREC_JIT
-
 #include "dsp.h"
 #include "aica.h"
 #include "aica_if.h"
@@ -16,7 +13,8 @@
 namespace dsp
 {
 
-void runStep()
+// Also built with the recompilers, as the reference they are tested against
+void runStepInterpreter()
 {
 	if (state.stopped)
 		return;
@@ -27,13 +25,15 @@ void runStep()
 	s32 Y = 0;			//13 bit
 	s32 B = 0;			//26 bit
 	s32 INPUTS = 0;		//24 bit
-	s32 MEMVAL[4] = {0};
+	s32 *MEMVAL = state.MEMVAL;	// the memory read pipeline carries over to the next sample
 	s32 FRC_REG = 0;	//13 bit
 	s32 Y_REG = 0;		//24 bit
 	u32 ADRS_REG = 0;	//13 bit
 
 	for (int step = 0; step < 128; ++step)
 	{
+		if (stepInfo[step].nop)
+			continue;
 		u32 *IPtr = DSPData->MPRO + step * 4;
 
 		if (IPtr[0] == 0 && IPtr[1] == 0 && IPtr[2] == 0 && IPtr[3] == 0)
@@ -214,5 +214,11 @@ void runStep()
 		state.MDEC_CT = state.RBL + 1;		// RBL is ring buffer length - 1
 }
 
+#if FEAT_DSPREC != DYNAREC_JIT
+void runStep()
+{
+	runStepInterpreter();
 }
 #endif
+
+}
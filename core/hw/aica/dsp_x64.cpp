@@ -91,12 +91,19 @@ public:
 
 		for (int step = 0; step < 128; ++step)
 		{
+			const StepInfo& info = stepInfo[step];
+			if (info.nop)
+				continue;
 			u32 *mpro = &DSPData->MPRO[step * 4];
 			Instruction op;
 			DecodeInst(mpro, &op);
 			const u32 COEF = step;
+			// drop writes to registers that are never read
+			op.FRCL = info.frcUsed;
+			op.YRL = info.yregUsed;
+			op.ADRL = info.adrsUsed;
 
-			if (op.XSEL || op.YRL || (op.ADRL && op.SHIFT != 3))
+			if (info.inputsUsed)
 			{
 				if (op.IRA <= 0x1f)
 					//INPUTS = DSP->MEMS[op.IRA];
@@ -126,77 +133,6 @@ public:
 				mov(dword[rbx + dsp_operand(DSP->MEMS, op.IWA)], eax);
 			}
 
-			// Operand sel
-			// B
-			if (!op.ZERO)
-			{
-				if (op.BSEL)
-					//B = ACC;
-					mov(B, ACC);
-				else
-				{
-					//B = DSP->TEMP[(TRA + DSP->MDEC_CT) & 0x7F];
-					mov(eax, MDEC_CT);
-					if (op.TRA)
-						add(eax, op.TRA);
-					and_(eax, 0x7f);
-					mov(B, dword[rbx + rax * 4]);
-				}
-				if (op.NEGB)
-					//B = 0 - B;
-					neg(B);
-			}
-
-			// X
-			Xbyak::Reg32 X_alias = X;
-			if (op.XSEL)
-				//X = INPUTS;
-				X_alias = INPUTS;
-			else
-			{
-				//X = DSP->TEMP[(TRA + DSP->MDEC_CT) & 0x7F];
-				if (!op.ZERO && !op.BSEL && !op.NEGB)
-					X_alias = B;
-				else
-				{
-					mov(eax, MDEC_CT);
-					if (op.TRA)
-						add(eax, op.TRA);
-					and_(eax, 0x7f);
-					mov(X, dword[rbx + rax * 4]);
-				}
-			}
-
-			// Y
-			if (op.YSEL == 0)
-			{
-				//Y = FRC_REG;
-				mov(Y, dword[rbx + dsp_operand(&DSP->FRC_REG)]);
-			}
-			else if (op.YSEL == 1)
-			{
-				//Y = DSPData->COEF[COEF] >> 3;	//COEF is 16 bits
-				movsx(Y, word[rbp + dspdata_operand(DSPData->COEF, COEF)]);
-				sar(Y, 3);
-			}
-			else if (op.YSEL == 2)
-			{
-				//Y = Y_REG >> 11;
-				mov(Y, Y_REG);
-				sar(Y, 11);
-			}
-			else if (op.YSEL == 3)
-			{
-				//Y = (Y_REG >> 4) & 0x0FFF;
-				mov(Y, Y_REG);
-				sar(Y, 4);
-				and_(Y, 0x0fff);
-			}
-
-			if (op.YRL)
-				//Y_REG = INPUTS;
-				mov(Y_REG, INPUTS);
-
 			if (op.TWT || op.FRCL || op.MWT || (op.ADRL && op.SHIFT == 3) || op.EWT)
 			{
 				// Shifter
@@ -238,17 +174,92 @@ public:
 				// edx contains SHIFTED
 			}
 
-			// ACCUM
-			//ACC = (((s64)X * (s64)Y) >> 12) + B;
-			const Xbyak::Reg64 Xlong = X_alias.cvt64();
-			movsxd(Xlong, X_alias);
-			movsxd(rax, Y);
-			imul(rax, Xlong);
-			sar(rax, 12);
-			mov(ACC, eax);
-			if (!op.ZERO)
-				add(ACC, B);
+			// The accumulator is only computed if the next step uses it.
+			// This must be done after the shifter since it overwrites ACC, and before YRL.
+			if (info.accUsed)
+			{
+				// Operand sel
+				// B
+				if (!op.ZERO)
+				{
+					if (op.BSEL)
+						//B = ACC;
+						mov(B, ACC);
+					else
+					{
+						//B = DSP->TEMP[(TRA + DSP->MDEC_CT) & 0x7F];
+						mov(eax, MDEC_CT);
+						if (op.TRA)
+							add(eax, op.TRA);
+						and_(eax, 0x7f);
+						mov(B, dword[rbx + rax * 4]);
+					}
+					if (op.NEGB)
+						//B = 0 - B;
+						neg(B);
+				}
+
+				// X
+				Xbyak::Reg32 X_alias = X;
+				if (op.XSEL)
+					//X = INPUTS;
+					X_alias = INPUTS;
+				else
+				{
+					//X = DSP->TEMP[(TRA + DSP->MDEC_CT) & 0x7F];
+					if (!op.ZERO && !op.BSEL && !op.NEGB)
+						X_alias = B;
+					else
+					{
+						mov(eax, MDEC_CT);
+						if (op.TRA)
+							add(eax, op.TRA);
+						and_(eax, 0x7f);
+						mov(X, dword[rbx + rax * 4]);
+					}
+				}
 
+				// Y
+				if (op.YSEL == 0)
+				{
+					//Y = FRC_REG;
+					mov(Y, dword[rbx + dsp_operand(&DSP->FRC_REG)]);
+				}
+				else if (op.YSEL == 1)
+				{
+					//Y = DSPData->COEF[COEF] >> 3;	//COEF is 16 bits
+					movsx(Y, word[rbp + dspdata_operand(DSPData->COEF, COEF)]);
+					sar(Y, 3);
+				}
+				else if (op.YSEL == 2)
+				{
+					//Y = Y_REG >> 11;
+					mov(Y, Y_REG);
+					sar(Y, 11);
+				}
+				else if (op.YSEL == 3)
+				{
+					//Y = (Y_REG >> 4) & 0x0FFF;
+					mov(Y, Y_REG);
+					sar(Y, 4);
+					and_(Y, 0x0fff);
+				}
+
+				// ACCUM
+				//ACC = (((s64)X * (s64)Y) >> 12) + B;
+				const Xbyak::Reg64 Xlong = X_alias.cvt64();
+				movsxd(Xlong, X_alias);
+				movsxd(rax, Y);
+				imul(rax, Xlong);
+				sar(rax, 12);
+				mov(ACC, eax);
+				if (!op.ZERO)
+					add(ACC, B);
+			}
+
+			if (op.YRL)
+				//Y_REG = INPUTS;
+				mov(Y_REG, INPUTS);
 			if (op.TWT)
 			{
 				//DSP->TEMP[(op.TWA + DSP->MDEC_CT) & 0x7F] = SHIFTED;
@@ -275,7 +286,8 @@ public:
 			{
 				if (op.MRD || op.MWT)
 				{
-					if ((op.ADRL && op.SHIFT == 3) || op.EWT)
+					// SHIFTED is needed after the UNPACK call
+					if ((op.ADRL && op.SHIFT == 3) || op.EWT || (op.MRD && op.MWT))
 						push(rdx);
 					if (op.ADRL && op.SHIFT != 3)
 						push(INPUTS.cvt64());
@@ -293,6 +305,9 @@ public:
 				if (op.MWT)
 				{
 					// *(u16 *)&aica_ram[ADDR & ARAM_MASK] = PACK(SHIFTED);
+					if (op.MRD)
+						// SHIFTED saved above, INPUTS is pushed after it
+						mov(rdx, qword[rsp + (op.ADRL && op.SHIFT != 3 ? 8 : 0)]);
 					mov(call_arg0, edx);	// SHIFTED
 					GenCall(PACK);
 
@@ -304,7 +319,7 @@ public:
 				{
 					if (op.ADRL && op.SHIFT != 3)
 						pop(INPUTS.cvt64());
-					if ((op.ADRL && op.SHIFT == 3) || op.EWT)
+					if ((op.ADRL && op.SHIFT == 3) || op.EWT || (op.MRD && op.MWT))
 						pop(rdx);
 				}
 			}
@@ -154,9 +154,28 @@ static ArmOp decodeArmOp(u32 opcode, u32 arm_pc)
 	{
 	case 0:	// data processing, Multiply, Swap
 		// disambiguate
-		if ((bits.op_type & 4) == 0 && bits.imm_op == 0 && bits.shift_by_reg && bits._zero != 0)
+		if (bits.imm_op == 0 && bits.shift_by_reg && bits._zero != 0)
 		{
-			// MUL, MLA or SWP
+			// MUL, MLA
+			if ((opcode & 0x0FC000F0) == 0x00000090 && !bits.set_flags
+					&& bits.rn != 15 && bits.rm != 15 && bits.shift_reg != 15
+					&& (!(opcode & (1 << 21)) || bits.rd != 15))
+			{
+				op.op_type = (opcode & (1 << 21)) ? ArmOp::MLA : ArmOp::MUL;
+				op.rd = ArmOp::Operand((Arm7Reg)bits.rn);
+				op.arg[0] = ArmOp::Operand((Arm7Reg)bits.rm);
+				op.arg[1] = ArmOp::Operand((Arm7Reg)bits.shift_reg);
+				if (op.op_type == ArmOp::MLA)
+				{
+					op.arg[2] = ArmOp::Operand((Arm7Reg)bits.rd);
+					op.cycles++;
+				}
+				// Actual timing depends on the multiplier value (2 to 5 cycles). Assume small values.
+				op.cycles += 2;
+				return op;
+			}
+			// MULS, MLAS, SWP and the long multiplies, which would otherwise be
+			// decoded as data processing ops
 			op.op_type = ArmOp::FALLBACK;
 			op.arg[0] = ArmOp::Operand(opcode);
 			op.cycles = 0;
@@ -28,7 +28,7 @@ struct ArmOp
 	enum OpType {
 		AND, EOR, SUB, RSB, ADD, ADC, SBC, RSC,
 		TST, TEQ, CMP, CMN, ORR, MOV, BIC, MVN,
-		LDR, STR, B, BL, MSR, MRS, FALLBACK
+		LDR, STR, B, BL, MSR, MRS, MUL, MLA, FALLBACK
 	};
 	enum Condition {
 		EQ,	NE, CS, CC, MI, PL, VS, VC, HI, LS, GE, LT, GT, LE, AL, UC
@@ -154,7 +154,7 @@ struct ArmOp
 		static const std::string labels[] = {
 			"and", "eor", "sub", "rsb", "add", "adc", "sbc", "rsc",
 			"tst", "teq", "cmp", "cmn", "orr", "mov", "bic", "mvn",
-			"ldr", "str", "b", "bl", "msr", "mrs", "(fallback)",
+			"ldr", "str", "b", "bl", "msr", "mrs", "mul", "mla", "(fallback)",
 		};
 		std::string s = labels[(int)op_type];
 		if (op_type <= MVN)
@@ -206,6 +206,12 @@ struct ArmOp
 		}
 		else if (op_type == MRS)
 			s += conditionToString() + " " + operandToString(rd) + ", CPSR";
+		else if (op_type == MUL || op_type == MLA)
+		{
+			s += conditionToString() + " " + operandToString(rd) + ", " + operandToString(arg[0]) + ", " + operandToString(arg[1]);
+			if (op_type == MLA)
+				s += ", " + operandToString(arg[2]);
+		}
 
 		return s;
 	}
@@ -429,6 +435,7 @@ void DYNACALL interpret(u32 opcode);
 
 extern u8* icPtr;
 extern u8* ICache;
+extern void (*EntryPoints[ARAM_SIZE_MAX / 4])();
 const u32 ICacheSize = 1024 * 1024 * 4;
 
 static inline void *currentCode() {
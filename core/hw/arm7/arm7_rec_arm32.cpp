@@ -374,6 +374,17 @@ static void emitMSR(const ArmOp& op)
 		call((void *)recompiler::MSR_do<0>);
 }
 
+static void emitMulOp(const ArmOp& op)
+{
+	Register rd = regalloc->map(op.rd.getReg().armreg);
+	Register rm = regalloc->map(op.arg[0].getReg().armreg);
+	Register rs = regalloc->map(op.arg[1].getReg().armreg);
+	if (op.op_type == ArmOp::MLA)
+		ass.Mla(rd, rm, rs, regalloc->map(op.arg[2].getReg().armreg));
+	else
+		ass.Mul(rd, rm, rs);
+}
+
 static void emitFallback(const ArmOp& op)
 {
 	//Call interpreter
@@ -423,6 +434,8 @@ void arm7backend_compile(const std::vector<ArmOp>& block_ops, u32 cycles)
 			emitMRS(op);
 		else if (op.op_type == ArmOp::MSR)
 			emitMSR(op);
+		else if (op.op_type == ArmOp::MUL || op.op_type == ArmOp::MLA)
+			emitMulOp(op);
 		else if (op.op_type == ArmOp::FALLBACK)
 			emitFallback(op);
 		else
@@ -553,6 +553,17 @@ class Arm7Compiler : public MacroAssembler
 			call((void*)recompiler::MSR_do<0>);
 	}
 
+	void emitMulOp(const ArmOp& op)
+	{
+		const WRegister& rd = regalloc->map(op.rd.getReg().armreg);
+		const WRegister& rm = regalloc->map(op.arg[0].getReg().armreg);
+		const WRegister& rs = regalloc->map(op.arg[1].getReg().armreg);
+		if (op.op_type == ArmOp::MLA)
+			Madd(rd, rm, rs, regalloc->map(op.arg[2].getReg().armreg));
+		else
+			Mul(rd, rm, rs);
+	}
+
 	void emitFallback(const ArmOp& op)
 	{
 		set_flags = false;
@@ -605,6 +616,8 @@ public:
 				emitMRS(op);
 			else if (op.op_type == ArmOp::MSR)
 				emitMSR(op);
+			else if (op.op_type == ArmOp::MUL || op.op_type == ArmOp::MLA)
+				emitMulOp(op);
 			else if (op.op_type == ArmOp::FALLBACK)
 				emitFallback(op);
 			else
@@ -26,6 +26,7 @@
 using namespace Xbyak::util;
 
 #include "arm7_rec.h"
+#include "hw/aica/aica_if.h"
 #include "oslib/oslib.h"
 
 namespace aicaarm {
@@ -711,12 +712,56 @@ class Arm7Compiler : public Xbyak::CodeGenerator
 				mov(call_regs[1], regalloc->map(op.arg[2].getReg().armreg));
 		}
 
+		// Fast path: direct access to aica ram, same as ReadMemArm/WriteMemArm
+		Xbyak::Label slowPath;
+		Xbyak::Label done;
+		mov(eax, call_regs[0]);
+		test(eax, 0x00800000);
+		jnz(slowPath, T_NEAR);
+		and_(eax, dword[rip + &ARAM_MASK]);
+		if (!op.byte_xfer)
+			and_(eax, ~3);
+		mov(r8, qword[rip + &aica_ram.data]);
+		if (op.op_type == ArmOp::LDR)
+		{
+			if (op.byte_xfer)
+				movzx(eax, byte[r8 + rax]);
+			else
+			{
+				mov(eax, dword[r8 + rax]);
+				// unaligned word loads are rotated
+				mov(ecx, call_regs[0]);
+				and_(ecx, 3);
+				shl(ecx, 3);
+				ror(eax, cl);
+			}
+		}
+		else
+		{
+			if (op.byte_xfer)
+				mov(byte[r8 + rax], call_regs[1].cvt8());
+			else
+				mov(dword[r8 + rax], call_regs[1]);
+		}
+		jmp(done);
+
+		L(slowPath);
 		call(recompiler::getMemOp(op.op_type == ArmOp::LDR, op.byte_xfer));
 
+		L(done);
 		if (op.op_type == ArmOp::LDR)
 			mov(regalloc->map(op.rd.getReg().armreg), eax);
 	}
 
+	void emitMulOp(const ArmOp& op)
+	{
+		mov(eax, regalloc->map(op.arg[0].getReg().armreg));
+		imul(eax, regalloc->map(op.arg[1].getReg().armreg));
+		if (op.op_type == ArmOp::MLA)
+			add(eax, regalloc->map(op.arg[2].getReg().armreg));
+		mov(regalloc->map(op.rd.getReg().armreg), eax);
+	}
+
 	void saveFlags(bool save_v_flag)
 	{
 		if (!set_flags)
@@ -801,6 +846,44 @@ class Arm7Compiler : public Xbyak::CodeGenerator
 		call(recompiler::interpret);
 	}
 
+	// Jump directly to the next block if its address is known statically and the dispatcher
+	// would not do anything else. The jump goes through the entry point table so that
+	// successors compiled later (or flushed) are handled transparently.
+	void emitBlockLink(const std::vector<ArmOp>& block_ops)
+	{
+		std::vector<u32> targets;
+		for (const ArmOp& op : block_ops)
+		{
+			u32 target;
+			if ((op.op_type == ArmOp::B || op.op_type == ArmOp::BL) && op.arg[0].isImmediate())
+				target = op.arg[0].getImmediate();
+			else if (op.op_type == ArmOp::MOV && op.rd.isReg() && op.rd.getReg().armreg == R15_ARM_NEXT
+					&& op.arg[0].isImmediate() && !op.arg[0].isShifted())
+				target = op.arg[0].getImmediate();
+			else
+				continue;
+			if (std::find(targets.begin(), targets.end(), target) == targets.end())
+				targets.push_back(target);
+		}
+		if (!targets.empty())
+		{
+			cmp(dword[rip + &arm_Reg[CYCL_CNT]], 0);
+			jle((const void *)arm_dispatch);
+			cmp(dword[rip + &arm_Reg[INTR_PEND]], 0);
+			jne((const void *)arm_dispatch);
+			mov(eax, dword[rip + &arm_Reg[R15_ARM_NEXT]]);
+			for (u32 target : targets)
+			{
+				Xbyak::Label next;
+				cmp(eax, target);
+				jne(next);
+				jmp(qword[rip + &recompiler::EntryPoints[(target & 0x7ffffc) / 4]]);
+				L(next);
+			}
+		}
+		jmp((void*)arm_dispatch);
+	}
+
 public:
 	Arm7Compiler() : Xbyak::CodeGenerator(recompiler::spaceLeft(), recompiler::currentCode()) { }
 
@@ -851,6 +934,8 @@ public:
 				emitMRS(op);
 			else if (op.op_type == ArmOp::MSR)
 				emitMSR(op);
+			else if (op.op_type == ArmOp::MUL || op.op_type == ArmOp::MLA)
+				emitMulOp(op);
 			else if (op.op_type == ArmOp::FALLBACK)
 				emitFallback(op);
 			else
@@ -869,7 +954,7 @@ public:
 		}
 		endConditional(condLabel);
 
-		jmp((void*)arm_dispatch);
+		emitBlockLink(block_ops);
 
 		ready();
 		recompiler::advance(getSize());
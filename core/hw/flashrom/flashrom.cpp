@@ -17,6 +17,7 @@
     along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
  */
 #include "flashrom.h"
+#include "nvmem_file.h"
 #include "oslib/oslib.h"
 
 bool MemChip::Load(const std::string& file)
@@ -27,24 +28,34 @@ bool MemChip::Load(const std::string& file)
 		bool rv = std::fread(data + write_protect_size, 1, size - write_protect_size, f) == size - write_protect_size;
 		std::fclose(f);
 		if (rv)
+		{
 			this->load_filename = file;
+			saved_filename = file;
+			saved_data.assign(data + write_protect_size, data + size);
+		}
 
 		return rv;
 	}
 	return false;
 }
 
-void MemChip::Save(const std::string& file)
+bool MemChip::Save(const std::string& file)
 {
-	FILE *f = nowide::fopen(file.c_str(), "wb");
-	if (f == nullptr)
+	u32 len = size - write_protect_size;
+	if (file == saved_filename && saved_data.size() == len
+			&& memcmp(&saved_data[0], data + write_protect_size, len) == 0)
+	{
+		DEBUG_LOG(FLASHROM, "Flash file '%s' unchanged", file.c_str());
+		return false;
+	}
+	if (!writeFileAtomic(file, data + write_protect_size, len))
 	{
 		ERROR_LOG(FLASHROM, "Cannot save flash/nvmem to file '%s'", file.c_str());
-		return;
+		return false;
 	}
-	if (std::fwrite(data + write_protect_size, 1, size - write_protect_size, f) != size - write_protect_size)
-		ERROR_LOG(FLASHROM, "Failed or truncated write to flash file '%s'", file.c_str());
-	std::fclose(f);
+	saved_filename = file;
+	saved_data.assign(data + write_protect_size, data + size);
+	return true;
 }
 
 bool MemChip::Load(const std::string &prefix, const std::string &names_ro, const std::string &title)
@@ -62,6 +73,6 @@ bool MemChip::Load(const std::string &prefix, const std::string &names_ro, const
 void MemChip::Save(const std::string &prefix, const std::string &name_ro, const std::string &title)
 {
 	std::string path = hostfs::getFlashSavePath(prefix, name_ro);
-	Save(path);
-	INFO_LOG(FLASHROM, "Saved %s as %s", path.c_str(), title.c_str());
+	if (Save(path))
+		INFO_LOG(FLASHROM, "Saved %s as %s", path.c_str(), title.c_str());
 }
@@ -4,6 +4,7 @@
 
 #pragma once
 #include <cmath>
+#include <vector>
 #include "types.h"
 
 struct MemChip
@@ -13,6 +14,9 @@ struct MemChip
 	u32 mask;
 	u32 write_protect_size;
 	std::string load_filename;
+	// content of the file last loaded or saved, to skip unnecessary writes
+	std::string saved_filename;
+	std::vector<u8> saved_data;
 
 	MemChip(u32 size, u32 write_protect_size = 0)
 	{
@@ -50,7 +54,8 @@ struct MemChip
 	{
 		return Load(this->load_filename);
 	}
-	void Save(const std::string& file);
+	// Returns false if the content was unchanged and no write was needed
+	bool Save(const std::string& file);
 	bool Load(const std::string &prefix, const std::string &names_ro,
 			const std::string &title);
 	void Save(const std::string &prefix, const std::string &name_ro,
@@ -0,0 +1,171 @@
+/*
+	Copyright 2021 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "nvmem_file.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <thread>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <io.h>
+#include "nowide/convert.hpp"
+#elif !defined(__SWITCH__)
+#include <unistd.h>
+#endif
+
+// Delay without modification before the file is written
+constexpr std::chrono::milliseconds WriteDelay(500);
+// Delay before trying again after a write error
+constexpr std::chrono::seconds RetryDelay(5);
+
+static std::thread thread;
+static std::mutex mutex;
+static std::condition_variable cond;
+static bool stopping;
+static std::vector<NvmemFile *> files;
+
+static bool replaceFile(const std::string& from, const std::string& to)
+{
+#ifdef _WIN32
+	return MoveFileExW(nowide::widen(from).c_str(), nowide::widen(to).c_str(),
+			MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+	return std::rename(from.c_str(), to.c_str()) == 0;
+#endif
+}
+
+bool writeFileAtomic(const std::string& path, const u8 *data, size_t size)
+{
+	std::string tmpPath = path + ".tmp";
+	FILE *f = nowide::fopen(tmpPath.c_str(), "wb");
+	if (f == nullptr)
+		return false;
+	bool rc = std::fwrite(data, 1, size, f) == size && std::fflush(f) == 0;
+	// make sure the data is on disk before replacing the old file
+#ifdef _WIN32
+	rc = rc && _commit(_fileno(f)) == 0;
+#elif !defined(__SWITCH__)
+	rc = rc && fsync(fileno(f)) == 0;
+#endif
+	rc = std::fclose(f) == 0 && rc;
+	rc = rc && replaceFile(tmpPath, path);
+	if (!rc)
+		nowide::remove(tmpPath.c_str());
+
+	return rc;
+}
+
+NvmemFile::NvmemFile(const std::string& path, const u8 *data, u32 size)
+	: path(path), image(data, data + size)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	if (files.empty())
+	{
+		stopping = false;
+		thread = std::thread(threadMain);
+	}
+	files.push_back(this);
+}
+
+NvmemFile::~NvmemFile()
+{
+	bool last;
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		cond.wait(lock, [this]() { return !writing; });
+		writeBack(lock);
+		files.erase(std::find(files.begin(), files.end(), this));
+		last = files.empty();
+		if (last)
+			stopping = true;
+	}
+	if (last)
+	{
+		cond.notify_all();
+		thread.join();
+	}
+}
+
+void NvmemFile::update(const u8 *data, u32 offset, u32 len)
+{
+	verify(offset + len <= image.size());
+	std::lock_guard<std::mutex> lock(mutex);
+	memcpy(&image[offset], data + offset, len);
+	deadline = std::chrono::steady_clock::now() + WriteDelay;
+	if (!dirty)
+	{
+		dirty = true;
+		cond.notify_all();
+	}
+}
+
+void NvmemFile::flush()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	cond.wait(lock, [this]() { return !writing; });
+	writeBack(lock);
+}
+
+// mutex must be locked and no write in progress
+bool NvmemFile::writeBack(std::unique_lock<std::mutex>& lock)
+{
+	if (!dirty)
+		return false;
+	std::vector<u8> copy(image);
+	dirty = false;
+	writing = true;
+	lock.unlock();
+
+	bool rc = writeFileAtomic(path, &copy[0], copy.size());
+	if (rc)
+		DEBUG_LOG(FLASHROM, "Saved %s", path.c_str());
+	else
+		WARN_LOG(FLASHROM, "Failed to write %s", path.c_str());
+
+	lock.lock();
+	writing = false;
+	if (!rc && !dirty)
+	{
+		dirty = true;
+		deadline = std::chrono::steady_clock::now() + RetryDelay;
+	}
+	cond.notify_all();
+	return rc;
+}
+
+void NvmemFile::threadMain()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	while (!stopping)
+	{
+		// find the next file to write
+		NvmemFile *next = nullptr;
+		for (NvmemFile *file : files)
+			if (file->dirty && !file->writing && (next == nullptr || file->deadline < next->deadline))
+				next = file;
+		if (next == nullptr)
+			cond.wait(lock);
+		else if (std::chrono::steady_clock::now() >= next->deadline)
+			next->writeBack(lock);
+		else
+			// files may be modified or destroyed while waiting
+			cond.wait_until(lock, next->deadline);
+	}
+}
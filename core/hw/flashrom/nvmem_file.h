@@ -0,0 +1,59 @@
+/*
+	Copyright 2021 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include "types.h"
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Writes data to a temporary file and renames it over path, so that the file
+// always contains either the old or the new data.
+bool writeFileAtomic(const std::string& path, const u8 *data, size_t size);
+
+//
+// Non-volatile memory image saved in the background.
+// Modified ranges are copied to a write-back buffer, and the file is replaced
+// by a background thread once no modification has been made for a short while.
+//
+class NvmemFile
+{
+public:
+	NvmemFile(const std::string& path, const u8 *data, u32 size);
+	// Writes pending changes
+	~NvmemFile();
+
+	// Called when data[offset, offset + len) has been modified
+	void update(const u8 *data, u32 offset, u32 len);
+	// Writes pending changes now
+	void flush();
+
+	const std::string& getPath() const { return path; }
+
+private:
+	bool writeBack(std::unique_lock<std::mutex>& lock);
+	static void threadMain();
+
+	const std::string path;
+	std::vector<u8> image;
+	bool dirty = false;
+	bool writing = false;
+	std::chrono::steady_clock::time_point deadline;
+};
@@ -12,6 +12,7 @@
 #include "hw/sh4/sh4_mem.h"
 #include "hw/sh4/sh4_sched.h"
 #include "imgread/common.h"
+#include "imgread/readahead.h"
 
 int gdrom_schid;
 
@@ -105,7 +106,7 @@ static void FillReadBuffer()
 
 	read_buff.cache_size=count*read_params.sector_type;
 
-	libGDR_ReadSector(read_buff.cache,read_params.start_sector,count,read_params.sector_type);
+	readahead::read(read_buff.cache,read_params.start_sector,count,read_params.sector_type);
 	read_params.start_sector+=count;
 	read_params.remaining_sectors-=count;
 }
@@ -192,7 +193,7 @@ void gd_set_state(gd_states state)
 					next_state = gds_readsector_pio;
 				}
 
-				libGDR_ReadSector((u8*)&pio_buff.data[0],read_params.start_sector,sector_count, read_params.sector_type);
+				readahead::read((u8*)&pio_buff.data[0],read_params.start_sector,sector_count, read_params.sector_type);
 				read_params.start_sector+=sector_count;
 				read_params.remaining_sectors-=sector_count;
 
@@ -619,6 +620,7 @@ void gd_process_spi_cmd()
 			read_params.sector_type = sector_type;//yeah i know , not really many types supported...
 
 			printf_spicmd("SPI_CD_READ - Sector=%d Size=%d/%d DMA=%d",read_params.start_sector,read_params.remaining_sectors,read_params.sector_type,Features.CDRead.DMA);
+			readahead::start(read_params.start_sector, read_params.remaining_sectors, read_params.sector_type);
 			if (Features.CDRead.DMA == 1)
 			{
 				gd_set_state(gds_readsector_dma);
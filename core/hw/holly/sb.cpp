@@ -71,6 +71,17 @@ void sb_WriteMem(u32 addr,u32 data,u32 sz)
 	}
 }
 
+// Registers without read (resp. write) function can be accessed directly
+u32 *sb_GetRegPtr(u32 addr, bool write)
+{
+	u32 offset = (addr - SB_BASE) >> 2;
+	if (offset >= sb_regs.size())
+		return nullptr;
+	if (sb_regs[offset].flags & (write ? REG_WF : (REG_RF | REG_WO)))
+		return nullptr;
+	return &sb_regs[offset].data32;
+}
+
 static u32 sbio_read_noacc(u32 addr)
 {
 	INFO_LOG(HOLLY, "ERROR: forbidden read on register; offset=%x", addr - SB_BASE);
@@ -8,6 +8,7 @@
 
 u32 sb_ReadMem(u32 addr,u32 sz);
 void sb_WriteMem(u32 addr,u32 data,u32 sz);
+u32 *sb_GetRegPtr(u32 addr, bool write);
 void sb_Init();
 void sb_Reset(bool hard);
 void sb_Term();
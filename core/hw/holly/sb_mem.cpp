@@ -248,6 +248,44 @@ static void WriteBios(u32 addr, u32 data, u32 sz)
 //0x01000000- 0x01FFFFFF	:Ext. Device
 //0x02000000- 0x03FFFFFF*	:Image Area*	2MB
 
+// Holly registers 0x005F0000 - 0x005FFFFF, dispatched by 256-byte page
+struct Area0Page
+{
+	u32 (*read)(u32 addr, u32 sz);
+	void (*write)(u32 addr, u32 data, u32 sz);
+};
+static Area0Page area0Pages[0x100];
+
+static u32 pvr_ReadMem(u32 addr, u32 sz)
+{
+	if (sz != 4)
+		// House of the Dead 2
+		return 0;
+	return pvr_ReadReg(addr);
+}
+
+static void pvr_WriteMem(u32 addr, u32 data, u32 sz)
+{
+	verify(sz == 4);
+	pvr_WriteReg(addr, data);
+}
+
+static void area0_initPages()
+{
+	memset(area0Pages, 0, sizeof(area0Pages));
+	// All SB registers
+	for (u32 page = 0x68; page <= 0x7C; page++)
+		area0Pages[page] = { sb_ReadMem, sb_WriteMem };
+	// GD-ROM / Naomi/AW cart
+	if (settings.platform.system == DC_PLATFORM_DREAMCAST)
+		area0Pages[0x70] = { ReadMem_gdrom, WriteMem_gdrom };
+	else
+		area0Pages[0x70] = { ReadMem_naomi, WriteMem_naomi };
+	// TA / PVR core registers
+	for (u32 page = 0x80; page <= 0x9F; page++)
+		area0Pages[page] = { pvr_ReadMem, pvr_WriteMem };
+}
+
 template<typename T, u32 System, bool Mirror>
 T DYNACALL ReadMem_area0(u32 addr)
 {
@@ -282,24 +320,12 @@ T DYNACALL ReadMem_area0(u32 addr)
 		}
 		break;
 	case 2:
-		// GD-ROM / Naomi/AW cart
-		if (addr >= 0x005F7000 && addr <= 0x005F70FF)
-		{
-			if (System == DC_PLATFORM_DREAMCAST)
-				return (T)ReadMem_gdrom(addr, sz);
-			else
-				return (T)ReadMem_naomi(addr, sz);
-		}
-		// All SB registers
-		if (addr >= 0x005F6800 && addr <= 0x005F7CFF)
-			return (T)sb_ReadMem(addr, sz);
-		// TA / PVR core registers
-		if (addr >= 0x005F8000 && addr <= 0x005F9FFF)
+		// GD-ROM / Naomi/AW cart, SB and PVR registers
+		if ((addr >> 16) == 0x5F)
 		{
-			if (sz != 4)
-				// House of the Dead 2
-				return 0;
-			return (T)pvr_ReadReg(addr);
+			const Area0Page& page = area0Pages[(addr >> 8) & 0xFF];
+			if (page.read != nullptr)
+				return (T)page.read(addr, sz);
 		}
 		break;
 	case 3:
@@ -331,6 +357,7 @@ T DYNACALL ReadMem_area0(u32 addr)
 	case 6:
 	case 7:
 		// AICA ram
+		libAICA_Sync();
 		return (T)ReadMemArr<sz>(aica_ram.data, addr & ARAM_MASK);
 
 	default:
@@ -387,27 +414,15 @@ void DYNACALL WriteMem_area0(u32 addr, T data)
 		}
 		break;
 	case 2:
-		 // GD-ROM / Naomi/AW cart
-		if (addr >= 0x005F7000 && addr <= 0x005F70FF)
-		{
-			if (System == DC_PLATFORM_DREAMCAST)
-				WriteMem_gdrom(addr, data, sz);
-			else
-				WriteMem_naomi(addr, data, sz);
-			return;
-		}
-		// All SB registers
-		if (addr >= 0x005F6800 && addr <= 0x005F7CFF)
-		{
-			sb_WriteMem(addr, data, sz);
-			return;
-		}
-		// TA / PVR core registers
-		if (addr >= 0x005F8000 && addr <= 0x005F9FFF)
+		// GD-ROM / Naomi/AW cart, SB and PVR registers
+		if ((addr >> 16) == 0x5F)
 		{
-			verify(sz == 4);
-			pvr_WriteReg(addr, data);
-			return;
+			const Area0Page& page = area0Pages[(addr >> 8) & 0xFF];
+			if (page.write != nullptr)
+			{
+				page.write(addr, data, sz);
+				return;
+			}
 		}
 		break;
 	case 3:
@@ -443,6 +458,7 @@ void DYNACALL WriteMem_area0(u32 addr, T data)
 	case 6:
 	case 7:
 		// AICA ram
+		libAICA_Sync();
 		WriteMemArr<sz>(aica_ram.data, addr & ARAM_MASK, data);
 		return;
 
@@ -525,6 +541,8 @@ static _vmem_handler area0_mirror_handler;
 
 void map_area0_init()
 {
+	area0_initPages();
+
 #define registerHandler(system, mirror) _vmem_register_handler \
 		(ReadMem_area0<u8, system, mirror>, ReadMem_area0<u16, system, mirror>, ReadMem_area0<u32, system, mirror>,	\
 		 WriteMem_area0<u8, system, mirror>, WriteMem_area0<u16, system, mirror>, WriteMem_area0<u32, system, mirror>)
@@ -557,3 +575,17 @@ void map_area0(u32 base)
 	//0x0240 to 0x03FF mirrors 0x0040 to 0x01FF (no flashrom or bios)
 	//0x0200 to 0x023F are unused
 }
+
+void *area0_GetRegPtr(u32 addr, bool write)
+{
+	// Must be mapped to area0_handler by map_area0
+	if (addr >= 0xE0000000 || ((addr >> 24) & 0x1E) != 0)
+		return nullptr;
+	addr &= 0x01FFFFFF;
+	if ((addr >> 16) != 0x5F)
+		return nullptr;
+	const Area0Page& page = area0Pages[(addr >> 8) & 0xFF];
+	if (page.read != sb_ReadMem)
+		return nullptr;
+	return sb_GetRegPtr(addr, write);
+}
@@ -3,6 +3,9 @@
 
 void map_area0_init();
 void map_area0(u32 base);
+// Returns a pointer to the storage of the register at this address if it can be accessed
+// directly without side effects, or nullptr
+void *area0_GetRegPtr(u32 addr, bool write);
 
 //Init/Res/Term
 void sh4_area0_Init();
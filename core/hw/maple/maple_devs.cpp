@@ -5,6 +5,7 @@
 #include "oslib/audiostream.h"
 #include "oslib/oslib.h"
 #include "cfg/option.h"
+#include "hw/flashrom/nvmem_file.h"
 
 #include <zlib.h>
 
@@ -38,6 +39,12 @@ maple_device::~maple_device()
     delete config;
 }
 
+static bool sameInput(const PlainJoystickState& a, const PlainJoystickState& b)
+{
+	return a.kcode == b.kcode && memcmp(a.joy, b.joy, sizeof(a.joy)) == 0
+			&& memcmp(a.trigger, b.trigger, sizeof(a.trigger)) == 0;
+}
+
 static inline void mutualExclusion(u32& keycode, u32 mask)
 {
 	if ((keycode & mask) == 0)
@@ -50,6 +57,10 @@ static inline void mutualExclusion(u32& keycode, u32 mask)
 */
 struct maple_sega_controller: maple_base
 {
+	PlainJoystickState lastInput;
+	u32 condition[2];
+	bool conditionValid = false;
+
 	virtual u32 get_capabilities() {
 		// byte 0: 0  0  0  0  0  0  0  0
 		// byte 1: 0  0  a5 a4 a3 a2 a1 a0
@@ -144,32 +155,38 @@ struct maple_sega_controller: maple_base
 			{
 				PlainJoystickState pjs;
 				config->GetInput(&pjs);
+				// The condition data only changes when the input state does
+				if (!conditionValid || !sameInput(pjs, lastInput))
+				{
+					//state data
+					//2 key code
+					condition[0] = transform_kcode(pjs.kcode) & 0xffff;
+					//triggers
+					//1 R
+					condition[0] |= (get_analog_axis(0, pjs) & 0xff) << 16;
+					//1 L
+					condition[0] |= (get_analog_axis(1, pjs) & 0xff) << 24;
+					//joyx
+					//1
+					condition[1] = get_analog_axis(2, pjs) & 0xff;
+					//joyy
+					//1
+					condition[1] |= (get_analog_axis(3, pjs) & 0xff) << 8;
+					//not used on dreamcast
+					//1
+					condition[1] |= (get_analog_axis(4, pjs) & 0xff) << 16;
+					//1
+					condition[1] |= (get_analog_axis(5, pjs) & 0xff) << 24;
+
+					lastInput = pjs;
+					conditionValid = true;
+				}
 				//caps
 				//4
 				w32(MFID_0_Input);
-
-				//state data
-				//2 key code
-				w16(transform_kcode(pjs.kcode));
-
-				//triggers
-				//1 R
-				w8(get_analog_axis(0, pjs));
-				//1 L
-				w8(get_analog_axis(1, pjs));
-
-				//joyx
-				//1
-				w8(get_analog_axis(2, pjs));
-				//joyy
-				//1
-				w8(get_analog_axis(3, pjs));
-
-				//not used on dreamcast
-				//1
-				w8(get_analog_axis(4, pjs));
-				//1
-				w8(get_analog_axis(5, pjs));
+				//8
+				w32(condition[0]);
+				w32(condition[1]);
 			}
 
 			return MDRS_DataTransfer;
@@ -313,10 +330,11 @@ u8 vmu_default[] = {
 
 struct maple_sega_vmu: maple_base
 {
-	FILE* file;
+	std::unique_ptr<NvmemFile> file;
 	u8 flash_data[128*1024];
 	u8 lcd_data[192];
 	u8 lcd_data_decoded[48*32];
+	bool lcd_pushed = false;	// lcd_data_decoded has been sent to the screen
 
 	MapleDeviceType get_device_type() override
 	{
@@ -337,10 +355,12 @@ struct maple_sega_vmu: maple_base
 		REICAST_US(flash_data);
 		REICAST_US(lcd_data);
 		REICAST_US(lcd_data_decoded);
+		lcd_pushed = false;
 		for (u8 b : lcd_data)
 			if (b != 0)
 			{
 				config->SetImage(lcd_data_decoded);
+				lcd_pushed = true;
 				break;
 			}
 		return true ;
@@ -355,49 +375,36 @@ struct maple_sega_vmu: maple_base
 
 		verify(rv == Z_OK);
 		verify(dec_sz == sizeof(flash_data));
-
-		if (file != nullptr)
-		{
-			if (std::fwrite(flash_data, sizeof(flash_data), 1, file) != 1)
-				WARN_LOG(MAPLE, "Failed to write the VMU to disk");
-			if (std::fseek(file, 0, SEEK_SET) != 0)
-				WARN_LOG(MAPLE, "VMU: I/O error");
-		}
 	}
 
 	void OnSetup() override
 	{
 		memset(flash_data, 0, sizeof(flash_data));
 		memset(lcd_data, 0, sizeof(lcd_data));
+		lcd_pushed = false;
 		std::string apath = hostfs::getVmuPath(logical_port);
 
-		file = nowide::fopen(apath.c_str(), "rb+");
-		if (file == nullptr)
-		{
+		FILE *f = nowide::fopen(apath.c_str(), "rb");
+		if (f == nullptr)
 			INFO_LOG(MAPLE, "Unable to open VMU save file \"%s\", creating new file", apath.c_str());
-			file = nowide::fopen(apath.c_str(), "wb+");
-			if (file == nullptr)
-				ERROR_LOG(MAPLE, "Failed to create VMU save file \"%s\"", apath.c_str());
-			initializeVmu();
-		}
-
-		if (file != nullptr)
-			if (std::fread(flash_data, sizeof(flash_data), 1, file) != 1)
+		else
+		{
+			if (std::fread(flash_data, sizeof(flash_data), 1, f) != 1)
 				WARN_LOG(MAPLE, "Failed to read the VMU from disk");
+			std::fclose(f);
+		}
 
 		u8 sum = 0;
 		for (u32 i = 0; i < sizeof(flash_data); i++)
 			sum |= flash_data[i];
 
+		file.reset(new NvmemFile(apath, flash_data, sizeof(flash_data)));
 		if (sum == 0)
-			// This means the existing VMU file is completely empty and needs to be recreated
+		{
+			// This means the VMU file doesn't exist or is completely empty and needs to be recreated
 			initializeVmu();
-	}
-
-	~maple_sega_vmu() override
-	{
-		if (file != nullptr)
-			std::fclose(file);
+			file->update(flash_data, 0, sizeof(flash_data));
+		}
 	}
 
 	u32 dma(u32 cmd) override
@@ -606,21 +613,8 @@ struct maple_sega_vmu: maple_base
 							return MDRE_FileError; //invalid params
 						}
 						rptr(&flash_data[write_adr],write_len);
-
-						if (file != nullptr)
-						{
-							if (std::fseek(file, write_adr, SEEK_SET) != 0
-									|| std::fwrite(&flash_data[write_adr], write_len, 1, file) != 1)
-							{
-								WARN_LOG(MAPLE, "Failed to save VMU %s: I/O error", logical_port);
-								return MDRE_FileError; // I/O error
-							}
-							std::fflush(file);
-						}
-						else
-						{
-							INFO_LOG(MAPLE, "Failed to save VMU %s data", logical_port);
-						}
+						// written to disk in the background
+						file->update(flash_data, write_adr, write_len);
 						return MDRS_DeviceReply;
 					}
 
@@ -628,6 +622,12 @@ struct maple_sega_vmu: maple_base
 					{
 						DEBUG_LOG(MAPLE, "VMU %s LCD write", logical_port);
 						r32();
+						// Most games send the same image every frame
+						if (lcd_pushed && memcmp(lcd_data, dma_buffer_in, sizeof(lcd_data)) == 0)
+						{
+							skip(sizeof(lcd_data));
+							return MDRS_DeviceReply;
+						}
 						rptr(lcd_data,192);
 
 						u8 white=0xff,black=0x00;
@@ -647,6 +647,7 @@ struct maple_sega_vmu: maple_base
 							}
 						}
 						config->SetImage(lcd_data_decoded);
+						lcd_pushed = true;
 
 						return  MDRS_DeviceReply;
 					}
@@ -1,8 +1,10 @@
 #include "_vmem.h"
 #include "hw/aica/aica_if.h"
+#include "hw/holly/sb_mem.h"
 #include "hw/pvr/pvr_mem.h"
 #include "hw/sh4/dyna/blockmanager.h"
 #include "hw/sh4/sh4_mem.h"
+#include "profiler/profiler.h"
 #if defined(__SWITCH__)
 #include <malloc.h>
 #endif
@@ -102,6 +104,34 @@ void* _vmem_write_const(u32 addr,bool& ismem,u32 sz)
 	}
 }
 
+void* _vmem_read_const_rec(u32 addr, bool& ismem, u32 sz)
+{
+	if (sz <= 4)
+	{
+		void *ptr = area0_GetRegPtr(addr, false);
+		if (ptr != nullptr)
+		{
+			ismem = true;
+			return ptr;
+		}
+	}
+	return _vmem_read_const(addr, ismem, std::min(sz, 4u));
+}
+
+void* _vmem_write_const_rec(u32 addr, bool& ismem, u32 sz)
+{
+	if (sz <= 4)
+	{
+		void *ptr = area0_GetRegPtr(addr, true);
+		if (ptr != nullptr)
+		{
+			ismem = true;
+			return ptr;
+		}
+	}
+	return _vmem_write_const(addr, ismem, std::min(sz, 4u));
+}
+
 template<typename T, typename Trv>
 Trv DYNACALL _vmem_readt(u32 addr)
 {
@@ -200,6 +230,63 @@ template void DYNACALL _vmem_writet<u16>(u32 addr, u16 data);
 template void DYNACALL _vmem_writet<u32>(u32 addr, u32 data);
 template void DYNACALL _vmem_writet<u64>(u32 addr, u64 data);
 
+VMemTlb vmem_tlb;
+
+void _vmem_tlb_flush()
+{
+	memset(vmem_tlb.tag, 0xff, sizeof(vmem_tlb.tag));
+}
+
+// Returns the host address of the page containing addr, or nullptr if it isn't in memory
+static u8 *_vmem_tlb_fill(u32 addr)
+{
+	unat iirf = (unat)_vmem_MemInfo_ptr[addr >> 24];
+	u8 *ptr = (u8 *)(iirf & ~HANDLER_MAX);
+	// The mirrored block must be at least as large as a page
+	if (ptr == nullptr || (iirf & HANDLER_MAX) > 32 - VMEM_TLB_PAGE_BITS)
+	{
+		prof.counters.memtlb.uncached++;
+		return nullptr;
+	}
+	prof.counters.memtlb.miss++;
+	u32 page = addr >> VMEM_TLB_PAGE_BITS;
+	u32 offset = page << VMEM_TLB_PAGE_BITS;
+	offset <<= iirf;
+	offset >>= iirf;
+	u32 idx = page & (VMEM_TLB_SIZE - 1);
+	vmem_tlb.tag[idx] = page;
+	vmem_tlb.ptr[idx] = ptr + offset;
+
+	return vmem_tlb.ptr[idx];
+}
+
+template<typename T, typename Trv>
+Trv DYNACALL _vmem_tlb_read(u32 addr)
+{
+	u8 *page = _vmem_tlb_fill(addr);
+	if (page == nullptr)
+		return _vmem_readt<T, Trv>(addr);
+	return *(T *)&page[addr & ((1 << VMEM_TLB_PAGE_BITS) - 1)];
+}
+template s32 DYNACALL _vmem_tlb_read<s8, s32>(u32 addr);
+template s32 DYNACALL _vmem_tlb_read<s16, s32>(u32 addr);
+template u32 DYNACALL _vmem_tlb_read<u32, u32>(u32 addr);
+template u64 DYNACALL _vmem_tlb_read<u64, u64>(u32 addr);
+
+template<typename T>
+void DYNACALL _vmem_tlb_write(u32 addr, T data)
+{
+	u8 *page = _vmem_tlb_fill(addr);
+	if (page == nullptr)
+		_vmem_writet<T>(addr, data);
+	else
+		*(T *)&page[addr & ((1 << VMEM_TLB_PAGE_BITS) - 1)] = data;
+}
+template void DYNACALL _vmem_tlb_write<u8>(u32 addr, u8 data);
+template void DYNACALL _vmem_tlb_write<u16>(u32 addr, u16 data);
+template void DYNACALL _vmem_tlb_write<u32>(u32 addr, u32 data);
+template void DYNACALL _vmem_tlb_write<u64>(u32 addr, u64 data);
+
 //ReadMem/WriteMem functions
 //ReadMem
 u32 DYNACALL _vmem_ReadMem8SX32(u32 Address) { return _vmem_readt<s8,s32>(Address); }
@@ -295,6 +382,7 @@ void _vmem_map_handler(_vmem_handler Handler,u32 start,u32 end)
 	{
 		_vmem_MemInfo_ptr[i] = (u8*)nullptr + Handler;
 	}
+	_vmem_tlb_flush();
 }
 
 //map a memory block to a mem region
@@ -311,6 +399,7 @@ void _vmem_map_block(void* base,u32 start,u32 end,u32 mask)
 		_vmem_MemInfo_ptr[i]=&(((u8*)base)[j&mask]) + FindMask(mask) - (j & mask);
 		j+=0x1000000;
 	}
+	_vmem_tlb_flush();
 }
 
 void _vmem_mirror_mapping(u32 new_region,u32 start,u32 size)
@@ -327,6 +416,7 @@ void _vmem_mirror_mapping(u32 new_region,u32 start,u32 size)
 		_vmem_MemInfo_ptr[j&0xFF]=_vmem_MemInfo_ptr[i&0xFF];
 		j++;
 	}
+	_vmem_tlb_flush();
 }
 
 //init/reset/term
@@ -349,6 +439,7 @@ void _vmem_reset()
 	
 	//clear meminfo table
 	memset(_vmem_MemInfo_ptr,0,sizeof(_vmem_MemInfo_ptr));
+	_vmem_tlb_flush();
 
 	//reset registration index
 	_vmem_lrp=0;
@@ -570,11 +661,13 @@ void _vmem_init_mappings()
 				{0xC8000000, 0xCC000000,                               0,         0, false},  // Area 2
 				{0xCC000000, 0xD0000000,            MAP_RAM_START_OFFSET,  RAM_SIZE,  true},  // Area 3 (main RAM + 3 mirrors)
 				{0xD0000000, 0x100000000L,                             0,         0, false},  // Area 4-7 (unused)
+				// This is outside of the 4GB addr space, so that the sh4 views can be protected while the aica ram is still accessible
+				{0x100000000L, 0x100800000L,       MAP_ARAM_START_OFFSET, ARAM_SIZE,  true},  // writable aica ram
 			};
 			vmem_platform_create_mappings(&mem_mappings[0], ARRAY_SIZE(mem_mappings));
 
 			// Point buffers to actual data pointers
-			aica_ram.data = &virt_ram_base[0x80800000];  // Points to the first AICA addrspace in P1
+			aica_ram.data = &virt_ram_base[0x100000000L];  // Points to the writable AICA addrspace
 			vram.data = &virt_ram_base[0x84000000];   // Points to first vram mirror (writable and lockable) in P1
 			mem_b.data = &virt_ram_base[0x8C000000];   // Main memory, first mirror in P1
 
@@ -685,6 +778,36 @@ void _vmem_unprotect_vram(u32 addr, u32 size)
 	}
 }
 
+// Makes the aica ram inaccessible through the sh4 address space, so that the dynarecs
+// can't access it directly and go through the area 0 handlers instead.
+void _vmem_protect_aram(bool protect)
+{
+	if (!_nvmem_enabled())
+		return;
+	if (!_nvmem_4gb_space())
+	{
+		// Read-only when mapped, writes are already handled by the area 0 handlers
+		if (protect)
+			mem_region_set_noaccess(virt_ram_base + 0x00800000, 0x00800000);
+		else
+			mem_region_lock(virt_ram_base + 0x00800000, 0x00800000);
+		return;
+	}
+	static const u32 aramViews[] = {
+		0x00800000, 0x02800000,	// P0 and mirror
+		0x80800000, 0x82800000,	// P1 and mirror
+		0xA0800000, 0xA2800000,	// P2 and mirror
+		0xC0800000, 0xC2800000,	// P3 and mirror
+	};
+	for (u32 addr : aramViews)
+	{
+		if (protect)
+			mem_region_set_noaccess(virt_ram_base + addr, 0x00800000);
+		else
+			mem_region_unlock(virt_ram_base + addr, 0x00800000);
+	}
+}
+
 u32 _vmem_get_vram_offset(void *addr)
 {
 	if (_nvmem_enabled())
@@ -89,6 +89,25 @@ void DYNACALL _vmem_WriteMem32(u32 Address,u32 data);
 void DYNACALL _vmem_WriteMem64(u32 Address,u64 data);
 template<typename T> void DYNACALL _vmem_writet(u32 addr, T data);
 
+// Software TLB used by the dynarecs when the fast memory mapping isn't available (!_nvmem_enabled())
+// Each entry maps a 64 KB page of the physical address space to host memory.
+// Areas served by handlers are never cached so accesses to them always take the miss path.
+#define VMEM_TLB_PAGE_BITS 16
+#define VMEM_TLB_BITS 8
+#define VMEM_TLB_SIZE (1 << VMEM_TLB_BITS)
+
+struct VMemTlb
+{
+	u32 tag[VMEM_TLB_SIZE];		// page number, or ~0 if the entry is invalid
+	u8 *ptr[VMEM_TLB_SIZE];		// host address of the page
+};
+extern VMemTlb vmem_tlb;
+
+void _vmem_tlb_flush();
+// Miss handlers: fill the TLB entry if the page is in memory and do the access
+template<typename T, typename Trv> Trv DYNACALL _vmem_tlb_read(u32 addr);
+template<typename T> void DYNACALL _vmem_tlb_write(u32 addr, T data);
+
 //should be called at start up to ensure it will succeed :)
 bool _vmem_reserve();
 void _vmem_release();
@@ -96,6 +115,10 @@ void _vmem_release();
 //dynarec helpers
 void* _vmem_read_const(u32 addr,bool& ismem,u32 sz);
 void* _vmem_write_const(u32 addr,bool& ismem,u32 sz);
+// Same as above but hardware registers without side effects are also returned as memory.
+// sz can be 8, in which case the 32-bit handler is returned.
+void* _vmem_read_const_rec(u32 addr, bool& ismem, u32 sz);
+void* _vmem_write_const_rec(u32 addr, bool& ismem, u32 sz);
 
 extern u8* virt_ram_base;
 extern bool vmem_4gb_space;
@@ -115,3 +138,4 @@ void _vmem_bm_reset();
 void _vmem_protect_vram(u32 addr, u32 size);
 void _vmem_unprotect_vram(u32 addr, u32 size);
 u32 _vmem_get_vram_offset(void *addr);
+void _vmem_protect_aram(bool protect);
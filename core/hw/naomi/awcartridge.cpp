@@ -162,6 +162,8 @@ ROM board internal layouts:
 */
 #include "awcartridge.h"
 #include "awave_regs.h"
+#include "cfg/option.h"
+#include "stdclass.h"
 
 u32 AWCartridge::ReadMem(u32 address, u32 size) {
 	verify(size != 1);
@@ -305,46 +307,56 @@ static u16 bitswap16(u16 in, const u8* vec)
   return ret;
 }
 
-u16 AWCartridge::decrypt(u16 cipherText, u32 address, const u8 key)
+// The bit swaps are linear and done one byte at a time.
+// The sbox substitution and final xor are done with a single table.
+void AWCartridge::SetKey(u32 key)
 {
-	u8 b0,b1,b2,b3;
-	u16 aux;
-	const u8* pbox = permutation_table[key>>6];
-	const sbox_set* ss = &sboxes_table[(key>>4)&3];
+	rombd_key = key;
+
+	const u8* pbox = permutation_table[(key >> 6) & 3];
+	const sbox_set* ss = &sboxes_table[(key >> 4) & 3];
 
 	const u8 text_swap_vec[] = {
 			pbox[15],pbox[14],pbox[13],pbox[12],pbox[11],pbox[10],pbox[9],pbox[8],
 			pbox[7],pbox[6],pbox[5],pbox[4],pbox[3],pbox[2],pbox[1],pbox[0] };
-	aux = bitswap16(cipherText, text_swap_vec);
 	const u8 addr_swap_vec[] = { 13,5,2, 14,10,9,4, 15,11,6,1, 12,8,7,3,0 };
-	aux = aux ^ bitswap16((u16)address, addr_swap_vec);
-
-	b0 = aux&0x1f;
-	b1 = (aux>>5)&0xf;
-	b2 = (aux>>9)&0xf;
-	b3 = aux>>13;
+	for (int i = 0; i < 256; i++)
+	{
+		text_swap[0][i] = bitswap16(i, text_swap_vec);
+		text_swap[1][i] = bitswap16(i << 8, text_swap_vec);
+		addr_swap[0][i] = bitswap16(i, addr_swap_vec);
+		addr_swap[1][i] = bitswap16(i << 8, addr_swap_vec);
+	}
 
-	b0 = ss->S0[b0];
-	b1 = ss->S1[b1];
-	b2 = ss->S2[b2];
-	b3 = ss->S3[b3];
+	for (int aux = 0; aux < 0x10000; aux++)
+	{
+		u8 b0 = ss->S0[aux & 0x1f];
+		u8 b1 = ss->S1[(aux >> 5) & 0xf];
+		u8 b2 = ss->S2[(aux >> 9) & 0xf];
+		u8 b3 = ss->S3[aux >> 13];
 
-	return ((b3<<13)|(b2<<9)|(b1<<5)|b0)^xor_table[key&0xf];
+		sbox_out[aux] = ((b3 << 13) | (b2 << 9) | (b1 << 5) | b0) ^ xor_table[key & 0xf];
+	}
+	decrypted.clear();
 }
 
-
 void AWCartridge::Init()
 {
+	if (config::PreDecryptRoms)
+	{
+		std::vector<u16> rom(RomSize / 2);
+		const u16 *cipherText = (const u16 *)RomPtr;
+		parallelFor(rom.size(), [this, &rom, cipherText](u32 begin, u32 end) {
+			for (u32 i = begin; i < end; i++)
+				rom[i] = decrypt(cipherText[i], i);
+		});
+		decrypted.swap(rom);
+	}
 	mpr_offset = decrypt16(0x58/2) | (decrypt16(0x5a/2) << 16);
 	INFO_LOG(NAOMI, "AWCartridge::SetKey rombd_key %02x mpr_offset %08x", rombd_key, mpr_offset);
 	device_reset();
 }
 
-void AWCartridge::SetKey(u32 key)
-{
-	rombd_key = key;
-}
-
 void AWCartridge::device_reset()
 {
 	epr_offset = 0;
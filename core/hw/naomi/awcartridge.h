@@ -13,11 +13,12 @@
 #define CORE_HW_NAOMI_AWCARTRIDGE_H_
 
 #include "naomi_cart.h"
+#include <vector>
 
 class AWCartridge: public Cartridge
 {
 public:
-	AWCartridge(u32 size) : Cartridge(size) {}
+	AWCartridge(u32 size) : Cartridge(size) { SetKey(0); }
 
 	void Init() override;
 	u32 ReadMem(u32 address, u32 size) override;
@@ -54,8 +55,23 @@ private:
 	static const u8 permutation_table[4][16];
 	static const sbox_set sboxes_table[4];
 	static const int xor_table[16];
-	static u16 decrypt(u16 cipherText, u32 address, u8 key);
-	u16 decrypt16(u32 address) { return decrypt(((u16 *)RomPtr)[address % (RomSize / 2)], address, rombd_key); }
+
+	// decryption tables for the current key
+	u16 text_swap[2][256];
+	u16 addr_swap[2][256];
+	u16 sbox_out[0x10000];
+	// whole ROM decrypted in advance
+	std::vector<u16> decrypted;
+
+	u16 decrypt(u16 cipherText, u32 address) const {
+		return sbox_out[text_swap[0][cipherText & 0xff] ^ text_swap[1][cipherText >> 8]
+				^ addr_swap[0][address & 0xff] ^ addr_swap[1][(address >> 8) & 0xff]];
+	}
+	u16 decrypt16(u32 address) const {
+		if (address < decrypted.size())
+			return decrypted[address];
+		return decrypt(((u16 *)RomPtr)[address % (RomSize / 2)], address);
+	}
 
 	void recalc_dma_offset(int mode);
 };
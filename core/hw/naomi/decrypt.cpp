@@ -409,35 +409,105 @@ static const int fn2_sequence_key_scheduling[16] = {77,34,8,42,36,27,69,66,13,9,
 
 static const int fn2_middle_result_scheduling[16] = {1,10,44,68,74,78,81,95,2,4,30,40,41,51,53,58};
 
-static int feistel_function(int input, const sbox *sboxes, uint32_t subkeys)
+/**************************
+The network is evaluated with pre-generated look-up tables:
+- for each sbox of each round, the 6-bit sbox input is gathered from the 8-bit round input with a table,
+  and the sbox output is scattered to its output bits with another table.
+- the game-key and sequence-key scheduling is done once per key and cached.
+- the middle-result-key scheduling and the bit swaps are linear, so they're done one byte at a time.
+**************************/
+
+struct FeistelRound
 {
-	int k,m;
-	int aux;
-	int result=0;
+	u8 input[4][256];	// sbox input bits for each possible round input
+	u8 output[4][64];	// round output bits for each possible sbox input
+};
+
+struct CryptoTables
+{
+	FeistelRound fn1[4];
+	FeistelRound fn2[4];
+	u32 middleKey[2][256][4];	// fn2 subkeys for each byte of the middle result
+	u16 swap1[2][256];			// bitswap16(vec1) of each byte of the input
+	u16 swap2[2][256];
+	u16 swap3[2][256];
+
+	CryptoTables();
+};
 
-	for (m=0; m<4; ++m) { // 4 sboxes
-		for (k=0, aux=0; k<6; ++k)
-			if (sboxes[m].inputs[k]!=255)
-				aux |= BIT(input, sboxes[m].inputs[k]) << k;
+static void initRound(FeistelRound& round, const sbox *sboxes)
+{
+	for (int m = 0; m < 4; m++) // 4 sboxes
+	{
+		for (int input = 0; input < 256; input++)
+		{
+			int aux = 0;
+			for (int k = 0; k < 6; k++)
+				if (sboxes[m].inputs[k] != 255)
+					aux |= BIT(input, sboxes[m].inputs[k]) << k;
+			round.input[m][input] = aux;
+		}
+		for (int aux = 0; aux < 64; aux++)
+		{
+			int result = 0;
+			for (int k = 0; k < 2; k++)
+				result |= BIT(sboxes[m].table[aux], k) << sboxes[m].outputs[k];
+			round.output[m][aux] = result;
+		}
+	}
+}
 
-		aux = sboxes[m].table[(aux^subkeys)&0x3f];
+static void initSwap(u16 table[2][256], const u8* vec)
+{
+	for (int i = 0; i < 16; i++)
+		for (int v = 0; v < 256; v++)
+		{
+			if (i == 0)
+				table[0][v] = table[1][v] = 0;
+			if (BIT((v << 8 | v), vec[i]))
+				table[vec[i] >> 3][v] |= 1 << (15 - i);
+		}
+}
 
-		for (k=0; k<2; ++k)
-			result |= BIT(aux,k) << sboxes[m].outputs[k];
+static const u8 vec1[16] = {5, 12, 14, 13, 9, 3, 6, 4, 8, 1, 15, 11, 0, 7, 10, 2};
+static const u8 vec2[16] = {14, 3, 8, 12, 13, 7, 15, 4, 6, 2, 9, 5, 11, 0, 1, 10};
+static const u8 vec3[16] = {15, 7, 6, 14, 13, 12, 5, 4, 3, 2, 11, 10, 9, 1, 0, 8};
 
-		subkeys >>=6;
+CryptoTables::CryptoTables()
+{
+	for (int r = 0; r < 4; r++)
+	{
+		initRound(fn1[r], fn1_sboxes[r]);
+		initRound(fn2[r], fn2_sboxes[r]);
 	}
+	memset(middleKey, 0, sizeof(middleKey));
+	for (int j = 0; j < 16; j++)
+		for (int v = 0; v < 256; v++)
+			if (BIT(v, (j & 7)))
+				middleKey[j >> 3][v][fn2_middle_result_scheduling[j] / 24] ^= 1 << (fn2_middle_result_scheduling[j] % 24);
+	initSwap(swap1, vec1);
+	initSwap(swap2, vec2);
+	initSwap(swap3, vec3);
+}
 
-	return result;
+static const CryptoTables& getTables()
+{
+	static const CryptoTables tables;
+	return tables;
 }
 
-/**************************
-This implementation is an "educational" version. It must be noted that it can be speed-optimized in a number of ways.
-The most evident one is to factor out the parts of the key-scheduling that must only be done once (like the game-key &
-sequence-key parts) as noted in the comments inlined in the function. More sophisticated speed-ups can be gained by
-noticing that the weak key-scheduling would allow to create some pregenerated look-up tables for doing most of the work
-of the function. Even so, it would still be pretty slow, so caching techniques could be a wiser option here.
-**************************/
+static inline int feistel_function(const FeistelRound& round, int input, u32 subkeys)
+{
+	return round.output[0][(round.input[0][input] ^ subkeys) & 0x3f]
+		| round.output[1][(round.input[1][input] ^ (subkeys >> 6)) & 0x3f]
+		| round.output[2][(round.input[2][input] ^ (subkeys >> 12)) & 0x3f]
+		| round.output[3][(round.input[3][input] ^ (subkeys >> 18)) & 0x3f];
+}
+
+static inline u16 bitswap16(u16 in, const u16 table[2][256])
+{
+	return table[0][in & 0xff] | table[1][in >> 8];
+}
 
 static u32 cryptoKey = 0;
 static u32 cryptoSubKey = 0;
@@ -509,29 +579,24 @@ void cyptoSetSubkey(u16 subKey)
   cryptoReady = 0;
 }
 
-static u16 bitswap16(u16 in, const u8* vec)
+// Game-key and sequence-key scheduling
+struct KeySchedule
 {
-  u16 ret = 0;
-  for (int i = 0; i<16; i++) {
-    ret |= ((in >> vec[i])&0x1)<<(15-i);
-  }
-  return ret;
-}
-
-static const u8 vec1[16] = {5, 12, 14, 13, 9, 3, 6, 4, 8, 1, 15, 11, 0, 7, 10, 2};
-static const u8 vec2[16] = {14, 3, 8, 12, 13, 7, 15, 4, 6, 2, 9, 5, 11, 0, 1, 10};
-static const u8 vec3[16] = {15, 7, 6, 14, 13, 12, 5, 4, 3, 2, 11, 10, 9, 1, 0, 8};
+	u32 game_key;
+	u16 sequence_key;
+	bool valid;
+	u32 fn1_subkeys[4];
+	u32 fn2_subkeys[4];
+};
+static KeySchedule keySchedule;
 
-static u16 block_decrypt(uint32_t game_key, uint16_t sequence_key, uint16_t counter, uint16_t data)
+static void scheduleKeys(uint32_t game_key, uint16_t sequence_key)
 {
 	int j;
 	int aux, aux2;
-	int A, B;
-	int middle_result;
-	u32 fn1_subkeys[4];
-	u32 fn2_subkeys[4];
+	u32 *fn1_subkeys = keySchedule.fn1_subkeys;
+	u32 *fn2_subkeys = keySchedule.fn2_subkeys;
 
-	/* Game-key scheduling; this could be done just once per game at initialization time */
 	memset(fn1_subkeys, 0, sizeof(u32) * 4);
 	memset(fn2_subkeys, 0, sizeof(u32) * 4);
 
@@ -550,9 +615,7 @@ static u16 block_decrypt(uint32_t game_key, uint16_t sequence_key, uint16_t coun
 			fn2_subkeys[aux2] ^= (1 << aux);
 		}
 	}
-	/********************************************************/
 
-	/* Sequence-key scheduling; this could be done just once per decryption run */
 	for (j = 0; j < 20; ++j) {
 		if (BIT(sequence_key, fn1_sequence_key_scheduling[j][0]) != 0) {
 			aux = fn1_sequence_key_scheduling[j][1] % 24;
@@ -568,61 +631,72 @@ static u16 block_decrypt(uint32_t game_key, uint16_t sequence_key, uint16_t coun
 			fn2_subkeys[aux2] ^= (1 << aux);
 		}
 	}
+	keySchedule.game_key = game_key;
+	keySchedule.sequence_key = sequence_key;
+	keySchedule.valid = true;
+}
 
-	/**************************************************************/
+static u16 block_decrypt(uint32_t game_key, uint16_t sequence_key, uint16_t counter, uint16_t data)
+{
+	const CryptoTables& tables = getTables();
+	int aux;
+	int A, B;
+
+	if (!keySchedule.valid || keySchedule.game_key != game_key || keySchedule.sequence_key != sequence_key)
+		scheduleKeys(game_key, sequence_key);
+	const u32 *fn1_subkeys = keySchedule.fn1_subkeys;
 
 	// First Feistel Network
-	aux = bitswap16(counter, vec1);
+	aux = bitswap16(counter, tables.swap1);
 
 	// 1st round
 	B = aux >> 8;
-	A = (aux & 0xff) ^ feistel_function(B, fn1_sboxes[0], fn1_subkeys[0]);
+	A = (aux & 0xff) ^ feistel_function(tables.fn1[0], B, fn1_subkeys[0]);
 
 	// 2nd round
-	B ^= feistel_function(A, fn1_sboxes[1], fn1_subkeys[1]);
+	B ^= feistel_function(tables.fn1[1], A, fn1_subkeys[1]);
 
 	// 3rd round
-	A ^= feistel_function(B, fn1_sboxes[2], fn1_subkeys[2]);
+	A ^= feistel_function(tables.fn1[2], B, fn1_subkeys[2]);
 
 	// 4th round
-	B ^= feistel_function(A, fn1_sboxes[3], fn1_subkeys[3]);
-
-	middle_result = (B << 8) | A;
+	B ^= feistel_function(tables.fn1[3], A, fn1_subkeys[3]);
 
-
-	/* Middle-result-key sheduling */
-	for (j = 0; j < 16; ++j) {
-		if (BIT(middle_result, j) != 0) {
-			aux = fn2_middle_result_scheduling[j] % 24;
-			aux2 = fn2_middle_result_scheduling[j] / 24;
-			fn2_subkeys[aux2] ^= (1 << aux);
-		}
-	}
-	/*********************/
+	/* Middle-result-key sheduling: B is the high byte and A the low byte of the middle result */
+	const u32 *midLo = tables.middleKey[0][A];
+	const u32 *midHi = tables.middleKey[1][B];
+	u32 fn2_subkeys[4];
+	for (int j = 0; j < 4; j++)
+		fn2_subkeys[j] = keySchedule.fn2_subkeys[j] ^ midLo[j] ^ midHi[j];
 
 	// Second Feistel Network
 
-	aux = bitswap16(data, vec2);
+	aux = bitswap16(data, tables.swap2);
 
 	// 1st round
 	B = aux >> 8;
-	A = (aux & 0xff) ^ feistel_function(B, fn2_sboxes[0], fn2_subkeys[0]);
+	A = (aux & 0xff) ^ feistel_function(tables.fn2[0], B, fn2_subkeys[0]);
 
 	// 2nd round
-	B ^= feistel_function(A, fn2_sboxes[1], fn2_subkeys[1]);
+	B ^= feistel_function(tables.fn2[1], A, fn2_subkeys[1]);
 
 	// 3rd round
-	A ^= feistel_function(B, fn2_sboxes[2], fn2_subkeys[2]);
+	A ^= feistel_function(tables.fn2[2], B, fn2_subkeys[2]);
 
 	// 4th round
-	B ^= feistel_function(A, fn2_sboxes[3], fn2_subkeys[3]);
+	B ^= feistel_function(tables.fn2[3], A, fn2_subkeys[3]);
 
 	aux = (B << 8) | A;
-	aux = bitswap16(aux, vec3);
+	aux = bitswap16(aux, tables.swap3);
 
 	return aux;
 }
 
+u16 cryptoBlockDecrypt(u32 gameKey, u16 sequenceKey, u16 counter, u16 data)
+{
+	return block_decrypt(gameKey, sequenceKey, counter, data);
+}
+
 static u16 m_read(uint32_t addr)
 {
 	return ((M2Cartridge *)CurrentCartridge)->ReadCipheredData(addr);
@@ -7,5 +7,7 @@ extern void cyptoSetKey(u32 privKey);
 extern void cyptoSetLowAddr(u16 val);
 extern void cyptoSetHighAddr(u16 val);
 extern void cyptoSetSubkey(u16 subKey);
+// Decrypts one 16-bit word
+extern u16 cryptoBlockDecrypt(u32 gameKey, u16 sequenceKey, u16 counter, u16 data);
 
 #endif
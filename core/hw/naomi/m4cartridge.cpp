@@ -9,6 +9,8 @@
  */
 
 #include "m4cartridge.h"
+#include "cfg/option.h"
+#include "stdclass.h"
 
 
 // Decoder for M4-type NAOMI cart encryption
@@ -57,6 +59,9 @@ void M4Cartridge::device_start()
 	subkey2 = (m_key_data[0x5e6] << 8) | m_key_data[0x5e4];
 
 	enc_init();
+	decrypted.clear();
+	if (config::PreDecryptRoms)
+		enc_predecrypt();
 }
 
 void M4Cartridge::enc_init()
@@ -86,6 +91,30 @@ void M4Cartridge::enc_init()
 	}
 }
 
+void M4Cartridge::enc_predecrypt()
+{
+	// The feed value is reset every 16 words so each block can be decrypted independently
+	std::vector<u8> rom(RomSize & ~31);
+	parallelFor(rom.size() / 32, [this, &rom](u32 begin, u32 end) {
+		for (u32 block = begin; block < end; block++)
+		{
+			const u8 *src = RomPtr + block * 32;
+			u8 *dst = &rom[block * 32];
+			u16 iv = 0;
+			for (int i = 0; i < 32; i += 2)
+			{
+				u16 enc = src[i] | (src[i + 1] << 8);
+				u16 dec = iv;
+				iv = decrypt_one_round(enc ^ iv, subkey1);
+				dec ^= decrypt_one_round(iv, subkey2);
+				dst[i] = dec;
+				dst[i + 1] = dec >> 8;
+			}
+		}
+	});
+	decrypted.swap(rom);
+}
+
 void M4Cartridge::device_reset()
 {
 	rom_cur_address = 0;
@@ -219,7 +248,7 @@ void M4Cartridge::enc_reset()
 	counter = 0;
 }
 
-u16 M4Cartridge::decrypt_one_round(u16 word, u16 subkey)
+u16 M4Cartridge::decrypt_one_round(u16 word, u16 subkey) const
 {
 	return one_round[word ^ subkey] ^ subkey ;
 }
@@ -229,6 +258,16 @@ void M4Cartridge::enc_fill()
 	const u8 *base = RomPtr + rom_cur_address;
 	while (buffer_actual_size < sizeof(buffer))
 	{
+		if (counter == 0 && (rom_cur_address & 31) == 0 && rom_cur_address + 32 <= decrypted.size()
+				&& buffer_actual_size + 32 <= sizeof(buffer))
+		{
+			// this block has been decrypted in advance
+			memcpy(buffer + buffer_actual_size, &decrypted[rom_cur_address], 32);
+			buffer_actual_size += 32;
+			base += 32;
+			rom_cur_address += 32;
+			continue;
+		}
 		u16 enc = base[0] | (base[1] << 8);
 		u16 dec = iv;
 		iv = decrypt_one_round(enc ^ iv, subkey1);
@@ -14,6 +14,7 @@
 
 #include "naomi_cart.h"
 #include "naomi_regs.h"
+#include <vector>
 
 class M4Cartridge: public NaomiCartridge {
 public:
@@ -67,6 +68,8 @@ private:
 	u16 one_round[0x10000];
 
 	u8 buffer[32768];
+	// whole ROM decrypted in advance, in blocks of 32 bytes
+	std::vector<u8> decrypted;
 	u32 rom_cur_address, buffer_actual_size;
 	u16 iv;
 	u8 counter;
@@ -75,9 +78,10 @@ private:
 	bool xfer_ready;
 
 	void enc_init();
+	void enc_predecrypt();
 	void enc_reset();
 	void enc_fill();
-	u16 decrypt_one_round(u16 word, u16 subkey);
+	u16 decrypt_one_round(u16 word, u16 subkey) const;
 };
 
 #endif /* CORE_HW_NAOMI_M4CARTRIDGE_H_ */
@@ -393,6 +393,8 @@ void rend_end_render()
 {
 	if (pend_rend && config::ThreadedRendering)
 		re.Wait();
+	// Render to texture results read back asynchronously must be in vram before the sh4 sees the end of render
+	FlushTextureToVRam();
 }
 
 void rend_vblank()
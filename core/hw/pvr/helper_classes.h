@@ -1,4 +1,5 @@
 #pragma once
+#include <algorithm>
 
 template <class T>
 struct List
@@ -9,14 +10,17 @@ struct List
 	int size;
 	bool* overrun;
 	const char *list_name;
+	int overrun_size;	// elements requested by the largest overrunning frame
+	bool owned;
 
 	__forceinline int used() const { return size-avail; }
 	__forceinline int bytes() const { return used()* sizeof(T); }
 
 	NOINLINE
-	T* sig_overrun() 
+	T* sig_overrun(int n)
 	{ 
 		*overrun |= true;
+		overrun_size = std::max(overrun_size, used() + n);
 		Clear();
 		if (list_name != NULL)
 			WARN_LOG(PVR, "List overrun for list %s", list_name);
@@ -37,7 +41,7 @@ struct List
 			return rv;
 		}
 		else
-			return sig_overrun();
+			return sig_overrun(n);
 	}
 
 	__forceinline 
@@ -70,6 +74,19 @@ struct List
 
 		Clear();
 		list_name = name;
+		overrun_size = 0;
+		owned = true;
+	}
+
+	// Use externally owned storage (i.e. a slice of a larger arena)
+	void InitBuffer(void *buffer, int maxsize, bool* ovrn, const char *name)
+	{
+		daty = (T*)buffer;
+		avail = size = maxsize;
+		overrun = ovrn;
+		list_name = name;
+		overrun_size = 0;
+		owned = false;
 	}
 
 	void Init(int maxsize,bool* ovrn, const char *name)
@@ -86,7 +103,9 @@ struct List
 	void Free()
 	{
 		Clear();
-		free(daty);
+		if (owned)
+			free(daty);
+		daty = nullptr;
 	}
 
 	T* begin() const { return head(); }
@@ -1,12 +1,13 @@
 /*
 	PowerVR interface to plugins
-	Handles YUV conversion (slow and ugly -- but hey it works ...)
+	Handles YUV conversion
 
 	Most of this was hacked together when i needed support for YUV-dma for thps2 ;)
 */
 #include "pvr_mem.h"
 #include "Renderer_if.h"
 #include "ta.h"
+#include "yuv_conv.h"
 #include "hw/holly/sb.h"
 #include "hw/holly/holly_intc.h"
 
@@ -51,60 +52,15 @@ void YUV_init()
 	YUV_index = 0;
 }
 
-static void YUV_Block8x8(const u8* inuv, const u8* iny, u8* out)
-{
-	u8* line_out_0=out+0;
-	u8* line_out_1=out+YUV_x_size*2;
-
-	for (int y=0;y<8;y+=2)
-	{
-		for (int x=0;x<8;x+=2)
-		{
-			u8 u=inuv[0];
-			u8 v=inuv[64];
-
-			line_out_0[0]=u;
-			line_out_0[1]=iny[0];
-			line_out_0[2]=v;
-			line_out_0[3]=iny[1];
-
-			line_out_1[0]=u;
-			line_out_1[1]=iny[8+0];
-			line_out_1[2]=v;
-			line_out_1[3]=iny[8+1];
-
-			inuv+=1;
-			iny+=2;
-
-			line_out_0+=4;
-			line_out_1+=4;
-		}
-		iny+=8;
-		inuv+=4;
-
-		line_out_0+=YUV_x_size*4-8*2;
-		line_out_1+=YUV_x_size*4-8*2;
-	}
-}
-
-static INLINE void YUV_Block384(const u8 *in, u8 *out)
-{
-	const u8 *inuv = in;
-	const u8 *iny = in + 128;
-	u8* p_out = out;
-
-	YUV_Block8x8(inuv+ 0,iny+  0,p_out);                    //(0,0)
-	YUV_Block8x8(inuv+ 4,iny+64,p_out+8*2);                 //(8,0)
-	YUV_Block8x8(inuv+32,iny+128,p_out+YUV_x_size*8*2);     //(0,8)
-	YUV_Block8x8(inuv+36,iny+192,p_out+YUV_x_size*8*2+8*2); //(8,8)
-}
-
 static INLINE void YUV_ConvertMacroBlock(const u8 *datap)
 {
 	//do shit
 	TA_YUV_TEX_CNT++;
 
-	YUV_Block384(datap, vram.data + YUV_dest);
+	if (TA_YUV_TEX_CTRL.yuv_form == 0)
+		YUV420_Convert(datap, vram.data + YUV_dest, YUV_x_size * 2);
+	else
+		YUV422_Convert(datap, vram.data + YUV_dest, YUV_x_size * 2);
 
 	YUV_dest+=32;
 
@@ -137,9 +93,7 @@ static void YUV_data(const SQBuffer *data, u32 count)
 		YUV_init();
 	}
 
-	u32 block_size = TA_YUV_TEX_CTRL.yuv_form == 0 ? 384 : 512;
-	verify(block_size == 384); // no support for 512
-	block_size /= sizeof(SQBuffer);
+	u32 block_size = (TA_YUV_TEX_CTRL.yuv_form == 0 ? 384 : 512) / sizeof(SQBuffer);
 
 	while (count > 0)
 	{
@@ -231,6 +185,16 @@ template void pvr_write32p<u8>(u32 addr, u8 data);
 template void pvr_write32p<u16>(u32 addr, u16 data);
 template void pvr_write32p<u32>(u32 addr, u32 data);
 
+void pvr_write32_block(u32 addr, const u32 *data, u32 len)
+{
+	u32 vaddr = addr & VRAM_MASK;
+	if (vaddr < fb_watch_addr_end && vaddr + len > fb_watch_addr_start)
+		fb_dirty = true;
+
+	for (u32 i = 0; i < len / 4; i++, addr += 4)
+		*(u32 *)&vram[pvr_map32(addr)] = data[i];
+}
+
 void DYNACALL TAWrite(u32 address, const SQBuffer *data, u32 count)
 {
 	if ((address & 0x800000) == 0)
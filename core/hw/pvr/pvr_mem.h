@@ -20,6 +20,8 @@ void YUV_unserialize(void **data, unsigned int *total_size, serialize_version_en
 // 32-bit vram path handlers
 template<typename T> T DYNACALL pvr_read32p(u32 addr);
 template<typename T> void DYNACALL pvr_write32p(u32 addr, T data);
+// Copies len bytes to the 32-bit vram path
+void pvr_write32_block(u32 addr, const u32 *data, u32 len);
 // Area 4 handlers
 template<typename T, bool upper> T DYNACALL pvr_read_area4(u32 addr);
 template<typename T, bool upper> void DYNACALL pvr_write_area4(u32 addr, T data);
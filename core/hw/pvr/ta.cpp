@@ -328,25 +328,46 @@ void DYNACALL ta_vtx_data32(const SQBuffer *data)
 	ta_thd_data32_i((const simd256_t *)data);
 }
 
+// Bulk ingest: the context and overflow checks are done once for all the records that fit
+// in the TA buffer. Each record is copied and goes through the state machine in a single pass
 void ta_vtx_data(const SQBuffer *data, u32 size)
 {
-	while (size >= 4)
+	if (ta_ctx == NULL)
 	{
-		ta_thd_data32_i((simd256_t *)data);
-		data++;
-		ta_thd_data32_i((simd256_t *)data);
-		data++;
-		ta_thd_data32_i((simd256_t *)data);
-		data++;
-		ta_thd_data32_i((simd256_t *)data);
-		data++;
-		size -= 4;
+		INFO_LOG(PVR, "Warning: data sent to TA prior to ListInit. Ignored");
+		return;
 	}
-
 	while (size > 0)
 	{
-		ta_thd_data32_i((simd256_t *)data);
-		data++;
-		size--;
+		if (ta_tad.End() - ta_tad.thd_root >= TA_DATA_SIZE)
+		{
+			INFO_LOG(PVR, "Warning: TA data buffer overflow");
+			asic_RaiseInterrupt(holly_MATR_NOMEM);
+			return;
+		}
+		u32 count = std::min<u32>(size, (ta_tad.thd_root + TA_DATA_SIZE - ta_tad.thd_data) / sizeof(SQBuffer));
+		const simd256_t *src = (const simd256_t *)data;
+		simd256_t *dst = (simd256_t *)ta_tad.thd_data;
+		simd256_t * const end = dst + count;
+		data += count;
+		size -= count;
+
+		u32 state = ta_cur_state;
+		while (dst < end)
+		{
+			PCW pcw = *(const PCW *)src;
+			*dst++ = *src++;
+			u32 trans = ta_fsm[(state << 8) | (pcw.ParaType << 5) | ((pcw.obj_ctrl >> 2) & 31)];
+			state = trans;
+			if (unlikely(trans & 0xF0))
+			{
+				// ta_handle_cmd works on the last record
+				ta_tad.thd_data = (u8 *)dst;
+				ta_handle_cmd(trans);
+				state = ta_cur_state;
+			}
+		}
+		ta_cur_state = (ta_state)state;
+		ta_tad.thd_data = (u8 *)end;
 	}
 }
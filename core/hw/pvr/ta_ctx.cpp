@@ -1,9 +1,13 @@
 #include "ta_ctx.h"
 #include "spg.h"
 #include "cfg/option.h"
+#include "oslib/oslib.h"
 #if defined(__SWITCH__)
 #include <malloc.h>
 #endif
+#if defined(__linux__) && !defined(__ANDROID__)
+#include <sys/mman.h>
+#endif
 
 extern u32 fskip;
 extern u32 FrameCount;
@@ -46,6 +50,248 @@ void OS_aligned_free(void *ptr)
 }
 
 
+/*
+	TA context arena
+
+	The TA data and all the rend_context lists of a context live in a single allocation.
+	List capacities start at the historical fixed sizes and grow with the high-water mark
+	observed over recent frames. An arena is only reallocated when a pooled context is
+	reused by tactx_Alloc, never while the TA or the renderer may refer to it.
+*/
+enum {
+	LIST_VERTS,
+	LIST_IDX,
+	LIST_OP,
+	LIST_PT,
+	LIST_TR,
+	LIST_MVO,
+	LIST_MVO_TR,
+	LIST_MODTRIG,
+	LIST_PASSES,
+	LIST_COUNT
+};
+
+struct ListSizing
+{
+	ListSizing(u32 minCapacity) : minCapacity(minCapacity), capacity(minCapacity), peak(0) {}
+
+	u32 minCapacity;
+	u32 capacity;
+	u32 peak;		// decaying high-water mark, in elements
+};
+
+static ListSizing listSizing[LIST_COUNT] = {
+	{ 4 * 1024 * 1024 / sizeof(Vertex) },	//up to 4 mb of vtx data/frame = ~ 96k vtx/frame
+	{ 120 * 1024 },							//up to 120K indexes ( idx have stripification overhead )
+	{ 16384 },
+	{ 5120 },
+	{ 10240 },
+	{ 4096 },
+	{ 4096 },
+	{ 16384 },
+	{ 10 },									// 10 render passes
+};
+static std::mutex mtx_sizing;
+static TA_arena_stats arenaStats;
+
+const TA_arena_stats& tactx_GetArenaStats()
+{
+	return arenaStats;
+}
+
+static constexpr size_t ArenaAlign = 64;
+
+static size_t alignArena(size_t size)
+{
+	return (size + ArenaAlign - 1) & ~(ArenaAlign - 1);
+}
+
+template<typename T>
+static size_t carveList(List<T>& list, u8 *arena, size_t offset, u32 capacity, bool *overrun, const char *name)
+{
+	list.InitBuffer(arena + offset, capacity, overrun, name);
+	return alignArena(offset + capacity * sizeof(T));
+}
+
+static const size_t listElementSize[LIST_COUNT] = {
+	sizeof(Vertex),
+	sizeof(u32),
+	sizeof(PolyParam),
+	sizeof(PolyParam),
+	sizeof(PolyParam),
+	sizeof(ModifierVolumeParam),
+	sizeof(ModifierVolumeParam),
+	sizeof(ModTriangle),
+	sizeof(RenderPass),
+};
+
+// Size of an arena holding lists of the given capacities. Must match layoutArena
+static size_t arenaSizeFor(const u32 *capacity)
+{
+	size_t offset = TA_DATA_SIZE;
+	for (int i = 0; i < LIST_COUNT; i++)
+		offset = alignArena(offset + capacity[i] * listElementSize[i]);
+	return offset;
+}
+
+static void currentCapacities(u32 *capacity)
+{
+	std::lock_guard<std::mutex> lock(mtx_sizing);
+	for (int i = 0; i < LIST_COUNT; i++)
+		capacity[i] = listSizing[i].capacity;
+}
+
+// True if the arena of the context is smaller than the current list capacities
+static bool arenaTooSmall(const rend_context& rend, const u32 *capacity)
+{
+	return (u32)rend.verts.size < capacity[LIST_VERTS]
+			|| (u32)rend.idx.size < capacity[LIST_IDX]
+			|| (u32)rend.global_param_op.size < capacity[LIST_OP]
+			|| (u32)rend.global_param_pt.size < capacity[LIST_PT]
+			|| (u32)rend.global_param_tr.size < capacity[LIST_TR]
+			|| (u32)rend.global_param_mvo.size < capacity[LIST_MVO]
+			|| (u32)rend.global_param_mvo_tr.size < capacity[LIST_MVO_TR]
+			|| (u32)rend.modtrig.size < capacity[LIST_MODTRIG]
+			|| (u32)rend.render_passes.size < capacity[LIST_PASSES];
+}
+
+// Lays out the lists in the arena
+static size_t layoutArena(rend_context& rend, u8 *base, const u32 *capacity)
+{
+	bool *ovr = &rend.Overrun;
+	size_t offset = TA_DATA_SIZE;
+	offset = carveList(rend.verts, base, offset, capacity[LIST_VERTS], ovr, "verts");
+	offset = carveList(rend.idx, base, offset, capacity[LIST_IDX], ovr, "idx");
+	offset = carveList(rend.global_param_op, base, offset, capacity[LIST_OP], ovr, "global_param_op");
+	offset = carveList(rend.global_param_pt, base, offset, capacity[LIST_PT], ovr, "global_param_pt");
+	offset = carveList(rend.global_param_tr, base, offset, capacity[LIST_TR], ovr, "global_param_tr");
+	offset = carveList(rend.global_param_mvo, base, offset, capacity[LIST_MVO], ovr, "global_param_mvo");
+	offset = carveList(rend.global_param_mvo_tr, base, offset, capacity[LIST_MVO_TR], ovr, "global_param_mvo_tr");
+	offset = carveList(rend.modtrig, base, offset, capacity[LIST_MODTRIG], ovr, "modtrig");
+	offset = carveList(rend.render_passes, base, offset, capacity[LIST_PASSES], ovr, "render_passes");
+	return offset;
+}
+
+template<typename T>
+static void updateSizing(List<T>& list, ListSizing& sizing)
+{
+	u32 used = std::max(list.used(), list.overrun_size);
+	list.overrun_size = 0;
+	// decays by ~1.5% per frame
+	sizing.peak = std::max(used, sizing.peak - sizing.peak / 64);
+	if (sizing.peak > sizing.capacity - sizing.capacity / 4)
+		sizing.capacity = std::max(sizing.peak * 2, sizing.minCapacity);
+}
+
+// Records the list usage of the last frame
+static void updateArenaSizing(rend_context& rend)
+{
+	std::lock_guard<std::mutex> lock(mtx_sizing);
+	if (rend.Overrun)
+		arenaStats.overruns++;
+	updateSizing(rend.verts, listSizing[LIST_VERTS]);
+	updateSizing(rend.idx, listSizing[LIST_IDX]);
+	updateSizing(rend.global_param_op, listSizing[LIST_OP]);
+	updateSizing(rend.global_param_pt, listSizing[LIST_PT]);
+	updateSizing(rend.global_param_tr, listSizing[LIST_TR]);
+	updateSizing(rend.global_param_mvo, listSizing[LIST_MVO]);
+	updateSizing(rend.global_param_mvo_tr, listSizing[LIST_MVO_TR]);
+	updateSizing(rend.modtrig, listSizing[LIST_MODTRIG]);
+	updateSizing(rend.render_passes, listSizing[LIST_PASSES]);
+}
+
+static u8 *allocArena(size_t& size, bool& mapped)
+{
+#if defined(__linux__) && !defined(__ANDROID__) && defined(MADV_HUGEPAGE)
+	// Use transparent huge pages when available to reduce TLB pressure
+	const size_t hugePageSize = 2 * 1024 * 1024;
+	size_t mapSize = (size + hugePageSize - 1) & ~(hugePageSize - 1);
+	void *p = mmap(nullptr, mapSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (p != MAP_FAILED)
+	{
+		madvise(p, mapSize, MADV_HUGEPAGE);
+		size = mapSize;
+		mapped = true;
+		return (u8 *)p;
+	}
+#endif
+	mapped = false;
+	return (u8 *)OS_aligned_malloc(ArenaAlign, size);
+}
+
+static void freeArena(u8 *arena, size_t size, bool mapped)
+{
+#if defined(__linux__) && !defined(__ANDROID__) && defined(MADV_HUGEPAGE)
+	if (mapped)
+	{
+		munmap(arena, size);
+		return;
+	}
+#endif
+	OS_aligned_free(arena);
+}
+
+static void createArena(TA_context& ctx)
+{
+	double start = os_GetSeconds();
+	u32 capacity[LIST_COUNT];
+	currentCapacities(capacity);
+
+	ctx.arenaSize = arenaSizeFor(capacity);
+	ctx.arena = allocArena(ctx.arenaSize, ctx.arenaMapped);
+	verify(ctx.arena != nullptr);
+	size_t used = layoutArena(ctx.rend, ctx.arena, capacity);
+	verify(used <= ctx.arenaSize);
+	ctx.tad.Reset(ctx.arena);
+
+	std::lock_guard<std::mutex> lock(mtx_sizing);
+	arenaStats.allocations++;
+	arenaStats.allocTimeUs += (u64)((os_GetSeconds() - start) * 1000000.0);
+	arenaStats.arenaBytes += ctx.arenaSize;
+	arenaStats.peakArenaBytes = std::max(arenaStats.peakArenaBytes, arenaStats.arenaBytes);
+	arenaStats.hugePages = ctx.arenaMapped;
+}
+
+static void releaseArena(TA_context& ctx)
+{
+	if (ctx.arena == nullptr)
+		return;
+	freeArena(ctx.arena, ctx.arenaSize, ctx.arenaMapped);
+	mtx_sizing.lock();
+	arenaStats.arenaBytes -= ctx.arenaSize;
+	mtx_sizing.unlock();
+	ctx.arena = nullptr;
+	ctx.arenaSize = 0;
+	ctx.tad.Reset(nullptr);
+}
+
+void TA_context::Alloc()
+{
+	createArena(*this);
+	rend_inuse.lock();
+	rend.Clear();
+	rend.proc_end = rend.proc_start = tad.thd_root;
+	rend_inuse.unlock();
+}
+
+void TA_context::Reset()
+{
+	verify(tad.End() - tad.thd_root <= TA_DATA_SIZE);
+	rend_inuse.lock();
+	// The arena is only resized by tactx_Alloc: the TA state may still point into it
+	updateArenaSizing(rend);
+	tad.Clear();
+	rend.Clear();
+	rend.proc_end = rend.proc_start = tad.thd_root;
+	rend_inuse.unlock();
+}
+
+void TA_context::Free()
+{
+	verify(tad.End() - tad.thd_root <= TA_DATA_SIZE);
+	releaseArena(*this);
+}
+
 void SetCurrentTARC(u32 addr)
 {
 	if (addr != TACTX_NONE)
@@ -165,6 +411,20 @@ TA_context* tactx_Alloc()
 		rv = new TA_context();
 		rv->Alloc();
 	}
+	else
+	{
+		u32 capacity[LIST_COUNT];
+		currentCapacities(capacity);
+		if (arenaTooSmall(rv->rend, capacity))
+		{
+			// Nothing refers to a pooled context so its arena can be replaced
+			releaseArena(*rv);
+			rv->Alloc();
+			mtx_sizing.lock();
+			arenaStats.regrows++;
+			mtx_sizing.unlock();
+		}
+	}
 
 	return rv;
 }
@@ -246,6 +506,11 @@ void tactx_Term()
 	}
 	ctx_pool.clear();
 	mtx_pool.unlock();
+
+	const TA_arena_stats& stats = tactx_GetArenaStats();
+	INFO_LOG(PVR, "TA arenas: %u allocations (%u regrows) in %.2f ms, peak %u KB, %u overruns, huge pages %s",
+			(u32)stats.allocations, stats.regrows, stats.allocTimeUs / 1000.0, (u32)(stats.peakArenaBytes / 1024),
+			stats.overruns, stats.hugePages ? "yes" : "no");
 }
 
 const u32 NULL_CONTEXT = ~0u;
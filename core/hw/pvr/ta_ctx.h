@@ -206,51 +206,27 @@ struct TA_context
 		rend.proc_end = render_pass == tad.render_pass_count ? tad.End() : tad.render_passes[render_pass];
 	}
 
-	void Alloc()
-	{
-		tad.Reset((u8*)OS_aligned_malloc(32, TA_DATA_SIZE));
-
-		rend.verts.InitBytes(4 * 1024 * 1024, &rend.Overrun, "verts");	//up to 4 mb of vtx data/frame = ~ 96k vtx/frame
-		rend.idx.Init(120 * 1024, &rend.Overrun, "idx");				//up to 120K indexes ( idx have stripification overhead )
-		rend.global_param_op.Init(16384, &rend.Overrun, "global_param_op");
-		rend.global_param_pt.Init(5120, &rend.Overrun, "global_param_pt");
-		rend.global_param_mvo.Init(4096, &rend.Overrun, "global_param_mvo");
-		rend.global_param_tr.Init(10240, &rend.Overrun, "global_param_tr");
-		rend.global_param_mvo_tr.Init(4096, &rend.Overrun, "global_param_mvo_tr");
-
-		rend.modtrig.Init(16384, &rend.Overrun, "modtrig");
-		
-		rend.render_passes.Init(sizeof(RenderPass) * 10, &rend.Overrun, "render_passes");	// 10 render passes
-
-		Reset();
-	}
-
-	void Reset()
-	{
-		verify(tad.End() - tad.thd_root <= TA_DATA_SIZE);
-		tad.Clear();
-		rend_inuse.lock();
-		rend.Clear();
-		rend.proc_end = rend.proc_start = tad.thd_root;
-		rend_inuse.unlock();
-	}
-
-	void Free()
-	{
-		verify(tad.End() - tad.thd_root <= TA_DATA_SIZE);
-		OS_aligned_free(tad.thd_root);
-		rend.verts.Free();
-		rend.idx.Free();
-		rend.global_param_op.Free();
-		rend.global_param_pt.Free();
-		rend.global_param_tr.Free();
-		rend.modtrig.Free();
-		rend.global_param_mvo.Free();
-		rend.global_param_mvo_tr.Free();
-		rend.render_passes.Free();
-	}
+	// Single allocation backing the TA data and all the rend lists
+	u8 *arena = nullptr;
+	size_t arenaSize = 0;
+	bool arenaMapped = false;
+
+	void Alloc();
+	void Reset();
+	void Free();
 };
 
+struct TA_arena_stats
+{
+	u64 allocations;		// arena (re)allocations
+	u64 allocTimeUs;		// total time spent allocating arenas
+	u64 arenaBytes;			// bytes currently reserved by all arenas
+	u64 peakArenaBytes;
+	u32 overruns;			// frames dropped because a list overran
+	u32 regrows;			// arenas reallocated to a larger size
+	bool hugePages;			// last arena is huge-page backed
+};
+const TA_arena_stats& tactx_GetArenaStats();
 
 extern TA_context* ta_ctx;
 extern tad_context ta_tad;
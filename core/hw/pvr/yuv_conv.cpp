@@ -0,0 +1,137 @@
+/*
+	Copyright 2021 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#include "yuv_conv.h"
+
+#if HOST_CPU == CPU_X64 || (HOST_CPU == CPU_X86 && defined(__SSE2__))
+#define YUV_SSE2
+#include <emmintrin.h>
+#elif HOST_CPU == CPU_ARM64 || (HOST_CPU == CPU_ARM && defined(__ARM_NEON__))
+#define YUV_NEON
+#include <arm_neon.h>
+#endif
+
+// Y samples of the 16 texels of line y
+static inline const u8 *yLine(const u8 *iny, u32 y, u32 half)
+{
+	return iny + (y / 8) * 128 + half * 64 + (y & 7) * 8;
+}
+
+// uvShift is 1 for YUV420 (one U/V line for 2 texel lines) and 0 for YUV422
+template<u32 uvShift>
+static void convertScalar(const u8 *in, u8 *out, u32 stride)
+{
+	const u8 *inu = in;
+	const u8 *inv = in + (64 << (1 - uvShift));
+	const u8 *iny = inv + (64 << (1 - uvShift));
+
+	for (u32 y = 0; y < 16; y++)
+	{
+		const u8 *u = inu + (y >> uvShift) * 8;
+		const u8 *v = inv + (y >> uvShift) * 8;
+		u8 *line = out + y * stride;
+		for (u32 half = 0; half < 2; half++)
+		{
+			const u8 *py = yLine(iny, y, half);
+			for (u32 x = 0; x < 4; x++)
+			{
+				line[0] = u[half * 4 + x];
+				line[1] = py[x * 2];
+				line[2] = v[half * 4 + x];
+				line[3] = py[x * 2 + 1];
+				line += 4;
+			}
+		}
+	}
+}
+
+void YUV420_ConvertScalar(const u8 *in, u8 *out, u32 stride)
+{
+	convertScalar<1>(in, out, stride);
+}
+
+void YUV422_ConvertScalar(const u8 *in, u8 *out, u32 stride)
+{
+	convertScalar<0>(in, out, stride);
+}
+
+#if defined(YUV_SSE2)
+
+template<u32 uvShift>
+static void convertSimd(const u8 *in, u8 *out, u32 stride)
+{
+	const u8 *inu = in;
+	const u8 *inv = in + (64 << (1 - uvShift));
+	const u8 *iny = inv + (64 << (1 - uvShift));
+
+	for (u32 y = 0; y < 16; y++)
+	{
+		__m128i u = _mm_loadl_epi64((const __m128i *)(inu + (y >> uvShift) * 8));
+		__m128i v = _mm_loadl_epi64((const __m128i *)(inv + (y >> uvShift) * 8));
+		__m128i yy = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i *)yLine(iny, y, 0)),
+				_mm_loadl_epi64((const __m128i *)yLine(iny, y, 1)));
+		// U0 V0 U1 V1 ...
+		__m128i uv = _mm_unpacklo_epi8(u, v);
+		// U0 Y0 V0 Y1 ...
+		u8 *line = out + y * stride;
+		_mm_storeu_si128((__m128i *)line, _mm_unpacklo_epi8(uv, yy));
+		_mm_storeu_si128((__m128i *)(line + 16), _mm_unpackhi_epi8(uv, yy));
+	}
+}
+
+#elif defined(YUV_NEON)
+
+template<u32 uvShift>
+static void convertSimd(const u8 *in, u8 *out, u32 stride)
+{
+	const u8 *inu = in;
+	const u8 *inv = in + (64 << (1 - uvShift));
+	const u8 *iny = inv + (64 << (1 - uvShift));
+
+	for (u32 y = 0; y < 16; y++)
+	{
+		// Even and odd Y samples
+		uint8x8x2_t yy = vuzp_u8(vld1_u8(yLine(iny, y, 0)), vld1_u8(yLine(iny, y, 1)));
+		uint8x8x4_t uyvy;
+		uyvy.val[0] = vld1_u8(inu + (y >> uvShift) * 8);
+		uyvy.val[1] = yy.val[0];
+		uyvy.val[2] = vld1_u8(inv + (y >> uvShift) * 8);
+		uyvy.val[3] = yy.val[1];
+		vst4_u8(out + y * stride, uyvy);
+	}
+}
+
+#endif
+
+void YUV420_Convert(const u8 *in, u8 *out, u32 stride)
+{
+#if defined(YUV_SSE2) || defined(YUV_NEON)
+	convertSimd<1>(in, out, stride);
+#else
+	convertScalar<1>(in, out, stride);
+#endif
+}
+
+void YUV422_Convert(const u8 *in, u8 *out, u32 stride)
+{
+#if defined(YUV_SSE2) || defined(YUV_NEON)
+	convertSimd<0>(in, out, stride);
+#else
+	convertScalar<0>(in, out, stride);
+#endif
+}
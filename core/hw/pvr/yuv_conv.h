@@ -0,0 +1,34 @@
+/*
+	Copyright 2021 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#pragma once
+#include "types.h"
+
+//
+// Conversion of the YUV converter macroblocks to 16x16 UYVY (YUV422) texels.
+// Input:
+// - YUV420 (384 bytes): U 8x8, V 8x8, then four 8x8 Y blocks (top-left, top-right, bottom-left, bottom-right)
+// - YUV422 (512 bytes): U 8x16, V 8x16, then the four 8x8 Y blocks
+// stride is the size of an output line in bytes.
+//
+void YUV420_ConvertScalar(const u8 *in, u8 *out, u32 stride);
+void YUV422_ConvertScalar(const u8 *in, u8 *out, u32 stride);
+
+// Use SSE2 or NEON when available
+void YUV420_Convert(const u8 *in, u8 *out, u32 stride);
+void YUV422_Convert(const u8 *in, u8 *out, u32 stride);
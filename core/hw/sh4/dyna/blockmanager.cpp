@@ -13,6 +13,7 @@
 #include "hw/sh4/sh4_mem.h"
 #include "hw/sh4/sh4_opcode_list.h"
 #include "hw/sh4/sh4_sched.h"
+#include "hw/sh4/sh4_interpreter.h"
 
 
 #if defined(__unix__) && defined(DYNA_OPROF)
@@ -20,6 +21,78 @@
 op_agent_t          oprofHandle;
 #endif
 
+// RAM page write protection, used by the dynarec blocks and the interpreter decode cache
+bool unprotected_pages[RAM_SIZE_MAX/PAGE_SIZE];
+
+static void bm_LockPage(u32 addr)
+{
+	addr = addr & (RAM_MASK - PAGE_MASK);
+	if (_nvmem_enabled())
+	{
+		mem_region_lock(virt_ram_base + 0x0C000000 + addr, PAGE_SIZE);
+		if (_nvmem_4gb_space())
+		{
+			mem_region_lock(virt_ram_base + 0x8C000000 + addr, PAGE_SIZE);
+			mem_region_lock(virt_ram_base + 0xAC000000 + addr, PAGE_SIZE);
+			// TODO wraps
+		}
+	}
+	else
+	{
+		mem_region_lock(&mem_b[addr], PAGE_SIZE);
+	}
+}
+
+static void bm_UnlockPage(u32 addr)
+{
+	addr = addr & (RAM_MASK - PAGE_MASK);
+	if (_nvmem_enabled())
+	{
+		mem_region_unlock(virt_ram_base + 0x0C000000 + addr, PAGE_SIZE);
+		if (_nvmem_4gb_space())
+		{
+			mem_region_unlock(virt_ram_base + 0x8C000000 + addr, PAGE_SIZE);
+			mem_region_unlock(virt_ram_base + 0xAC000000 + addr, PAGE_SIZE);
+			// TODO wraps
+		}
+	}
+	else
+	{
+		mem_region_unlock(&mem_b[addr], PAGE_SIZE);
+	}
+}
+
+static void bm_UnlockAllRamPages()
+{
+	if (_nvmem_enabled())
+	{
+		// Windows cannot lock/unlock a region spanning more than one VirtualAlloc or MapViewOfFile
+		// so we have to unlock each region individually
+		// No need for this mess in 4GB mode since windows doesn't use it
+		if (settings.platform.ram_size == 16 * 1024 * 1024)
+		{
+			mem_region_unlock(virt_ram_base + 0x0C000000, RAM_SIZE);
+			mem_region_unlock(virt_ram_base + 0x0D000000, RAM_SIZE);
+			mem_region_unlock(virt_ram_base + 0x0E000000, RAM_SIZE);
+			mem_region_unlock(virt_ram_base + 0x0F000000, RAM_SIZE);
+		}
+		else
+		{
+			mem_region_unlock(virt_ram_base + 0x0C000000, RAM_SIZE);
+			mem_region_unlock(virt_ram_base + 0x0E000000, RAM_SIZE);
+		}
+		if (_nvmem_4gb_space())
+		{
+			mem_region_unlock(virt_ram_base + 0x8C000000u, 0x90000000u - 0x8C000000u);
+			mem_region_unlock(virt_ram_base + 0xAC000000u, 0xB0000000u - 0xAC000000u);
+		}
+	}
+	else
+	{
+		mem_region_unlock(&mem_b[0], RAM_SIZE);
+	}
+}
+
 #if FEAT_SHREC != DYNAREC_NONE
 
 
@@ -30,7 +103,6 @@ typedef std::map<void*, RuntimeBlockInfoPtr> bm_Map;
 static bm_Set all_temp_blocks;
 static bm_List del_blocks;
 
-bool unprotected_pages[RAM_SIZE_MAX/PAGE_SIZE];
 static std::set<RuntimeBlockInfo*> blocks_per_page[RAM_SIZE_MAX/PAGE_SIZE];
 
 static bm_Map blkmap;
@@ -92,12 +164,20 @@ DynarecCodeEntryPtr DYNACALL bm_GetCodeByVAddr(u32 addr)
 	}
 
 	u32 paddr;
+#ifdef FAST_MMU
+	if (mmuITlbCacheLookup(addr, paddr))
+		return bm_GetCode(paddr);
+#endif
 	u32 rv = mmu_instruction_translation(addr, paddr);
 	if (rv != MMU_ERROR_NONE)
 	{
 		DoMMUException(addr, rv, MMU_TT_IREAD);
 		mmu_instruction_translation(next_pc, paddr);
 	}
+#ifdef FAST_MMU
+	else if (mmu_is_translated(addr, 2))
+		mmuITlbCacheAdd(addr, paddr);
+#endif
 
 	return bm_GetCode(paddr);
 }
@@ -231,71 +311,9 @@ void bm_Reset()
 	protected_blocks = 0;
 	unprotected_blocks = 0;
 
-	if (_nvmem_enabled())
-	{
-		// Windows cannot lock/unlock a region spanning more than one VirtualAlloc or MapViewOfFile
-		// so we have to unlock each region individually
-		// No need for this mess in 4GB mode since windows doesn't use it
-		if (settings.platform.ram_size == 16 * 1024 * 1024)
-		{
-			mem_region_unlock(virt_ram_base + 0x0C000000, RAM_SIZE);
-			mem_region_unlock(virt_ram_base + 0x0D000000, RAM_SIZE);
-			mem_region_unlock(virt_ram_base + 0x0E000000, RAM_SIZE);
-			mem_region_unlock(virt_ram_base + 0x0F000000, RAM_SIZE);
-		}
-		else
-		{
-			mem_region_unlock(virt_ram_base + 0x0C000000, RAM_SIZE);
-			mem_region_unlock(virt_ram_base + 0x0E000000, RAM_SIZE);
-		}
-		if (_nvmem_4gb_space())
-		{
-			mem_region_unlock(virt_ram_base + 0x8C000000u, 0x90000000u - 0x8C000000u);
-			mem_region_unlock(virt_ram_base + 0xAC000000u, 0xB0000000u - 0xAC000000u);
-		}
-	}
-	else
-	{
-		mem_region_unlock(&mem_b[0], RAM_SIZE);
-	}
-}
-
-static void bm_LockPage(u32 addr)
-{
-	addr = addr & (RAM_MASK - PAGE_MASK);
-	if (_nvmem_enabled())
-	{
-		mem_region_lock(virt_ram_base + 0x0C000000 + addr, PAGE_SIZE);
-		if (_nvmem_4gb_space())
-		{
-			mem_region_lock(virt_ram_base + 0x8C000000 + addr, PAGE_SIZE);
-			mem_region_lock(virt_ram_base + 0xAC000000 + addr, PAGE_SIZE);
-			// TODO wraps
-		}
-	}
-	else
-	{
-		mem_region_lock(&mem_b[addr], PAGE_SIZE);
-	}
-}
-
-static void bm_UnlockPage(u32 addr)
-{
-	addr = addr & (RAM_MASK - PAGE_MASK);
-	if (_nvmem_enabled())
-	{
-		mem_region_unlock(virt_ram_base + 0x0C000000 + addr, PAGE_SIZE);
-		if (_nvmem_4gb_space())
-		{
-			mem_region_unlock(virt_ram_base + 0x8C000000 + addr, PAGE_SIZE);
-			mem_region_unlock(virt_ram_base + 0xAC000000 + addr, PAGE_SIZE);
-			// TODO wraps
-		}
-	}
-	else
-	{
-		mem_region_unlock(&mem_b[addr], PAGE_SIZE);
-	}
+	bm_UnlockAllRamPages();
+	// All pages are writable again
+	sh4int_ResetDecodeCache();
 }
 
 void bm_ResetCache()
@@ -547,11 +565,12 @@ void RuntimeBlockInfo::Discard()
 	if (read_only)
 	{
 		// Remove this block from the per-page block lists
-		for (u32 addr = this->addr & ~PAGE_MASK; addr < this->addr + this->sh4_code_size; addr += PAGE_SIZE)
-		{
-			auto& block_list = blocks_per_page[(addr & RAM_MASK) / PAGE_SIZE];
-			block_list.erase(this);
-		}
+		for (const BlockCheckRange& range : sh4_check_ranges)
+			for (u32 addr = range.addr & ~PAGE_MASK; addr < range.addr + range.size; addr += PAGE_SIZE)
+			{
+				auto& block_list = blocks_per_page[(addr & RAM_MASK) / PAGE_SIZE];
+				block_list.erase(this);
+			}
 	}
 }
 
@@ -564,75 +583,26 @@ void RuntimeBlockInfo::SetProtectedFlags()
 		unprotected_blocks++;
 		return;
 	}
-	for (u32 addr = this->addr & ~PAGE_MASK; addr < this->addr + sh4_code_size; addr += PAGE_SIZE)
-	{
-		if (unprotected_pages[(addr & RAM_MASK) / PAGE_SIZE])
+	for (const BlockCheckRange& range : sh4_check_ranges)
+		for (u32 addr = range.addr & ~PAGE_MASK; addr < range.addr + range.size; addr += PAGE_SIZE)
 		{
-			this->read_only = false;
-			unprotected_blocks++;
-			return;
+			if (unprotected_pages[(addr & RAM_MASK) / PAGE_SIZE])
+			{
+				this->read_only = false;
+				unprotected_blocks++;
+				return;
+			}
 		}
-	}
 	this->read_only = true;
 	protected_blocks++;
-	for (u32 addr = this->addr & ~PAGE_MASK; addr < this->addr + sh4_code_size; addr += PAGE_SIZE)
-	{
-		auto& block_list = blocks_per_page[(addr & RAM_MASK) / PAGE_SIZE];
-		if (block_list.empty())
-			bm_LockPage(addr);
-		block_list.insert(this);
-	}
-}
-
-void bm_RamWriteAccess(u32 addr)
-{
-	addr &= RAM_MASK;
-	if (unprotected_pages[addr / PAGE_SIZE])
-	{
-		ERROR_LOG(DYNAREC, "Page %08x already unprotected", addr);
-		die("Fatal error");
-	}
-	unprotected_pages[addr / PAGE_SIZE] = true;
-	bm_UnlockPage(addr);
-	std::set<RuntimeBlockInfo*>& block_list = blocks_per_page[addr / PAGE_SIZE];
-	std::vector<RuntimeBlockInfo*> list_copy;
-	list_copy.insert(list_copy.begin(), block_list.begin(), block_list.end());
-	if (!list_copy.empty())
-		DEBUG_LOG(DYNAREC, "bm_RamWriteAccess write access to %08x pc %08x", addr, next_pc);
-	for (auto& block : list_copy)
-	{
-		bm_DiscardBlock(block);
-	}
-	verify(block_list.empty());
-}
-
-bool bm_RamWriteAccess(void *p)
-{
-	if (_nvmem_enabled())
-	{
-		if (_nvmem_4gb_space())
+	for (const BlockCheckRange& range : sh4_check_ranges)
+		for (u32 addr = range.addr & ~PAGE_MASK; addr < range.addr + range.size; addr += PAGE_SIZE)
 		{
-			if ((u8 *)p < virt_ram_base || (u8 *)p >= virt_ram_base + 0x100000000L)
-				return false;
-		}
-		else
-		{
-			if ((u8 *)p < virt_ram_base || (u8 *)p >= virt_ram_base + 0x20000000)
-				return false;
+			auto& block_list = blocks_per_page[(addr & RAM_MASK) / PAGE_SIZE];
+			if (block_list.empty())
+				bm_LockPage(addr);
+			block_list.insert(this);
 		}
-		u32 addr = (u8*)p - virt_ram_base;
-		if (!IsOnRam(addr) || ((addr >> 29) > 0 && (addr >> 29) < 4))	// system RAM is not mapped to 20, 40 and 60 because of laziness
-			return false;
-		bm_RamWriteAccess(addr);
-	}
-	else
-	{
-		if ((u8 *)p < &mem_b[0] || (u8 *)p >= &mem_b[RAM_SIZE])
-			return false;
-		bm_RamWriteAccess((u32)((u8 *)p - &mem_b[0]));
-	}
-
-	return true;
 }
 
 bool print_stats = true;
@@ -736,3 +706,79 @@ void print_blocks()
 }
 #endif
 
+#if FEAT_SHREC == DYNAREC_NONE
+void bm_Reset()
+{
+	bm_UnlockAllRamPages();
+	memset(unprotected_pages, 0, sizeof(unprotected_pages));
+	sh4int_ResetDecodeCache();
+}
+#endif
+
+bool bm_ProtectRamPage(u32 addr)
+{
+	// Same rules as RuntimeBlockInfo::SetProtectedFlags
+	if (!IsOnRam(addr) || (addr & 0x1FFF0000) == 0x0c000000)
+		return false;
+	addr &= RAM_MASK;
+	if (unprotected_pages[addr / PAGE_SIZE])
+		return false;
+	// The page may have been unlocked by bm_Reset while still holding blocks
+	bm_LockPage(addr);
+	return true;
+}
+
+void bm_RamWriteAccess(u32 addr)
+{
+	addr &= RAM_MASK;
+	if (unprotected_pages[addr / PAGE_SIZE])
+	{
+		ERROR_LOG(DYNAREC, "Page %08x already unprotected", addr);
+		die("Fatal error");
+	}
+	unprotected_pages[addr / PAGE_SIZE] = true;
+	bm_UnlockPage(addr);
+#if FEAT_SHREC != DYNAREC_NONE
+	std::set<RuntimeBlockInfo*>& block_list = blocks_per_page[addr / PAGE_SIZE];
+	std::vector<RuntimeBlockInfo*> list_copy;
+	list_copy.insert(list_copy.begin(), block_list.begin(), block_list.end());
+	if (!list_copy.empty())
+		DEBUG_LOG(DYNAREC, "bm_RamWriteAccess write access to %08x pc %08x", addr, next_pc);
+	for (auto& block : list_copy)
+	{
+		rdv_ForgetHotBlock(block->addr);
+		bm_DiscardBlock(block);
+	}
+	verify(block_list.empty());
+#endif
+	sh4int_InvalidateDecodedPage(addr);
+}
+
+bool bm_RamWriteAccess(void *p)
+{
+	if (_nvmem_enabled())
+	{
+		if (_nvmem_4gb_space())
+		{
+			if ((u8 *)p < virt_ram_base || (u8 *)p >= virt_ram_base + 0x100000000L)
+				return false;
+		}
+		else
+		{
+			if ((u8 *)p < virt_ram_base || (u8 *)p >= virt_ram_base + 0x20000000)
+				return false;
+		}
+		u32 addr = (u8*)p - virt_ram_base;
+		if (!IsOnRam(addr) || ((addr >> 29) > 0 && (addr >> 29) < 4))	// system RAM is not mapped to 20, 40 and 60 because of laziness
+			return false;
+		bm_RamWriteAccess(addr);
+	}
+	else
+	{
+		if ((u8 *)p < &mem_b[0] || (u8 *)p >= &mem_b[RAM_SIZE])
+			return false;
+		bm_RamWriteAccess((u32)((u8 *)p - &mem_b[0]));
+	}
+
+	return true;
+}
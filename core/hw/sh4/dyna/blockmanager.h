@@ -17,6 +17,12 @@ struct RuntimeBlockInfo_Core
 	u32 lookups;
 };
 
+struct BlockCheckRange
+{
+	u32 addr;
+	u32 size;	//in bytes
+};
+
 struct RuntimeBlockInfo: RuntimeBlockInfo_Core
 {
 	bool Setup(u32 pc,fpscr_t fpu_cfg);
@@ -25,7 +31,10 @@ struct RuntimeBlockInfo: RuntimeBlockInfo_Core
 	u32 vaddr;
 
 	u32 host_code_size;	//in bytes
-	u32 sh4_code_size; //in bytes
+	u32 sh4_code_size; //in bytes, superblocks include the code they branch over
+	// code and data that invalidate the block when written, sorted and disjoint.
+	// Superblocks have one range per decoded part: the code and literal pools they branch over aren't included.
+	std::vector<BlockCheckRange> sh4_check_ranges;
 
 	u32 runs;
 	s32 staging_runs;
@@ -37,6 +46,10 @@ struct RuntimeBlockInfo: RuntimeBlockInfo_Core
 	bool has_fpu_op;
 	u32 blockcheck_failures;
 	bool temp_block;
+	bool superblock = false;	// follows unconditional branches, see rdv_SampleHotBlock
+	u32 hot_samples;
+	bool idle_loop = false;		// polling loop that can be fast-forwarded, see SSAOptimizer::IdleLoopPass
+	bool sr_t_dead_out = false;	// all successors overwrite sr.T before reading it
 
 	u32 BranchBlock; //if not 0xFFFFFFFF then jump target
 	u32 NextBlock;   //if not 0xFFFFFFFF then next block (by position)
@@ -95,6 +108,9 @@ void bm_Term();
 void bm_vmem_pagefill(void** ptr,u32 size_bytes);
 bool bm_RamWriteAccess(void *p);
 void bm_RamWriteAccess(u32 addr);
+// Write-protects the RAM page containing addr if possible, so that bm_RamWriteAccess is called on the next write.
+// Returns false if the page isn't protected (not in RAM or already written to).
+bool bm_ProtectRamPage(u32 addr);
 static inline bool bm_IsRamPageProtected(u32 addr)
 {
 	extern bool unprotected_pages[RAM_SIZE_MAX/PAGE_SIZE];
@@ -923,6 +923,8 @@ static void state_Setup(u32 rpc,fpscr_t fpu_cfg)
 	state.info.has_readm=false;
 	state.info.has_writem=false;
 	state.info.has_fpu=false;
+	state.info.data_end=rpc;
+	state.info.prev_op_pc=NullAddress;
 }
 
 void dec_updateBlockCycles(RuntimeBlockInfo *block, u16 op)
@@ -938,12 +940,210 @@ void dec_updateBlockCycles(RuntimeBlockInfo *block, u16 op)
 	}
 }
 
+// lds Rn,FPSCR right after mov.l @(disp,PC),Rn: the new FPU mode is known at decode time
+// so the block can go on with it instead of ending after the lds.
+// The literal is added to the checked range so that changing it invalidates the block.
+static bool dec_SpeculateFpscr(u32 op)
+{
+	if ((op & 0xF0FF) != 0x406A || mmu_enabled() || config::DynarecSafeMode)
+		return false;
+	u32 prev_pc = state.info.prev_op_pc;
+	if (prev_pc == NullAddress)
+		return false;
+	u32 prev_op = IReadMem16(prev_pc);
+	if ((prev_op & 0xF000) != 0xD000 || GetN(prev_op) != GetN(op))
+		return false;
+	u32 literal = (prev_pc & ~3) + 4 + GetImm8(prev_op) * 4;
+	const u32 *ptr = (const u32 *)GetMemPtr(literal, 4);
+	if (ptr == nullptr)
+		return false;
+
+	fpscr_t new_fpscr;
+	new_fpscr.full = *ptr;
+	state.cpu.FPR64 = new_fpscr.PR;
+	state.cpu.FSZ64 = new_fpscr.SZ;
+	state.cpu.RoundToZero = new_fpscr.RM == 1;
+	state.info.data_end = std::max(state.info.data_end, literal + 4);
+
+	return true;
+}
+
+enum TBitUsage { TBitNone, TBitRead, TBitWrite };
+
+// How an instruction uses the T bit. Branches and anything saving SR count as reads.
+static TBitUsage dec_TBitUsage(u16 op)
+{
+	switch (op)
+	{
+	case 0x0008:	// clrt
+	case 0x0018:	// sett
+	case 0x0019:	// div0u
+		return TBitWrite;
+	case 0x000B:	// rts
+	case 0x001B:	// sleep
+	case 0x002B:	// rte
+		return TBitRead;
+	}
+	switch (op & 0xF000)
+	{
+	case 0xA000:	// bra
+	case 0xB000:	// bsr
+		return TBitRead;
+	}
+	switch (op & 0xFF00)
+	{
+	case 0x8800:	// cmp/eq #imm,R0
+	case 0xC800:	// tst #imm,R0
+	case 0xCC00:	// tst.b #imm,@(R0,GBR)
+		return TBitWrite;
+	case 0x8900:	// bt
+	case 0x8B00:	// bf
+	case 0x8D00:	// bt/s
+	case 0x8F00:	// bf/s
+	case 0xC300:	// trapa
+		return TBitRead;
+	}
+	switch (op & 0xF00F)
+	{
+	case 0x2007:	// div0s
+	case 0x2008:	// tst
+	case 0x200C:	// cmp/str
+	case 0x3000:	// cmp/eq
+	case 0x3002:	// cmp/hs
+	case 0x3003:	// cmp/ge
+	case 0x3006:	// cmp/hi
+	case 0x3007:	// cmp/gt
+	case 0x300B:	// subv
+	case 0x300F:	// addv
+	case 0xF004:	// fcmp/eq
+	case 0xF005:	// fcmp/gt
+		return TBitWrite;
+	case 0x3004:	// div1
+	case 0x300A:	// subc
+	case 0x300E:	// addc
+	case 0x600A:	// negc
+		return TBitRead;
+	}
+	switch (op & 0xF0FF)
+	{
+	case 0x4000:	// shll
+	case 0x4001:	// shlr
+	case 0x4004:	// rotl
+	case 0x4005:	// rotr
+	case 0x4010:	// dt
+	case 0x4011:	// cmp/pz
+	case 0x4015:	// cmp/pl
+	case 0x401B:	// tas.b
+	case 0x4020:	// shal
+	case 0x4021:	// shar
+		return TBitWrite;
+	case 0x0002:	// stc sr,Rn
+	case 0x0003:	// bsrf
+	case 0x0023:	// braf
+	case 0x0029:	// movt
+	case 0x4003:	// stc.l sr,@-Rn
+	case 0x4007:	// ldc.l @Rm+,sr
+	case 0x400B:	// jsr
+	case 0x400E:	// ldc Rm,sr
+	case 0x4024:	// rotcl
+	case 0x4025:	// rotcr
+	case 0x402B:	// jmp
+		return TBitRead;
+	}
+	return TBitNone;
+}
+
+// Adds the virtual address range [start, end) to the memory that invalidates the block when written.
+// The ranges are kept sorted, and merged when they overlap or touch.
+static void dec_AddCheckRange(u32 start, u32 end)
+{
+	// without mmu, addr == vaddr. With mmu the block doesn't cross its page
+	start += blk->addr - blk->vaddr;
+	end += blk->addr - blk->vaddr;
+	std::vector<BlockCheckRange>& ranges = blk->sh4_check_ranges;
+	auto it = ranges.begin();
+	while (it != ranges.end() && it->addr + it->size < start)
+		++it;
+	while (it != ranges.end() && it->addr <= end)
+	{
+		start = std::min(start, it->addr);
+		end = std::max(end, it->addr + it->size);
+		it = ranges.erase(it);
+	}
+	ranges.insert(it, BlockCheckRange{ start, end - start });
+}
+
+// Returns true if the code at addr overwrites T before reading it.
+// At most lookahead instructions are looked at, scan_end is set to the end of the code that has been looked at.
+// Only code in the first page of the block or right after the block is considered, so that the checked range stays small.
+static bool dec_IsTBitDeadAt(u32 addr, u32 lookahead, u32& scan_end)
+{
+	if (addr == NullAddress || addr < (blk->vaddr & ~0xFFF) || addr >= blk->vaddr + blk->sh4_code_size + lookahead * 2)
+		return false;
+	for (u32 limit = addr + lookahead * 2; addr < limit; addr += 2)
+	{
+		const u16 *ptr = (const u16 *)GetMemPtr(addr, 2);
+		if (ptr == nullptr)
+			return false;
+		scan_end = addr + 2;
+		switch (dec_TBitUsage(*ptr))
+		{
+		case TBitWrite:
+			return true;
+		case TBitRead:
+			return false;
+		default:
+			break;
+		}
+	}
+	return false;
+}
+
+// If all the successors of the block overwrite T before reading it, the last T value computed by the block
+// is dead (see SSAOptimizer::DeadCodeRemovalPass).
+// The successor code that has been looked at is added to the checked ranges so that changing it invalidates the block.
+static void dec_AnalyseTBitLiveOut()
+{
+	const u32 lookahead = 16;	// instructions
+
+	if (mmu_enabled() || config::DynarecSafeMode)
+		return;
+	u32 branch_end;
+	u32 next_end;
+	switch (blk->BlockType)
+	{
+	case BET_StaticJump:
+	case BET_StaticCall:
+		if (!dec_IsTBitDeadAt(blk->BranchBlock, lookahead, branch_end))
+			return;
+		dec_AddCheckRange(blk->BranchBlock, branch_end);
+		break;
+
+	case BET_Cond_0:
+	case BET_Cond_1:
+		// the block end reads T unless it has been saved by jcond
+		if (!blk->has_jcond
+				|| !dec_IsTBitDeadAt(blk->BranchBlock, lookahead, branch_end)
+				|| !dec_IsTBitDeadAt(blk->NextBlock, lookahead, next_end))
+			return;
+		dec_AddCheckRange(blk->BranchBlock, branch_end);
+		dec_AddCheckRange(blk->NextBlock, next_end);
+		break;
+
+	default:
+		return;
+	}
+	blk->sr_t_dead_out = true;
+}
+
 bool dec_DecodeBlock(RuntimeBlockInfo* rbi,u32 max_cycles)
 {
 	blk=rbi;
 	state_Setup(blk->vaddr, blk->fpu_cfg);
 	
 	blk->guest_opcodes=0;
+	// start of the code decoded since the last followed branch (superblocks)
+	u32 part_start = blk->vaddr;
 	// If full MMU, don't allow the block to extend past the end of the current 4K page
 	u32 max_pc = mmu_enabled() ? ((state.cpu.rpc >> 12) + 1) << 12 : 0xFFFFFFFF;
 	
@@ -966,6 +1166,8 @@ bool dec_DecodeBlock(RuntimeBlockInfo* rbi,u32 max_cycles)
 				{
 					u32 op = IReadMem16(state.cpu.rpc);
 
+					if (state.cpu.is_delayslot)
+						state.info.prev_op_pc = NullAddress;
 					blk->guest_opcodes++;
 					dec_updateBlockCycles(blk, op);
 
@@ -993,7 +1195,7 @@ bool dec_DecodeBlock(RuntimeBlockInfo* rbi,u32 max_cycles)
 								dec_DynamicSet(reg_nextpc);
 								dec_End(NullAddress, BET_DynamicJump, false);
 							}
-							else if (OpDesc[op]->SetFPSCR() && !state.cpu.is_delayslot)
+							else if (OpDesc[op]->SetFPSCR() && !state.cpu.is_delayslot && !dec_SpeculateFpscr(op))
 							{
 								dec_End(state.cpu.rpc + 2, BET_StaticJump, false);
 							}
@@ -1003,12 +1205,34 @@ bool dec_DecodeBlock(RuntimeBlockInfo* rbi,u32 max_cycles)
 					{
 						OpDesc[op]->rec_oph(op);
 					}
+					state.info.prev_op_pc = state.cpu.rpc;
 					state.cpu.rpc+=2;
 				}
 			}
 			break;
 
 		case NDO_End:
+			// Superblocks: keep decoding at the target of a forward bra/bsr in the same page
+			// so that the whole trace is optimized and register-allocated as a single block.
+			// Each decoded part gets its own checked range: the code and literals branched over can change
+			// without invalidating the block.
+			if (blk->superblock && state.cpu.is_delayslot
+					&& (state.BlockType == BET_StaticJump || state.BlockType == BET_StaticCall)
+					&& state.JumpAddr >= state.cpu.rpc
+					&& (state.JumpAddr >> 12) == (blk->vaddr >> 12)
+					&& blk->oplist.size() < BLOCK_MAX_SH_OPS_SOFT && blk->guest_cycles < max_cycles)
+			{
+				dec_AddCheckRange(part_start, std::max(state.cpu.rpc, state.info.data_end));
+				part_start = state.JumpAddr;
+				state.info.data_end = state.JumpAddr;
+				state.cpu.rpc = state.JumpAddr;
+				state.cpu.is_delayslot = false;
+				state.info.prev_op_pc = NullAddress;
+				state.NextOp = NDO_NextOp;
+				state.BlockType = BET_SCL_Intr;
+				state.JumpAddr = NullAddress;
+				continue;
+			}
 			// Disabled for now since we need to know if the block is read-only,
 			// which isn't determined until after the decoding.
 			// This is a relatively rare optimization anyway
@@ -1041,9 +1265,11 @@ bool dec_DecodeBlock(RuntimeBlockInfo* rbi,u32 max_cycles)
 
 _end:
 	blk->sh4_code_size=state.cpu.rpc-blk->vaddr;
+	dec_AddCheckRange(part_start, std::max(state.cpu.rpc, state.info.data_end));
 	blk->NextBlock=state.NextAddr;
 	blk->BranchBlock=state.JumpAddr;
 	blk->BlockType=state.BlockType;
+	dec_AnalyseTBitLiveOut();
 
 	verify(blk->oplist.size() <= BLOCK_MAX_SH_OPS_HARD);
 	
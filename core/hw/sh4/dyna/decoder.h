@@ -63,6 +63,8 @@ struct state_t
 		bool has_readm;
 		bool has_writem;
 		bool has_fpu;
+		u32 data_end;		// end of the literals the decoding depends on
+		u32 prev_op_pc;		// previous instruction in the same straight-line sequence
 	} info;
 };
 
@@ -6,6 +6,7 @@
 #include "hw/sh4/sh4_interrupts.h"
 
 #include "hw/sh4/sh4_mem.h"
+#include "hw/sh4/sh4_sched.h"
 #include "hw/sh4/modules/mmu.h"
 #include "cfg/option.h"
 
@@ -43,6 +44,13 @@ static u32 *emit_ptr;
 static u32 *emit_ptr_limit;
 
 static std::unordered_set<u32> smc_hotspots;
+// Blocks to recompile as superblocks
+static std::unordered_set<u32> hot_blocks;
+// Number of time slices ending on a block before it's recompiled
+#define HOT_BLOCK_SAMPLES 32
+// Polling loops fast-forwarded by rdv_SkipIdleLoop
+static u32 idleSkipLoops;
+static u64 idleSkipCycles;
 
 static sh4_if sh4Interp;
 
@@ -61,6 +69,7 @@ static void recSh4_ClearCache()
 	LastAddr = 0;
 	bm_ResetCache();
 	smc_hotspots.clear();
+	hot_blocks.clear();
 	clear_temp_cache(true);
 }
 
@@ -128,6 +137,7 @@ bool RuntimeBlockInfo::Setup(u32 rpc,fpscr_t rfpu_cfg)
 	staging_runs=addr=lookups=runs=host_code_size=0;
 	guest_cycles=guest_opcodes=host_opcodes=0;
 	sh4_code_size = 0;
+	sh4_check_ranges.clear();
 	pBranchBlock=pNextBlock=0;
 	code=0;
 	has_jcond=false;
@@ -136,6 +146,7 @@ bool RuntimeBlockInfo::Setup(u32 rpc,fpscr_t rfpu_cfg)
 	BlockType = BET_SCL_Intr;
 	has_fpu_op = false;
 	temp_block = false;
+	hot_samples = 0;
 	
 	vaddr = rpc;
 	if (mmu_enabled())
@@ -164,6 +175,11 @@ bool RuntimeBlockInfo::Setup(u32 rpc,fpscr_t rfpu_cfg)
 	SetProtectedFlags();
 
 	AnalyseBlock(this);
+	if (idle_loop)
+		// Burn the timeslice in two iterations. The scheduler is fast-forwarded at the end of it,
+		// see rdv_SkipIdleLoop. SH4_TIMESLICE / 2 is the largest cost the decoder gives a block
+		// so the cycle counter doesn't go further below zero than with any other block.
+		guest_cycles = SH4_TIMESLICE / 2;
 
 	return true;
 }
@@ -176,6 +192,7 @@ DynarecCodeEntryPtr rdv_CompilePC(u32 blockcheck_failures)
 		recSh4_ClearCache();
 
 	RuntimeBlockInfo* rbi = ngen_AllocateBlock();
+	rbi->superblock = !hot_blocks.empty() && hot_blocks.count(pc) != 0;
 
 	if (!rbi->Setup(pc,fpscr))
 	{
@@ -272,6 +289,69 @@ DynarecCodeEntryPtr DYNACALL rdv_BlockCheckFail(u32 addr)
 	return (DynarecCodeEntryPtr)CC_RW2RX(rdv_CompilePC(blockcheck_failures));
 }
 
+// Called at the end of each time slice with the address of the next block to run.
+// The blocks that are sampled most often are recompiled as superblocks that follow
+// forward unconditional branches, so that the SSA passes and register allocation
+// work on the whole trace.
+void rdv_SampleHotBlock(u32 pc)
+{
+	if (!config::DynarecSuperblocks || mmu_enabled())
+		return;
+	RuntimeBlockInfoPtr block = bm_GetBlock(pc);
+	if (block == nullptr || block->temp_block || block->superblock
+			|| block->hot_samples >= HOT_BLOCK_SAMPLES || ++block->hot_samples < HOT_BLOCK_SAMPLES)
+		return;
+	// Only blocks ending with a bra or bsr to a forward address in the same page can be extended
+	if ((block->BlockType != BET_StaticJump && block->BlockType != BET_StaticCall)
+			|| block->BranchBlock < block->addr + block->sh4_code_size
+			|| (block->BranchBlock >> 12) != (block->addr >> 12))
+		return;
+	DEBUG_LOG(DYNAREC, "Hot block %08x: recompiling as superblock", block->addr);
+	hot_blocks.insert(block->addr);
+	// The discarded block will be recompiled the next time it's looked up
+	bm_DiscardBlock(block.get());
+}
+
+void rdv_ForgetHotBlock(u32 addr)
+{
+	hot_blocks.erase(addr);
+}
+
+void rdv_SkipIdleLoop(u32 pc)
+{
+	if (!config::DynarecIdleSkip || mmu_enabled())
+		return;
+	RuntimeBlockInfoPtr block = bm_GetBlock(pc);
+	if (block == nullptr || !block->idle_loop)
+		return;
+	u32 skipped = sh4_sched_skip();
+	if (skipped > 0)
+	{
+		idleSkipLoops++;
+		idleSkipCycles += skipped;
+	}
+}
+
+static void reportIdleSkip()
+{
+	if (idleSkipLoops > 0)
+		INFO_LOG(DYNAREC, "Idle loops: scheduler fast-forwarded %u times, %.1f M cycles skipped",
+				idleSkipLoops, idleSkipCycles / 1e6);
+	idleSkipLoops = 0;
+	idleSkipCycles = 0;
+}
+
+// Not called from UpdateSystem_INTC() since the sleep opcode calls it in a loop from
+// the middle of a block: sleeping would be counted as hot code, and the current block
+// could be discarded
+int rdv_UpdateSystem()
+{
+	rdv_SampleHotBlock(next_pc);
+	rdv_SkipIdleLoop(next_pc);
+
+	return UpdateSystem_INTC();
+}
+
 DynarecCodeEntryPtr rdv_FindOrCompile()
 {
 	DynarecCodeEntryPtr rv = bm_GetCodeByVAddr(next_pc);  // Returns exec addr
@@ -370,6 +450,7 @@ static void recSh4_Step()
 
 static void recSh4_Reset(bool hard)
 {
+	reportIdleSkip();
 	sh4Interp.Reset(hard);
 	recSh4_ClearCache();
 	if (hard)
@@ -417,6 +498,7 @@ static void recSh4_Init()
 static void recSh4_Term()
 {
 	INFO_LOG(DYNAREC, "recSh4 Term");
+	reportIdleSkip();
 	bm_Term();
 	sh4Interp.Term();
 }
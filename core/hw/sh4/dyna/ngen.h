@@ -76,6 +76,18 @@ DynarecCodeEntryPtr DYNACALL rdv_BlockCheckFail(u32 addr);
 DynarecCodeEntryPtr rdv_CompilePC(u32 blockcheck_failures);
 //Finds or compiles code @pc
 DynarecCodeEntryPtr rdv_FindOrCompile();
+//Called by the main loop at the end of each time slice. Returns UpdateSystem_INTC()
+int rdv_UpdateSystem();
+//Called at the end of each time slice to find hot blocks
+void rdv_SampleHotBlock(u32 pc);
+//Called when the code of a block is overwritten: it has to be sampled again to be recompiled as a superblock
+void rdv_ForgetHotBlock(u32 addr);
+//Called at the end of each time slice to fast-forward the scheduler if pc is a polling loop.
+void rdv_SkipIdleLoop(u32 pc);
+//rdv_SampleHotBlock and rdv_SkipIdleLoop are only called by the x64 and C++ backends, through rdv_UpdateSystem:
+//they end time slices in their main loop where the next pc is known.
+//The x86, ARM and ARM64 backends call UpdateSystem from the block prologue and return into the running block,
+//so they have no superblocks and their polling loops only burn the timeslice.
 
 //code -> pointer to code of block, dpc -> if dynamic block, pc. if cond, 0 for next, 1 for branch
 void* DYNACALL rdv_LinkBlock(u8* code,u32 dpc);
@@ -27,6 +27,8 @@
 #include "decoder.h"
 #include "hw/sh4/modules/mmu.h"
 #include "hw/sh4/sh4_mem.h"
+#include "hw/sh4/sh4_mmr.h"
+#include "cfg/option.h"
 
 class SSAOptimizer
 {
@@ -51,6 +53,8 @@ public:
 		DeadRegisterPass();
 		IdentityMovePass();
 		SingleBranchTargetPass();
+		if (config::DynarecIdleSkip && !mmu_enabled())
+			IdleLoopPass();
 
 #if DEBUG
 		if (stats.prop_constants > 0 || stats.dead_code_ops > 0 || stats.constant_ops_replaced > 0
@@ -329,6 +333,9 @@ private:
 		std::set<RegValue> uses;
 
 		memset(last_versions, -1, sizeof(last_versions));
+		if (block->sr_t_dead_out)
+			// T is overwritten by the successors before being read
+			last_versions[reg_sr_T] = (u32)-2;
 		for (int opnum = block->oplist.size() - 1; opnum >= 0; opnum--)
 		{
 			shil_opcode& op = block->oplist[opnum];
@@ -760,6 +767,93 @@ private:
 		}
 	}
 
+	// Device registers that only change when a scheduler event fires or when the sh4 writes them.
+	// Anything else may change at any time: the TMU counters and the RTC are computed from the current
+	// time when read, the aica registers and memory are updated by the aica thread, and
+	// the naomi boards have their own devices.
+	static bool IsScheduledReg(u32 addr)
+	{
+		addr &= 0x1FFFFFFF;
+		if (addr >= 0x005F6800 && addr < 0x005F7000)		// holly system block: interrupt status, ch2 dma, maple
+			return true;
+		if ((addr == 0x005F7018 || addr == 0x005F709C)		// gd-rom alternate status and status
+				&& settings.platform.system == DC_PLATFORM_DREAMCAST)
+			return true;
+		if (addr >= 0x005F7400 && addr < 0x005F7D00)		// g1, g2 and pvr dma
+			return true;
+		if (addr >= 0x005F8000 && addr < 0x005FA000)		// pvr registers, including SPG_STATUS
+			return true;
+		return (addr >= INTC_ICR_addr && addr <= INTC_IPRD_addr)
+				|| addr == TMU_TCR0_addr || addr == TMU_TCR1_addr || addr == TMU_TCR2_addr;	// underflow flags
+	}
+
+	// A block that jumps to itself, only reads scheduled device registers at constant
+	// addresses and whose register results don't depend on the previous iteration
+	// is a polling loop that can only be exited when a scheduler event fires.
+	bool IsPollingLoop()
+	{
+		if (block->BranchBlock != block->vaddr
+				|| (block->BlockType != BET_Cond_0 && block->BlockType != BET_Cond_1 && block->BlockType != BET_StaticJump))
+			return false;
+		bool reg_written[sh4_reg_count] {};
+		for (const shil_opcode& op : block->oplist)
+		{
+			switch (op.op)
+			{
+			case shop_readm:
+				if (!op.rs1.is_imm() || !op.rs3.is_null() || !IsScheduledReg(op.rs1.imm_value()))
+					return false;
+				break;
+			case shop_mov32:
+			case shop_and:
+			case shop_or:
+			case shop_xor:
+			case shop_not:
+			case shop_add:
+			case shop_sub:
+			case shop_neg:
+			case shop_shl:
+			case shop_shr:
+			case shop_sar:
+			case shop_ext_s8:
+			case shop_ext_s16:
+			case shop_swaplb:
+			case shop_test:
+			case shop_seteq:
+			case shop_setge:
+			case shop_setgt:
+			case shop_setae:
+			case shop_setab:
+			case shop_jcond:
+				break;
+			default:
+				return false;
+			}
+			if (op.rd.is_reg())
+				reg_written[op.rd._reg] = true;
+			if (op.rd2.is_reg())
+				reg_written[op.rd2._reg] = true;
+		}
+		// Values that are read before being written in the block must not be modified by it
+		for (const shil_opcode& op : block->oplist)
+		{
+			const shil_param *params[] = { &op.rs1, &op.rs2, &op.rs3 };
+			for (const shil_param *param : params)
+				if (param->is_r32() && param->version[0] == 0 && reg_written[param->_reg])
+					return false;
+		}
+		return true;
+	}
+
+	void IdleLoopPass()
+	{
+		if (IsPollingLoop())
+		{
+			block->idle_loop = true;
+			DEBUG_LOG(DYNAREC, "%08x: polling loop detected", block->vaddr);
+		}
+	}
+
 	RuntimeBlockInfo* block;
 	std::set<RegValue> writeback_values;
 
@@ -13,6 +13,12 @@
 #include "hw/holly/sb.h"
 #include "../sh4_cache.h"
 #include "debug/gdb_server.h"
+#include "hw/sh4/modules/mmu.h"
+#include "hw/sh4/dyna/blockmanager.h"
+
+#include <algorithm>
+#include <memory>
+#include <vector>
 
 #define CPU_RATIO      (8)
 
@@ -37,6 +43,131 @@ static u16 ReadNexOp()
 	return IReadMem16(addr);
 }
 
+// The decode cache relies on the block manager page protection to detect code modifications,
+// which is also available without the dynarec.
+// Instruction fetches must go through the icache emulation in strict mode.
+#ifndef STRICT_MODE
+#define USE_DECODE_CACHE
+#endif
+
+#ifdef USE_DECODE_CACHE
+//
+// Pre-decoded instructions of a 4 KB page of system RAM. Each entry holds the index of the
+// handler to call for the corresponding opcode so that the fetch through the memory handlers
+// and the FPU-disable check are skipped. Pages are write-protected while cached and are
+// invalidated by bm_RamWriteAccess. Pages that are written to aren't cached anymore, like
+// dynarec blocks.
+//
+struct DecodedPage
+{
+	bool valid;
+	const u16 *code;
+	u16 handlers[PAGE_SIZE / 2];
+};
+static std::unique_ptr<DecodedPage> decodedPages[RAM_SIZE_MAX / PAGE_SIZE];
+static DecodedPage *lastPage;
+static u32 lastPageAddr = ~0u;
+// Distinct opcode handlers, small enough to stay in the data cache, and the index of each opcode's handler
+static std::vector<OpCallFP *> decodedHandlers;
+static std::unique_ptr<u16[]> opcodeHandlerIndex;
+
+static void DYNACALL FpuOpHandler(u32 op)
+{
+	if (sr.FD == 1)
+		RaiseFPUDisableException();
+	OpPtr[op](op);
+}
+
+static void buildHandlerTable()
+{
+	decodedHandlers.clear();
+	opcodeHandlerIndex.reset(new u16[0x10000]);
+	for (u32 op = 0; op < 0x10000; op++)
+	{
+		OpCallFP *handler = OpDesc[op]->IsFloatingPoint() ? FpuOpHandler : OpPtr[op];
+		auto it = std::find(decodedHandlers.begin(), decodedHandlers.end(), handler);
+		opcodeHandlerIndex[op] = (u16)(it - decodedHandlers.begin());
+		if (it == decodedHandlers.end())
+			decodedHandlers.push_back(handler);
+	}
+	DEBUG_LOG(INTERPRETER, "Decode cache: %d distinct opcode handlers", (int)decodedHandlers.size());
+}
+
+static DecodedPage *decodePage(u32 pc)
+{
+	// Same conditions as IsOnRam but excluding P4
+	if (mmu_enabled() || (pc >> 29) == 7 || ((pc >> 26) & 7) != 3)
+		return nullptr;
+	u32 index = (pc & RAM_MASK) / PAGE_SIZE;
+	std::unique_ptr<DecodedPage>& page = decodedPages[index];
+	if (page == nullptr || !page->valid)
+	{
+		// Protect first so that any later write invalidates the page
+		if (!bm_ProtectRamPage(pc))
+			return nullptr;
+		if (page == nullptr)
+			page.reset(new DecodedPage());
+		page->code = (const u16 *)&mem_b[index * PAGE_SIZE];
+		for (u32 i = 0; i < PAGE_SIZE / 2; i++)
+			page->handlers[i] = opcodeHandlerIndex[page->code[i]];
+		page->valid = true;
+	}
+	lastPage = page.get();
+	lastPageAddr = pc & ~PAGE_MASK;
+
+	return lastPage;
+}
+
+void sh4int_InvalidateDecodedPage(u32 addr)
+{
+	// Called from the fault handler: only flag the page
+	DecodedPage *page = decodedPages[(addr & RAM_MASK) / PAGE_SIZE].get();
+	if (page != nullptr)
+		page->valid = false;
+	lastPageAddr = ~0u;
+}
+
+void sh4int_ResetDecodeCache()
+{
+	for (auto& page : decodedPages)
+		if (page != nullptr)
+			page->valid = false;
+	lastPageAddr = ~0u;
+}
+
+static void RunDecoded()
+{
+	OpCallFP * const *handlers = decodedHandlers.data();
+	do
+	{
+		u32 pc = next_pc;
+		DecodedPage *page = (pc & ~PAGE_MASK) == lastPageAddr ? lastPage : decodePage(pc);
+		if (page == nullptr)
+		{
+			ExecuteOpcode(ReadNexOp());
+			continue;
+		}
+		// Run sequentially until the page is left or invalidated
+		do
+		{
+			u32 idx = (pc & PAGE_MASK) / 2;
+			next_pc = pc + 2;
+			handlers[page->handlers[idx]](page->code[idx]);
+			l -= CPU_RATIO;
+			pc = next_pc;
+		} while (l > 0 && (pc & ~PAGE_MASK) == lastPageAddr);
+	} while (l > 0);
+}
+
+#else
+
+void sh4int_InvalidateDecodedPage(u32 addr) {
+}
+
+void sh4int_ResetDecodeCache() {
+}
+#endif
+
 static void Sh4_int_Run()
 {
 	sh4_int_bCpuRun = true;
@@ -48,12 +179,16 @@ static void Sh4_int_Run()
 		do
 		{
 			try {
+#ifdef USE_DECODE_CACHE
+				RunDecoded();
+#else
 				do
 				{
 					u32 op = ReadNexOp();
 
 					ExecuteOpcode(op);
 				} while (l > 0);
+#endif
 				l += SH4_TIMESLICE;
 				UpdateSystem_INTC();
 			} catch (const SH4ThrownException& ex) {
@@ -110,6 +245,12 @@ static void Sh4_int_Reset(bool hard)
 	UpdateFPSCR();
 	icache.Reset(hard);
 	ocache.Reset(hard);
+#if FEAT_SHREC == DYNAREC_NONE
+	// No block manager to reset the RAM page protection
+	bm_Reset();
+#else
+	sh4int_ResetDecodeCache();
+#endif
 
 	INFO_LOG(INTERPRETER, "Sh4 Reset");
 }
@@ -163,6 +304,7 @@ int UpdateSystem_INTC()
 }
 
 static void sh4_int_resetcache() {
+	sh4int_ResetDecodeCache();
 }
 
 static void Sh4_int_Init()
@@ -170,6 +312,9 @@ static void Sh4_int_Init()
 	static_assert(sizeof(Sh4cntx) == 448, "Invalid Sh4Cntx size");
 
 	memset(&p_sh4rcb->cntx, 0, sizeof(p_sh4rcb->cntx));
+#ifdef USE_DECODE_CACHE
+	buildHandlerTable();
+#endif
 }
 
 static void Sh4_int_Term()
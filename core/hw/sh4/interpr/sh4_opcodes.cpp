@@ -1124,6 +1124,7 @@ sh4op(i0000_0000_0000_1001)
 //ldtlb
 sh4op(i0000_0000_0011_1000)
 {
+	UTLB_Invalidate(CCN_MMUCR.URC);
 	UTLB[CCN_MMUCR.URC].Data = CCN_PTEL;
 	UTLB[CCN_MMUCR.URC].Address = CCN_PTEH;
 	UTLB[CCN_MMUCR.URC].Assistance = CCN_PTEA;
@@ -50,7 +50,7 @@ void CCN_PTEH_write(u32 addr, u32 value)
 	CCN_PTEH_type temp;
 	temp.reg_data = value;
 	if (temp.ASID != CCN_PTEH.ASID)
-		mmuAddressLUTFlush(false);
+		mmuAddressLUTSwitchAsid(CCN_PTEH.ASID, temp.ASID);
 
 	CCN_PTEH = temp;
 }
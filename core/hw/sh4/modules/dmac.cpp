@@ -13,6 +13,26 @@
 #include "hw/sh4/sh4_interrupts.h"
 #include "hw/holly/holly_intc.h"
 
+// Ch2 transfer to the 32-bit texture path. The source is copied in bulk when
+// it is in system RAM, word by word otherwise
+static void ch2WriteTex32(u32 dst, u32 src, u32 len)
+{
+	const u32 *sys_buf = (const u32 *)GetMemPtr(src, len);
+	if (sys_buf != nullptr)
+	{
+		pvr_write32_block(dst, sys_buf, len);
+		return;
+	}
+	while (len > 0)
+	{
+		u32 v = ReadMem32_nommu(src);
+		pvr_write32p<u32>(dst, v);
+		len -= 4;
+		src += 4;
+		dst += 4;
+	}
+}
+
 void DMAC_Ch2St()
 {
 	u32 dmaor = DMAC_DMAOR.full;
@@ -75,14 +95,17 @@ void DMAC_Ch2St()
 		{
 			// 32-bit path
 			dst = (dst & 0xFFFFFF) | 0xa5000000;
-			while (len > 0)
+			if ((src & RAM_MASK) + len > RAM_SIZE)
 			{
-				u32 v = ReadMem32_nommu(src);
-				pvr_write32p<u32>(dst, v);
-				len -= 4;
-				src += 4;
-				dst += 4;
+				u32 newLen = RAM_SIZE - (src & RAM_MASK);
+				ch2WriteTex32(dst, src, newLen);
+				len -= newLen;
+				src += newLen;
+				dst += newLen;
 			}
+			ch2WriteTex32(dst, src, len);
+			src += len;
+			dst += len;
 		}
 		SB_C2DSTAT = dst;
 	}
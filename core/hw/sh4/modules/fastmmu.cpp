@@ -22,6 +22,8 @@
 #include "hw/sh4/sh4_core.h"
 #include "types.h"
 
+#include <memory>
+
 #ifdef FAST_MMU
 
 #include "hw/mem/_vmem.h"
@@ -51,6 +53,14 @@ static u32 full_table_size;
 static TLB_LinkedEntry *entry_buckets[NBUCKETS];
 u32 mmuAddressLUT[0x100000];
 
+constexpr u32 SlotPages = (32 * 1024 * 1024) >> 12;
+// Saved slot 0 of the LUT for each ASID
+static std::unique_ptr<u32[]> asidSlotLUT[256];
+static bool asidSlotLUTValid[256];
+
+MmuITlbCacheEntry mmuITlbCache[1 << MMU_ITLB_CACHE_BITS];
+u32 mmuITlbGeneration = 1;
+
 static u16 bucket_index(u32 address, int size, u32 asid)
 {
 	return ((address >> 20) ^ (address >> 12) ^ (address | asid | (size << 8))) & (NBUCKETS - 1);
@@ -179,6 +189,32 @@ int main(int argc, char *argv[])
 }
 #endif
 
+// Drops the translations of a UTLB entry's virtual pages from the LUT and from the saved
+// per-ASID LUTs. Done for the old entry before it's modified and for the new one, whose
+// pages may still be mapped to an older entry.
+static void mmuAddressLUTInvalidate(const TLB_Entry& entry)
+{
+	u32 vaddr = entry.Address.VPN << 10;
+	if (vaddr >> 31)
+		// Kernel memory is identity-mapped in the LUT
+		return;
+	if (entry.Data.SH == 1)
+		memset(asidSlotLUTValid, 0, sizeof(asidSlotLUTValid));
+	else
+		asidSlotLUTValid[entry.Address.ASID] = false;
+	if (entry.Data.SH == 1 || entry.Address.ASID == CCN_PTEH.ASID)
+	{
+		u32 size = ~mmu_mask[entry.Data.SZ1 * 2 + entry.Data.SZ0] + 1;
+		for (u32 va = vaddr & ~0xfff; va < vaddr + size; va += 0x1000)
+			mmuAddressLUT[va >> 12] = 0;
+	}
+}
+
+void UTLB_Invalidate(u32 entry)
+{
+	mmuAddressLUTInvalidate(UTLB[entry]);
+}
+
 bool UTLB_Sync(u32 entry)
 {
 	TLB_Entry& tlb_entry = UTLB[entry];
@@ -192,6 +228,8 @@ bool UTLB_Sync(u32 entry)
 	lru_address = tlb_entry.Address.VPN << 10;
 
 	cache_entry(tlb_entry);
+	mmuITlbCacheFlush();
+	mmuAddressLUTInvalidate(tlb_entry);
 
 	if (!mmu_enabled() && (tlb_entry.Address.VPN & (0xFC000000 >> 10)) == (0xE0000000 >> 10))
 	{
@@ -204,6 +242,37 @@ bool UTLB_Sync(u32 entry)
 
 void ITLB_Sync(u32 entry)
 {
+	mmuITlbCacheFlush();
+}
+
+void mmuITlbCacheFlush()
+{
+	if (++mmuITlbGeneration == 0)
+	{
+		// Make sure stale entries can't match after wrapping around
+		memset(mmuITlbCache, 0, sizeof(mmuITlbCache));
+		mmuITlbGeneration = 1;
+	}
+}
+
+void mmuAddressLUTFlush()
+{
+	memset(mmuAddressLUT, 0, sizeof(mmuAddressLUT) / 2);
+	memset(asidSlotLUTValid, 0, sizeof(asidSlotLUTValid));
+}
+
+void mmuAddressLUTSwitchAsid(u32 oldAsid, u32 newAsid)
+{
+	std::unique_ptr<u32[]>& saved = asidSlotLUT[oldAsid];
+	if (saved == nullptr)
+		saved.reset(new u32[SlotPages]);
+	memcpy(saved.get(), mmuAddressLUT, SlotPages * sizeof(u32));
+	asidSlotLUTValid[oldAsid] = true;
+
+	if (asidSlotLUTValid[newAsid])
+		memcpy(mmuAddressLUT, asidSlotLUT[newAsid].get(), SlotPages * sizeof(u32));
+	else
+		memset(mmuAddressLUT, 0, SlotPages * sizeof(u32));
 }
 
 //Do a full lookup on the UTLB entry's
@@ -331,6 +400,7 @@ void mmu_flush_table()
 {
 	lru_entry = nullptr;
 	flush_cache();
-	mmuAddressLUTFlush(true);
+	mmuAddressLUTFlush();
+	mmuITlbCacheFlush();
 }
 #endif 	// FAST_MMU
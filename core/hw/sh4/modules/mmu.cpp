@@ -76,6 +76,9 @@ bool UTLB_Sync(u32 entry)
 		return false;
 	}
 }
+void UTLB_Invalidate(u32 entry)
+{
+}
 //sync mem mapping to mmu , suspend compiled blocks if needed.entry is a ITLB entry # , -1 is for full sync
 void ITLB_Sync(u32 entry)
 {
@@ -559,7 +562,7 @@ void mmu_flush_table()
 
 	for (u32 i = 0; i < 64; i++)
 		UTLB[i].Data.V = 0;
-	mmuAddressLUTFlush(true);
+	mmuAddressLUTFlush();
 }
 #endif
 
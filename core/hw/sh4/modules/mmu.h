@@ -59,6 +59,8 @@ constexpr u32 mmu_mask[4] =
 
 bool UTLB_Sync(u32 entry);
 void ITLB_Sync(u32 entry);
+// Must be called before a UTLB entry is modified
+void UTLB_Invalidate(u32 entry);
 
 bool mmu_match(u32 va, CCN_PTEH_type Address, CCN_PTEL_type Data);
 void mmu_set_state();
@@ -124,15 +126,62 @@ bool mmu_TranslateSQW(u32 adr, u32* out);
 // maps 4K virtual page number to physical address
 extern u32 mmuAddressLUT[0x100000];
 
-static inline void mmuAddressLUTFlush(bool full) {
-	if (full)
-		memset(mmuAddressLUT, 0, sizeof(mmuAddressLUT) / 2);	// flush user memory
-	else
-	{
-		constexpr u32 slotPages = (32 * 1024 * 1024) >> 12;
-		memset(mmuAddressLUT, 0, slotPages * sizeof(u32));		// flush slot 0
-	}
+#ifdef FAST_MMU
+// Flushes the user memory part of the LUT
+void mmuAddressLUTFlush();
+// Slot 0 (first 32 MB) depends on the ASID. Its content is saved and restored per ASID.
+void mmuAddressLUTSwitchAsid(u32 oldAsid, u32 newAsid);
+#else
+static inline void mmuAddressLUTFlush() {
+	memset(mmuAddressLUT, 0, sizeof(mmuAddressLUT) / 2);	// flush user memory
+}
+static inline void mmuAddressLUTSwitchAsid(u32 oldAsid, u32 newAsid) {
+	constexpr u32 slotPages = (32 * 1024 * 1024) >> 12;
+	memset(mmuAddressLUT, 0, slotPages * sizeof(u32));		// flush slot 0
 }
+#endif
+
+#ifdef FAST_MMU
+// Direct-mapped cache of instruction translations, tagged by virtual page and ASID,
+// so that block lookups don't need a full translation after a context switch.
+// Flushed by UTLB_Sync, ITLB_Sync and mmu_flush_table.
+#define MMU_ITLB_CACHE_BITS 10
+
+struct MmuITlbCacheEntry
+{
+	u32 vpage;
+	u32 asid;
+	u32 generation;
+	u32 ppage;
+};
+extern MmuITlbCacheEntry mmuITlbCache[1 << MMU_ITLB_CACHE_BITS];
+extern u32 mmuITlbGeneration;
+
+void mmuITlbCacheFlush();
+
+static inline MmuITlbCacheEntry& mmuITlbCacheEntry(u32 va)
+{
+	return mmuITlbCache[(va >> 12) & ((1 << MMU_ITLB_CACHE_BITS) - 1)];
+}
+
+static inline bool mmuITlbCacheLookup(u32 va, u32& rv)
+{
+	const MmuITlbCacheEntry& entry = mmuITlbCacheEntry(va);
+	if (entry.vpage != (va & ~0xfff) || entry.asid != CCN_PTEH.ASID || entry.generation != mmuITlbGeneration)
+		return false;
+	rv = entry.ppage | (va & 0xfff);
+	return true;
+}
+
+static inline void mmuITlbCacheAdd(u32 va, u32 pa)
+{
+	MmuITlbCacheEntry& entry = mmuITlbCacheEntry(va);
+	entry.vpage = va & ~0xfff;
+	entry.asid = CCN_PTEH.ASID;
+	entry.generation = mmuITlbGeneration;
+	entry.ppage = pa & ~0xfff;
+}
+#endif
 
 static inline u32 mmuDynarecLookup(u32 vaddr, u32 write, u32 pc)
 {
@@ -45,3 +45,7 @@ void ExecuteDelayslot_RTE();
 
 int UpdateSystem();
 int UpdateSystem_INTC();
+
+// Pre-decoded instruction cache of the interpreter
+void sh4int_InvalidateDecodedPage(u32 addr);
+void sh4int_ResetDecodeCache();
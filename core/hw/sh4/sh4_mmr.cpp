@@ -323,6 +323,7 @@ void DYNACALL WriteMem_P4(u32 addr,T data)
 				{
 					if (mmu_match(va,UTLB[i].Address,UTLB[i].Data))
 					{
+						UTLB_Invalidate(i);
 						UTLB[i].Data.V=((u32)data>>8)&1;
 						UTLB[i].Data.D=((u32)data>>9)&1;
 						UTLB_Sync(i);
@@ -342,6 +343,7 @@ void DYNACALL WriteMem_P4(u32 addr,T data)
 			else
 			{
 				u32 entry=(addr>>8)&63;
+				UTLB_Invalidate(entry);
 				UTLB[entry].Address.reg_data=data & 0xFFFFFCFF;
 				UTLB[entry].Data.D=(data>>9)&1;
 				UTLB[entry].Data.V=(data>>8)&1;
@@ -354,6 +356,7 @@ void DYNACALL WriteMem_P4(u32 addr,T data)
 	case 0xF7:
 		{
 			u32 entry=(addr>>8)&63;
+			UTLB_Invalidate(entry);
 			if (addr&0x800000)
 			{
 				UTLB[entry].Assistance.reg_data = data & 0xf;
@@ -2,6 +2,7 @@
 #include "sh4_interrupts.h"
 #include "sh4_core.h"
 #include "sh4_sched.h"
+#include "sh4_interpreter.h"
 
 //sh4 scheduler
 
@@ -63,15 +64,44 @@ void sh4_sched_ffts()
 	sh4_sched_ffb+=Sh4cntx.sh4_sched_next;
 }
 
+u32 sh4_sched_skip()
+{
+	if (Sh4cntx.sh4_sched_next < SH4_TIMESLICE)
+		return 0;
+	// Only skip whole timeslices
+	u32 skipped = Sh4cntx.sh4_sched_next / SH4_TIMESLICE * SH4_TIMESLICE;
+	Sh4cntx.sh4_sched_next -= skipped;
+
+	return skipped;
+}
+
 int sh4_sched_register(int tag, sh4_sched_callback* ssc)
 {
 	sched_list t={ssc,tag,-1,-1};
 
+	for (size_t i = 0; i < sch_list.size(); i++)
+		if (sch_list[i].cb == nullptr)
+		{
+			sch_list[i] = t;
+			return i;
+		}
 	sch_list.push_back(t);
 
 	return sch_list.size()-1;
 }
 
+void sh4_sched_unregister(int id)
+{
+	if (id == (int)sch_list.size() - 1)
+		sch_list.pop_back();
+	else
+	{
+		sch_list[id].cb = nullptr;
+		sch_list[id].end = -1;
+	}
+	sh4_sched_ffts();
+}
+
 /*
 	Return current cycle count, in 32 bits (wraps after 21 dreamcast seconds)
 */
@@ -16,6 +16,12 @@ typedef int sh4_sched_callback(int tag, int sch_cycl, int jitter);
 */
 int sh4_sched_register(int tag, sh4_sched_callback* ssc);
 
+/*
+	Unregister a callback. Its id can be reused by a later
+	call to sh4_sched_register
+*/
+void sh4_sched_unregister(int id);
+
 /*
 	current time in SH4 cycles, referenced to boot.
 	Wraps every ~21 secs
@@ -43,6 +49,11 @@ void sh4_sched_request(size_t id, int cycles);
 void sh4_sched_tick(int cycles);
 
 void sh4_sched_ffts();
+/*
+	Fast-forwards the scheduler so that the next event fires at the end of the current timeslice.
+	Returns the number of cycles skipped
+*/
+u32 sh4_sched_skip();
 
 struct sched_list
 {
@@ -3,6 +3,11 @@
 
 //Get a copy of the operators for structs ... ugly , but works :)
 #include "common.h"
+#include "readahead.h"
+#include <mutex>
+
+// Serializes disc accesses from the emu and read-ahead threads
+static std::mutex readMutex;
 
 void GetSessionInfo(u8* out,u8 ses);
 
@@ -16,6 +21,7 @@ void libGDR_ReadSubChannel(u8 * buff, u32 format, u32 len)
 
 void libGDR_ReadSector(u8 * buff,u32 StartSector,u32 SectorCount,u32 secsz)
 {
+	std::lock_guard<std::mutex> lock(readMutex);
 	GetDriveSector(buff,StartSector,SectorCount,secsz);
 	//if (CurrDrive)
 	//	CurrDrive->ReadSector(buff,StartSector,SectorCount,secsz);
@@ -88,5 +94,6 @@ s32 libGDR_Init()
 //called when exiting from sh4 thread , from the new thread context (for any thread specific init) :P
 void libGDR_Term()
 {
+	readahead::term();
 	TermDrive();
 }
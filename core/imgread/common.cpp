@@ -1,4 +1,5 @@
 #include "common.h"
+#include "readahead.h"
 
 Disc* chd_parse(const char* file);
 Disc* gdi_parse(const char* file);
@@ -167,6 +168,7 @@ bool DiscSwap()
 
 void TermDrive()
 {
+	readahead::cancel();
 	delete disc;
 	disc = NULL;
 }
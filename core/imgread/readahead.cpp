@@ -0,0 +1,259 @@
+/*
+	Copyright 2021 flyinghead
+
+	This file is part of flycast.
+
+    flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "readahead.h"
+#include "common.h"
+#include "cfg/option.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace readahead
+{
+
+constexpr u32 RingSectors = 256;		// ~600 KB
+constexpr u32 MaxSectorSize = 2352;
+constexpr u32 BatchSectors = 32;		// max sectors read at once by the thread
+constexpr u32 PredictedSectors = 64;	// sectors read past the end of a request
+
+static std::thread thread;
+static std::mutex mutex;
+static std::condition_variable cond;
+static bool running;
+static bool stopping;
+static bool reading;		// the thread is reading from the disc
+static u8 ring[RingSectors * MaxSectorSize];
+
+// Read-ahead window. Sectors in [head, filled) are available in the ring buffer,
+// sectors in [filled, end) are yet to be read.
+// The last sector read (head - 1) is kept since it's often read again by partial transfers.
+static bool active;
+static u32 generation;		// incremented when the window is discarded
+static u32 sectorSize;
+static u32 windowStart;
+static u32 head;
+static u32 filled;
+static u32 end;
+static u32 trackEnd;		// read-ahead doesn't cross track boundaries
+
+static Stats stats;
+
+static u8 *slot(u32 sector)
+{
+	return &ring[(sector % RingSectors) * MaxSectorSize];
+}
+
+static void threadMain()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	for (;;)
+	{
+		cond.wait(lock, []() {
+			return stopping || (active && filled < end && filled - head < RingSectors - 1);
+		});
+		if (stopping)
+			break;
+		u32 sector = filled;
+		// don't wrap around the end of the ring buffer
+		u32 count = std::min(end - sector, RingSectors - 1 - (filled - head));
+		count = std::min(count, RingSectors - sector % RingSectors);
+		count = std::min(count, BatchSectors);
+		u32 size = sectorSize;
+		u32 gen = generation;
+		reading = true;
+		lock.unlock();
+
+		// these slots are free and can't be read until filled is updated
+		libGDR_ReadSector(slot(sector), sector, count, size);
+		// sectors are read one after the other in the ring buffer
+		if (size != MaxSectorSize)
+			for (u32 i = count; i-- > 1; )
+				memmove(slot(sector + i), slot(sector) + i * size, size);
+
+		lock.lock();
+		reading = false;
+		if (gen == generation)
+		{
+			filled += count;
+			stats.prefetched += count;
+		}
+		cond.notify_all();
+	}
+}
+
+static void startThread()
+{
+	if (running)
+		return;
+	stopping = false;
+	thread = std::thread(threadMain);
+	running = true;
+}
+
+// mutex must be locked
+static void discard()
+{
+	active = false;
+	generation++;
+}
+
+static u32 getTrackEnd(u32 sector)
+{
+	u32 elapsed;
+	u32 track = libGDR_GetTrackNumber(sector, elapsed);
+	u32 startFad, endFad;
+	if (track == 0xAA || !libGDR_GetTrack(track, startFad, endFad))
+		return sector;
+	return endFad + 1;
+}
+
+// mutex must be locked
+static void startLocked(u32 sector, u32 count, u32 size)
+{
+	if (active && size == sectorSize && sector == head)
+	{
+		// already reading ahead from there
+		end = std::max(end, std::min(sector + count + PredictedSectors, trackEnd));
+		cond.notify_all();
+		return;
+	}
+	discard();
+	if (size > MaxSectorSize)
+		return;
+	trackEnd = getTrackEnd(sector);
+	if (sector >= trackEnd)
+		return;
+	sectorSize = size;
+	windowStart = sector;
+	head = sector;
+	filled = sector;
+	end = std::min(sector + count + PredictedSectors, trackEnd);
+	active = true;
+	cond.notify_all();
+}
+
+void start(u32 sector, u32 count, u32 size)
+{
+	if (!config::GDRomReadAhead)
+		return;
+	startThread();
+	std::lock_guard<std::mutex> lock(mutex);
+	startLocked(sector, count, size);
+}
+
+void read(u8 *buff, u32 sector, u32 count, u32 size)
+{
+	if (!config::GDRomReadAhead)
+	{
+		libGDR_ReadSector(buff, sector, count, size);
+		return;
+	}
+	startThread();
+	std::unique_lock<std::mutex> lock(mutex);
+	if (active && size == sectorSize && sector + 1 == head && head > windowStart)
+	{
+		// the last sector is read again
+		memcpy(buff, slot(sector), size);
+		stats.hits++;
+		if (--count == 0)
+			return;
+		sector++;
+		buff += size;
+	}
+	if (!active || size != sectorSize || sector != head)
+	{
+		// not a sequential read
+		discard();
+		stats.misses += count;
+		lock.unlock();
+		libGDR_ReadSector(buff, sector, count, size);
+		lock.lock();
+		// predict that the next read will follow this one
+		startLocked(sector + count, 0, size);
+		return;
+	}
+	end = std::max(end, std::min(sector + count, trackEnd));
+	for (; count > 0; count--, sector++, buff += size)
+	{
+		if (sector >= end)
+		{
+			// past the end of the track
+			lock.unlock();
+			libGDR_ReadSector(buff, sector, count, size);
+			lock.lock();
+			stats.misses += count;
+			startLocked(sector + count, 0, size);
+			return;
+		}
+		if (sector >= filled)
+		{
+			stats.stalls++;
+			auto startTime = std::chrono::steady_clock::now();
+			cond.wait(lock, [sector]() { return filled > sector; });
+			stats.stallTime += std::chrono::duration_cast<std::chrono::microseconds>(
+					std::chrono::steady_clock::now() - startTime).count();
+		}
+		memcpy(buff, slot(sector), size);
+		head++;
+		stats.hits++;
+	}
+	// keep reading ahead
+	end = std::max(end, std::min(head + PredictedSectors, trackEnd));
+	cond.notify_all();
+}
+
+void cancel()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	discard();
+	cond.wait(lock, []() { return !reading; });
+}
+
+void term()
+{
+	if (!running)
+		return;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		discard();
+		stopping = true;
+	}
+	cond.notify_all();
+	thread.join();
+	running = false;
+	INFO_LOG(GDROM, "GD-ROM read-ahead: %" PRIu64 " hits, %" PRIu64 " misses, %" PRIu64 " stalls (%" PRIu64 " us), %" PRIu64 " sectors prefetched",
+			stats.hits, stats.misses, stats.stalls, stats.stallTime, stats.prefetched);
+}
+
+Stats getStats()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return stats;
+}
+
+void resetStats()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	stats = {};
+}
+
+}
@@ -0,0 +1,51 @@
+/*
+	Copyright 2021 flyinghead
+
+	This file is part of flycast.
+
+    flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include "types.h"
+
+//
+// Asynchronous GD-ROM sector read-ahead.
+// A background thread reads the sectors of the current read command, and the ones
+// following it in the same track, into a ring buffer. Sequential reads are served
+// from this buffer; any other read goes directly to the disc image.
+//
+namespace readahead
+{
+
+struct Stats
+{
+	u64 hits;			// sectors served from the ring buffer
+	u64 misses;			// sectors read synchronously
+	u64 stalls;			// number of times a read had to wait for the read-ahead thread
+	u64 stallTime;		// total wait time in microseconds
+	u64 prefetched;		// sectors read by the read-ahead thread
+};
+
+// Starts reading ahead count sectors (plus some predicted ones) from sector
+void start(u32 sector, u32 count, u32 sectorSize);
+// Reads sectors, from the ring buffer when possible. Prefetches the next sectors.
+void read(u8 *buff, u32 sector, u32 count, u32 sectorSize);
+// Discards the ring buffer content and waits until the disc isn't being accessed
+void cancel();
+void term();
+
+Stats getStats();
+void resetStats();
+
+}
@@ -57,6 +57,26 @@ bool mem_region_unlock(void *start, size_t len)
 	return true;
 }
 
+bool mem_region_set_noaccess(void *start, size_t len)
+{
+	size_t inpage = (uintptr_t)start & PAGE_MASK;
+	len += inpage;
+	size_t inlen = len & PAGE_MASK;
+	if (inlen)
+		len = (len + PAGE_SIZE) & ~(PAGE_SIZE-1);
+
+	Result rc;
+	uintptr_t start_addr = (uintptr_t)start - inpage;
+	for (uintptr_t addr = start_addr; addr < (start_addr + len); addr += PAGE_SIZE)
+	{
+		rc = svcSetMemoryPermission((void*)addr, PAGE_SIZE, Perm_None);
+		if (R_FAILED(rc))
+			WARN_LOG(VMEM, "Failed to SetPerm Perm_None on %p len 0x%x rc 0x%x", (void*)addr, PAGE_SIZE, rc);
+	}
+
+	return true;
+}
+
 /*
 static bool mem_region_set_exec(void *start, size_t len)
 {
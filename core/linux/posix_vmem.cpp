@@ -70,6 +70,14 @@ bool mem_region_unlock(void *start, size_t len)
 	return true;
 }
 
+bool mem_region_set_noaccess(void *start, size_t len)
+{
+	size_t inpage = (uintptr_t)start & PAGE_MASK;
+	if (mprotect((u8*)start - inpage, len + inpage, PROT_NONE))
+		die("mprotect failed...");
+	return true;
+}
+
 bool mem_region_set_exec(void *start, size_t len)
 {
 	size_t inpage = (uintptr_t)start & PAGE_MASK;
@@ -169,7 +177,7 @@ VMemType vmem_platform_init(void **vmem_base_addr, void **sh4rcb_addr) {
 	// Now try to allocate a contiguous piece of memory.
 	VMemType rv;
 #if HOST_CPU == CPU_X64 || HOST_CPU == CPU_ARM64
-	reserved_size = 0x100000000L + sizeof(Sh4RCB) + 0x10000;	// 4GB + context size + 64K padding
+	reserved_size = 0x100000000L + sizeof(Sh4RCB) + ARAM_SIZE_MAX + 0x10000;	// 4GB + context size + aica ram + 64K padding
 	reserved_base = mem_region_reserve(NULL, reserved_size);
 	rv = MemType4GB;
 #endif
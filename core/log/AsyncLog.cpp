@@ -0,0 +1,578 @@
+/*
+	Copyright 2021 flyinghead
+
+	This file is part of flycast.
+
+    flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "AsyncLog.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+constexpr u32 RingSize = 512;			// records per thread
+constexpr size_t MaxFreeRings = 4;
+constexpr u32 MaxArgs = 12;
+constexpr size_t PayloadSize = 512;		// format string and string arguments
+constexpr size_t MaxSpecLen = 32;
+constexpr size_t MaxMsgLen = 1024;
+
+enum ArgKind : u8
+{
+	ARG_INVALID,
+	ARG_INT,
+	ARG_LONG,
+	ARG_LONGLONG,
+	ARG_SIZE,
+	ARG_PTRDIFF,
+	ARG_INTMAX,
+	ARG_DOUBLE,
+	ARG_POINTER,
+	ARG_STRING,
+};
+
+struct LogArg
+{
+	ArgKind kind;
+	union {
+		s64 i;
+		double d;
+		const void *p;
+		size_t offset;		// string arguments are copied in the payload
+	};
+};
+
+struct LogRecord
+{
+	u64 seq;
+	double time;
+	const char *file;
+	int line;
+	LogTypes::LOG_LEVELS level;
+	LogTypes::LOG_TYPE type;
+	u32 argCount;
+	bool formatted;		// the payload contains the formatted message
+	LogArg args[MaxArgs];
+	char payload[PayloadSize];
+};
+
+// Single producer, single consumer
+struct AsyncLog::Ring
+{
+	std::atomic<u32> head;		// next record to read
+	std::atomic<u32> tail;		// next record to write
+	std::atomic<bool> retired;	// the producer thread won't post anymore
+	LogRecord records[RingSize];
+
+	Ring() : head(0), tail(0), retired(false) {}
+};
+
+// Retires the ring buffer of a thread when it exits or logs to another instance.
+// The ring is shared with the AsyncLog so that either can go away first.
+struct AsyncLog::RingOwner
+{
+	std::shared_ptr<Ring> ring;
+	u32 id = 0;		// owner AsyncLog
+
+	void release()
+	{
+		if (ring != nullptr)
+			ring->retired.store(true, std::memory_order_release);
+		ring.reset();
+		id = 0;
+	}
+	~RingOwner() {
+		release();
+	}
+};
+
+thread_local AsyncLog::RingOwner AsyncLog::t_ring;
+static std::atomic<u32> lastId;
+
+constexpr int PrecisionNone = -1;
+constexpr int PrecisionStar = -2;
+
+// Parses a conversion specification following a '%'.
+// Returns a pointer past its end and the kind of argument it expects, the number of '*'
+// and the precision (PrecisionNone, PrecisionStar or its value).
+static const char *parseSpec(const char *p, ArgKind& kind, int& stars, int& precision)
+{
+	kind = ARG_INVALID;
+	stars = 0;
+	precision = PrecisionNone;
+	while (*p != 0 && strchr("-+ #0'", *p) != nullptr)
+		p++;
+	if (*p == '*')
+	{
+		stars++;
+		p++;
+	}
+	while (*p >= '0' && *p <= '9')
+		p++;
+	if (*p == '.')
+	{
+		p++;
+		if (*p == '*')
+		{
+			stars++;
+			precision = PrecisionStar;
+			p++;
+		}
+		else
+		{
+			precision = 0;
+			while (*p >= '0' && *p <= '9')
+				precision = precision * 10 + *p++ - '0';
+		}
+	}
+	ArgKind intKind = ARG_INT;
+	bool longDouble = false;
+	bool wide = false;
+	switch (*p)
+	{
+	case 'h':
+		p++;
+		if (*p == 'h')
+			p++;
+		break;
+	case 'l':
+		p++;
+		if (*p == 'l')
+		{
+			intKind = ARG_LONGLONG;
+			p++;
+		}
+		else
+		{
+			intKind = ARG_LONG;
+			wide = true;
+		}
+		break;
+	case 'q':
+	case 'j':
+		intKind = *p == 'q' ? ARG_LONGLONG : ARG_INTMAX;
+		p++;
+		break;
+	case 'z':
+		intKind = ARG_SIZE;
+		p++;
+		break;
+	case 't':
+		intKind = ARG_PTRDIFF;
+		p++;
+		break;
+	case 'L':
+		longDouble = true;
+		p++;
+		break;
+	case 'I':
+		// msvcrt
+		p++;
+		if (p[0] == '6' && p[1] == '4')
+		{
+			intKind = ARG_LONGLONG;
+			p += 2;
+		}
+		else if (p[0] == '3' && p[1] == '2')
+			p += 2;
+		else
+			intKind = ARG_SIZE;
+		break;
+	default:
+		break;
+	}
+	switch (*p)
+	{
+	case 'd':
+	case 'i':
+	case 'u':
+	case 'o':
+	case 'x':
+	case 'X':
+		kind = intKind;
+		break;
+	case 'c':
+		if (!wide)
+			kind = ARG_INT;
+		break;
+	case 'f':
+	case 'F':
+	case 'e':
+	case 'E':
+	case 'g':
+	case 'G':
+	case 'a':
+	case 'A':
+		if (!longDouble)
+			kind = ARG_DOUBLE;
+		break;
+	case 'p':
+		kind = ARG_POINTER;
+		break;
+	case 's':
+		if (!wide)
+			kind = ARG_STRING;
+		break;
+	default:
+		// %n, wide chars, long doubles and unknown conversions
+		return p;
+	}
+	return p + 1;
+}
+
+// Copies the format string and the arguments into the record.
+// Returns false if they don't fit or aren't supported.
+static bool captureArgs(LogRecord& rec, const char *format, va_list args)
+{
+	size_t used = strlen(format) + 1;
+	if (used > PayloadSize)
+		return false;
+	memcpy(rec.payload, format, used);
+	rec.argCount = 0;
+
+	for (const char *p = format; *p != 0; )
+	{
+		if (*p++ != '%')
+			continue;
+		if (*p == '%')
+		{
+			p++;
+			continue;
+		}
+		const char *specStart = p - 1;
+		ArgKind kind;
+		int stars;
+		int precision;
+		p = parseSpec(p, kind, stars, precision);
+		if (kind == ARG_INVALID || (size_t)(p - specStart) >= MaxSpecLen
+				|| rec.argCount + stars + 1 > MaxArgs)
+			return false;
+		for (int i = 0; i < stars; i++)
+		{
+			LogArg& arg = rec.args[rec.argCount++];
+			arg.kind = ARG_INT;
+			arg.i = va_arg(args, int);
+		}
+		// The precision argument is the last '*'. A negative value is ignored.
+		if (precision == PrecisionStar)
+			precision = std::max<int>(rec.args[rec.argCount - 1].i, PrecisionNone);
+		LogArg& arg = rec.args[rec.argCount++];
+		arg.kind = kind;
+		switch (kind)
+		{
+		case ARG_INT:
+			arg.i = va_arg(args, int);
+			break;
+		case ARG_LONG:
+			arg.i = va_arg(args, long);
+			break;
+		case ARG_LONGLONG:
+			arg.i = va_arg(args, long long);
+			break;
+		case ARG_SIZE:
+			arg.i = (s64)va_arg(args, size_t);
+			break;
+		case ARG_PTRDIFF:
+			arg.i = va_arg(args, ptrdiff_t);
+			break;
+		case ARG_INTMAX:
+			arg.i = (s64)va_arg(args, intmax_t);
+			break;
+		case ARG_DOUBLE:
+			arg.d = va_arg(args, double);
+			break;
+		case ARG_POINTER:
+			arg.p = va_arg(args, void *);
+			break;
+		case ARG_STRING:
+			{
+				const char *s = va_arg(args, const char *);
+				if (s == nullptr)
+					s = "(null)";
+				// The string doesn't need to be null-terminated if a precision is given
+				size_t len = precision == PrecisionNone ? strlen(s) : strnlen(s, precision);
+				if (used + len + 1 > PayloadSize)
+					return false;
+				memcpy(&rec.payload[used], s, len);
+				rec.payload[used + len] = 0;
+				arg.offset = used;
+				used += len + 1;
+			}
+			break;
+		default:
+			return false;
+		}
+	}
+	return true;
+}
+
+template<typename T>
+static int formatArg(char *out, size_t size, const char *spec, int stars, const LogArg *starArgs, T value)
+{
+	switch (stars)
+	{
+	case 0:
+		return snprintf(out, size, spec, value);
+	case 1:
+		return snprintf(out, size, spec, (int)starArgs[0].i, value);
+	default:
+		return snprintf(out, size, spec, (int)starArgs[0].i, (int)starArgs[1].i, value);
+	}
+}
+
+// Formats the message of a record captured by captureArgs
+static void formatRecord(const LogRecord& rec, char *out, size_t size)
+{
+	size_t pos = 0;
+	u32 argIdx = 0;
+	for (const char *p = rec.payload; *p != 0 && pos < size - 1; )
+	{
+		if (*p != '%')
+		{
+			out[pos++] = *p++;
+			continue;
+		}
+		if (p[1] == '%')
+		{
+			out[pos++] = '%';
+			p += 2;
+			continue;
+		}
+		const char *specStart = p;
+		ArgKind kind;
+		int stars;
+		int precision;
+		p = parseSpec(p + 1, kind, stars, precision);
+		char spec[MaxSpecLen];
+		memcpy(spec, specStart, p - specStart);
+		spec[p - specStart] = 0;
+		const LogArg *starArgs = &rec.args[argIdx];
+		const LogArg& arg = rec.args[argIdx + stars];
+		argIdx += stars + 1;
+
+		int len;
+		switch (kind)
+		{
+		case ARG_INT:
+			len = formatArg(&out[pos], size - pos, spec, stars, starArgs, (int)arg.i);
+			break;
+		case ARG_LONG:
+			len = formatArg(&out[pos], size - pos, spec, stars, starArgs, (long)arg.i);
+			break;
+		case ARG_LONGLONG:
+			len = formatArg(&out[pos], size - pos, spec, stars, starArgs, (long long)arg.i);
+			break;
+		case ARG_SIZE:
+			len = formatArg(&out[pos], size - pos, spec, stars, starArgs, (size_t)arg.i);
+			break;
+		case ARG_PTRDIFF:
+			len = formatArg(&out[pos], size - pos, spec, stars, starArgs, (ptrdiff_t)arg.i);
+			break;
+		case ARG_INTMAX:
+			len = formatArg(&out[pos], size - pos, spec, stars, starArgs, (intmax_t)arg.i);
+			break;
+		case ARG_DOUBLE:
+			len = formatArg(&out[pos], size - pos, spec, stars, starArgs, arg.d);
+			break;
+		case ARG_POINTER:
+			len = formatArg(&out[pos], size - pos, spec, stars, starArgs, arg.p);
+			break;
+		case ARG_STRING:
+			len = formatArg(&out[pos], size - pos, spec, stars, starArgs, &rec.payload[arg.offset]);
+			break;
+		default:
+			len = 0;
+			break;
+		}
+		if (len > 0)
+			pos = std::min(pos + len, size - 1);
+	}
+	out[pos] = 0;
+}
+
+AsyncLog::AsyncLog(const Writer& writer, const std::function<void()>& flush)
+	: m_writer(writer), m_flush(flush), m_id(++lastId), m_wakeup(false), m_seq(0)
+{
+	m_thread = std::thread(&AsyncLog::ThreadMain, this);
+}
+
+AsyncLog::~AsyncLog()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stopping = true;
+	}
+	m_cond.notify_one();
+	m_thread.join();
+}
+
+AsyncLog::Ring *AsyncLog::GetRing()
+{
+	RingOwner& owner = t_ring;
+	if (owner.id != m_id)
+	{
+		owner.release();
+		std::lock_guard<std::mutex> lock(m_rings_mutex);
+		if (!m_free_rings.empty())
+		{
+			owner.ring = m_free_rings.back();
+			m_free_rings.pop_back();
+			owner.ring->retired = false;
+		}
+		else
+		{
+			owner.ring = std::make_shared<Ring>();
+		}
+		m_rings.push_back(owner.ring);
+		owner.id = m_id;
+	}
+	return owner.ring.get();
+}
+
+bool AsyncLog::Post(LogTypes::LOG_LEVELS level, LogTypes::LOG_TYPE type, const char* file, int line,
+		double time, const char* format, va_list args)
+{
+	Ring *ring = GetRing();
+	u32 tail = ring->tail.load(std::memory_order_relaxed);
+	u32 queued = tail - ring->head.load(std::memory_order_acquire);
+	if (queued == RingSize)
+		return false;
+
+	LogRecord& rec = ring->records[tail % RingSize];
+	rec.seq = m_seq.fetch_add(1, std::memory_order_relaxed);
+	rec.time = time;
+	rec.file = file;
+	rec.line = line;
+	rec.level = level;
+	rec.type = type;
+	va_list argsCopy;
+	va_copy(argsCopy, args);
+	rec.formatted = !captureArgs(rec, format, argsCopy);
+	va_end(argsCopy);
+	if (rec.formatted)
+		vsnprintf(rec.payload, PayloadSize, format, args);
+	ring->tail.store(tail + 1, std::memory_order_release);
+
+	// The thread polls the ring buffers periodically. Wake it up early if this one is filling up.
+	if (queued >= RingSize / 2 && !m_wakeup.exchange(true, std::memory_order_relaxed))
+		m_cond.notify_one();
+
+	return true;
+}
+
+void AsyncLog::WriteSync(LogTypes::LOG_LEVELS level, LogTypes::LOG_TYPE type, const char* file, int line,
+		double time, const char* format, va_list args)
+{
+	std::lock_guard<std::mutex> lock(m_drain_mutex);
+	Drain();
+	char text[MaxMsgLen];
+	vsnprintf(text, sizeof(text), format, args);
+	m_writer(level, type, file, line, time, text);
+	m_flush();
+}
+
+// Writes the queued messages of all threads in order.
+// Must be called with m_drain_mutex locked.
+bool AsyncLog::Drain()
+{
+	// Rings with queued messages. Messages queued after this point are written by the next call.
+	struct Pending
+	{
+		Ring *ring;
+		u32 head;
+		u32 tail;
+	};
+	std::vector<Pending> pending;
+	{
+		std::lock_guard<std::mutex> lock(m_rings_mutex);
+		for (auto it = m_rings.begin(); it != m_rings.end(); )
+		{
+			Ring *ring = it->get();
+			// Read before the tail so that the last messages of an exited thread are seen
+			bool retired = ring->retired.load(std::memory_order_acquire);
+			u32 head = ring->head.load(std::memory_order_relaxed);
+			u32 tail = ring->tail.load(std::memory_order_acquire);
+			if (head != tail)
+			{
+				pending.push_back({ ring, head, tail });
+			}
+			else if (retired)
+			{
+				if (m_free_rings.size() < MaxFreeRings)
+					m_free_rings.push_back(*it);
+				it = m_rings.erase(it);
+				continue;
+			}
+			++it;
+		}
+	}
+	char text[MaxMsgLen];
+	bool written = false;
+	while (!pending.empty())
+	{
+		size_t next = 0;
+		for (size_t i = 1; i < pending.size(); i++)
+			if (pending[i].ring->records[pending[i].head % RingSize].seq
+					< pending[next].ring->records[pending[next].head % RingSize].seq)
+				next = i;
+		Pending& p = pending[next];
+		const LogRecord& rec = p.ring->records[p.head % RingSize];
+
+		const char *msg;
+		if (rec.formatted)
+			msg = rec.payload;
+		else
+		{
+			formatRecord(rec, text, sizeof(text));
+			msg = text;
+		}
+		m_writer(rec.level, rec.type, rec.file, rec.line, rec.time, msg);
+		p.ring->head.store(++p.head, std::memory_order_release);
+		written = true;
+		if (p.head == p.tail)
+		{
+			p = pending.back();
+			pending.pop_back();
+		}
+	}
+	return written;
+}
+
+void AsyncLog::ThreadMain()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	for (;;)
+	{
+		m_cond.wait_for(lock, std::chrono::milliseconds(10), [this]() {
+			return m_stopping || m_wakeup.load(std::memory_order_relaxed);
+		});
+		m_wakeup = false;
+		bool stopping = m_stopping;
+		lock.unlock();
+
+		{
+			std::lock_guard<std::mutex> drainLock(m_drain_mutex);
+			if (Drain())
+				m_flush();
+		}
+
+		lock.lock();
+		if (stopping)
+			break;
+	}
+}
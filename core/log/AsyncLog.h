@@ -0,0 +1,83 @@
+/*
+	Copyright 2021 flyinghead
+
+	This file is part of flycast.
+
+    flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdarg>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Log.h"
+#include "types.h"
+
+//
+// Asynchronous log writer.
+// Each logging thread owns a lock-free ring buffer of log records. The format string
+// and the raw arguments are copied into the record, and a background thread formats
+// the messages in order and hands them to the writer function.
+// The ring buffer of a thread is recycled once the thread has exited and its messages are written.
+//
+class AsyncLog
+{
+public:
+	using Writer = std::function<void(LogTypes::LOG_LEVELS level, LogTypes::LOG_TYPE type,
+			const char* file, int line, double time, const char* text)>;
+
+	// flush is called after writing a batch of messages
+	AsyncLog(const Writer& writer, const std::function<void()>& flush);
+	~AsyncLog();
+
+	// Queues a message. Returns false if the ring buffer of the calling thread is full.
+	bool Post(LogTypes::LOG_LEVELS level, LogTypes::LOG_TYPE type, const char* file, int line,
+			double time, const char* format, va_list args);
+	// Writes all the queued messages then this one from the calling thread.
+	void WriteSync(LogTypes::LOG_LEVELS level, LogTypes::LOG_TYPE type, const char* file, int line,
+			double time, const char* format, va_list args);
+
+private:
+	struct Ring;
+	struct RingOwner;
+
+	Ring *GetRing();
+	void ThreadMain();
+	bool Drain();
+
+	Writer m_writer;
+	std::function<void()> m_flush;
+	const u32 m_id;
+	std::thread m_thread;
+	std::mutex m_mutex;
+	std::condition_variable m_cond;
+	bool m_stopping = false;
+	std::atomic<bool> m_wakeup;
+	std::atomic<u64> m_seq;
+
+	// only one thread at a time can read the ring buffers
+	std::mutex m_drain_mutex;
+	std::mutex m_rings_mutex;
+	std::vector<std::shared_ptr<Ring>> m_rings;
+	std::vector<std::shared_ptr<Ring>> m_free_rings;
+
+	// ring buffer of the current thread
+	static thread_local RingOwner t_ring;
+};
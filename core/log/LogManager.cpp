@@ -3,9 +3,12 @@
 // Refer to the license.txt file included.
 
 #include "LogManager.h"
+#include "AsyncLog.h"
 
 #include <algorithm>
+#include <cinttypes>
 #include <cstdarg>
+#include <cstdio>
 #include <cstring>
 #include <locale>
 #include <mutex>
@@ -35,19 +38,28 @@ void OpenFStream(T& fstream, const std::string& filename, std::ios_base::openmod
 class FileLogListener : public LogListener
 {
 public:
-	FileLogListener(const std::string& filename)
+	FileLogListener(const std::string& filename, bool buffered)
+		: m_buffered(buffered)
 	{
 		OpenFStream(m_logfile, filename, std::ios::app);
 		SetEnable(true);
 	}
 
-	void Log(LogTypes::LOG_LEVELS, const char* msg) override
+	void Log(LogTypes::LOG_LEVELS level, const char* msg) override
 	{
 		if (!IsEnabled() || !IsValid())
 			return;
 
 		std::lock_guard<std::mutex> lk(m_log_lock);
-		m_logfile << msg << std::flush;
+		m_logfile << msg;
+		if (!m_buffered || level <= LogTypes::LOG_LEVELS::LWARNING)
+			m_logfile << std::flush;
+	}
+
+	void Flush() override
+	{
+		std::lock_guard<std::mutex> lk(m_log_lock);
+		m_logfile << std::flush;
 	}
 
 	bool IsValid() const { return m_logfile.good(); }
@@ -58,6 +70,8 @@ private:
 	std::mutex m_log_lock;
 	std::ofstream m_logfile;
 	bool m_enable;
+	// only flushed by the async log thread after writing a batch of messages
+	bool m_buffered;
 };
 
 void GenericLog(LogTypes::LOG_LEVELS level, LogTypes::LOG_TYPE type, const char* file, int line,
@@ -128,6 +142,7 @@ LogManager::LogManager()
 		verbosity = MAX_LOGLEVEL;
 
 	SetLogLevel(static_cast<LogTypes::LOG_LEVELS>(verbosity));
+	bool async = cfgLoadBool("log", "Async", false);
 	if (cfgLoadBool("log", "LogToFile", false))
 	{
 #ifdef __ANDROID__
@@ -135,14 +150,14 @@ LogManager::LogManager()
 #else
 		std::string logPath = "flycast.log";
 #endif
-		FileLogListener *listener = new FileLogListener(logPath);
+		FileLogListener *listener = new FileLogListener(logPath, async);
 		if (!listener->IsValid())
 		{
 			const char *home = nowide::getenv("HOME");
 			if (home != nullptr)
 			{
 				delete listener;
-				listener = new FileLogListener(home + ("/" + logPath));
+				listener = new FileLogListener(home + ("/" + logPath), async);
 			}
 		}
 		RegisterListener(LogListener::FILE_LISTENER, listener);
@@ -157,26 +172,38 @@ LogManager::LogManager()
 	}
 
 	m_path_cutoff_point = DeterminePathCutOffPoint();
+
+	// Messages above the warning level in excess of this limit are dropped
+	int rateLimit = cfgLoadInt("log", "RateLimit", 0);
+	m_rate_limit = std::max(rateLimit, 0);
+	for (RateCounter& counter : m_rate_counters)
+	{
+		counter.second = 0;
+		counter.count = 0;
+	}
+	m_dropped = 0;
+	m_dropped_unreported = 0;
+
+	if (async)
+		m_async.reset(new AsyncLog([this](LogTypes::LOG_LEVELS level, LogTypes::LOG_TYPE type,
+				const char* file, int line, double time, const char* text) {
+			Write(level, type, file, line, time, text);
+		}, [this]() {
+			FlushListeners();
+		}));
 }
 
 LogManager::~LogManager()
 {
+	// write all pending messages
+	m_async.reset();
+	if (m_dropped > 0)
+		NOTICE_LOG(COMMON, "%" PRIu64 " log messages dropped", m_dropped.load());
 	// The log window listener pointer is owned by the GUI code.
 	delete m_listeners[LogListener::CONSOLE_LISTENER];
 	delete m_listeners[LogListener::FILE_LISTENER];
 }
 
-// Return the current time formatted as Minutes:Seconds:Milliseconds
-// in the form 00:00:000.
-static std::string GetTimeFormatted()
-{
-	double now = os_GetSeconds();
-	u32 minutes = (u32)now / 60;
-	u32 seconds = (u32)now % 60;
-	u32 ms = (now - (u32)now) * 1000;
-	return StringFromFormat("%02d:%02d:%03d", minutes, seconds, ms);
-}
-
 void LogManager::Log(LogTypes::LOG_LEVELS level, LogTypes::LOG_TYPE type, const char* file,
 		int line, const char* format, va_list args)
 {
@@ -189,16 +216,85 @@ void LogManager::LogWithFullPath(LogTypes::LOG_LEVELS level, LogTypes::LOG_TYPE
 	if (!IsEnabled(type, level) || !static_cast<bool>(m_listener_ids))
 		return;
 
+	double time = os_GetSeconds();
+	if (level > LogTypes::LOG_LEVELS::LWARNING && IsRateLimited(type, time))
+	{
+		Dropped();
+		return;
+	}
+	if (m_async)
+	{
+		// Errors and warnings are written synchronously, after the queued messages,
+		// so that they aren't lost if the program dies right after
+		if (level <= LogTypes::LOG_LEVELS::LWARNING)
+			m_async->WriteSync(level, type, file, line, time, format, args);
+		else if (!m_async->Post(level, type, file, line, time, format, args))
+			Dropped();
+		return;
+	}
+
 	char temp[MAX_MSGLEN];
 	CharArrayFromFormatV(temp, MAX_MSGLEN, format, args);
+	Write(level, type, file, line, time, temp);
+}
+
+void LogManager::Write(LogTypes::LOG_LEVELS level, LogTypes::LOG_TYPE type, const char* file,
+		int line, double time, const char* text)
+{
+	// Time formatted as Minutes:Seconds:Milliseconds in the form 00:00:000.
+	u32 minutes = (u32)time / 60;
+	u32 seconds = (u32)time % 60;
+	u32 ms = (time - (u32)time) * 1000;
+	char msg[MAX_MSGLEN + 256];
+
+	u32 dropped = m_dropped_unreported.exchange(0);
+	if (dropped > 0)
+	{
+		snprintf(msg, sizeof(msg), "%02d:%02d:%03d %u log messages dropped\n", minutes, seconds, ms, dropped);
+		for (auto listener_id : m_listener_ids)
+			if (m_listeners[listener_id])
+				m_listeners[listener_id]->Log(LogTypes::LOG_LEVELS::LWARNING, msg);
+	}
 
-	std::string msg =
-			StringFromFormat("%s %s:%u %c[%s]: %s\n", GetTimeFormatted().c_str(), file,
-					line, LogTypes::LOG_LEVEL_TO_CHAR[(int)level], GetShortName(type), temp);
+	snprintf(msg, sizeof(msg), "%02d:%02d:%03d %s:%u %c[%s]: %s\n", minutes, seconds, ms, file,
+			line, LogTypes::LOG_LEVEL_TO_CHAR[(int)level], GetShortName(type), text);
+
+	for (auto listener_id : m_listener_ids)
+		if (m_listeners[listener_id])
+			m_listeners[listener_id]->Log(level, msg);
+}
 
+void LogManager::FlushListeners()
+{
 	for (auto listener_id : m_listener_ids)
 		if (m_listeners[listener_id])
-			m_listeners[listener_id]->Log(level, msg.c_str());
+			m_listeners[listener_id]->Flush();
+}
+
+bool LogManager::IsRateLimited(LogTypes::LOG_TYPE type, double time)
+{
+	if (m_rate_limit == 0)
+		return false;
+	RateCounter& counter = m_rate_counters[type];
+	u32 second = (u32)time;
+	if (counter.second.load(std::memory_order_relaxed) != second)
+	{
+		// Not exact if several threads log at the same time but good enough
+		counter.second.store(second, std::memory_order_relaxed);
+		counter.count.store(0, std::memory_order_relaxed);
+	}
+	return counter.count.fetch_add(1, std::memory_order_relaxed) >= m_rate_limit;
+}
+
+void LogManager::Dropped()
+{
+	m_dropped++;
+	m_dropped_unreported++;
+}
+
+u64 LogManager::GetDroppedCount() const
+{
+	return m_dropped;
 }
 
 LogTypes::LOG_LEVELS LogManager::GetLogLevel() const
@@ -5,10 +5,15 @@
 #pragma once
 
 #include <array>
+#include <atomic>
 #include <cstdarg>
+#include <memory>
 
 #include "BitSet.h"
 #include "Log.h"
+#include "types.h"
+
+class AsyncLog;
 
 // pure virtual interface
 class LogListener
@@ -16,6 +21,7 @@ class LogListener
 public:
   virtual ~LogListener() = default;
   virtual void Log(LogTypes::LOG_LEVELS, const char* msg) = 0;
+  virtual void Flush() {}
 
   enum LISTENER
   {
@@ -52,6 +58,9 @@ public:
   void EnableListener(LogListener::LISTENER id, bool enable);
   bool IsListenerEnabled(LogListener::LISTENER id) const;
 
+  // Number of messages dropped by the rate limiter or because the async queue was full
+  u64 GetDroppedCount() const;
+
 private:
   struct LogContainer
   {
@@ -64,9 +73,22 @@ private:
 	  bool m_enable = false;
   };
 
+  // Messages per second for each log type
+  struct RateCounter
+  {
+    std::atomic<u32> second;
+    std::atomic<u32> count;
+  };
+
   LogManager();
   ~LogManager();
 
+  bool IsRateLimited(LogTypes::LOG_TYPE type, double time);
+  void Dropped();
+  void Write(LogTypes::LOG_LEVELS level, LogTypes::LOG_TYPE type, const char* file, int line,
+             double time, const char* text);
+  void FlushListeners();
+
   LogManager(const LogManager&) = delete;
   LogManager& operator=(const LogManager&) = delete;
   LogManager(LogManager&&) = delete;
@@ -77,4 +99,9 @@ private:
   std::array<LogListener*, LogListener::NUMBER_OF_LISTENERS> m_listeners{};
   BitSet32 m_listener_ids;
   size_t m_path_cutoff_point = 0;
+  u32 m_rate_limit = 0;
+  std::array<RateCounter, LogTypes::NUMBER_OF_LOGS> m_rate_counters;
+  std::atomic<u64> m_dropped;
+  std::atomic<u32> m_dropped_unreported;
+  std::unique_ptr<AsyncLog> m_async;
 };
@@ -108,6 +108,13 @@ std::string getVulkanCachePath()
 	return get_writable_data_path("vulkan_pipeline.cache");
 }
 
+std::string getShaderCachePath(const std::string& suffix)
+{
+	if (settings.imgread.ImagePath[0] == '\0')
+		return "";
+	return get_game_save_prefix() + suffix;
+}
+
 std::string getTextureLoadPath(const std::string& gameId)
 {
 	if (gameId.length() > 0)
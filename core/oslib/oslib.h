@@ -41,6 +41,7 @@ namespace hostfs
 	std::string getTextureDumpPath();
 
 	std::string getVulkanCachePath();
+	std::string getShaderCachePath(const std::string& suffix);
 
 	std::string getBiosFontPath();
 }
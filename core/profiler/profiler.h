@@ -133,12 +133,27 @@ struct profiler_cfg
 			}
 		} blkrun;
 
+		// dynarec software TLB (see vmem_tlb). Hits aren't counted to keep the inline lookup short.
+		struct
+		{
+			u32 miss;
+			u32 uncached;	// accesses to handler areas
+
+			void print()
+			{
+				print_head("memtlb");
+				print_elem("miss",miss);
+				print_elem("uncached",uncached);
+			}
+		} memtlb;
+
 		void print()
 		{
 			shil.print();
 			ralloc.print();
 			bm.print();
 			blkrun.print();
+			memtlb.print();
 		}
 	} counters;
 };
@@ -888,7 +888,7 @@ static bool ngen_readm_immediate(RuntimeBlockInfo* block, shil_opcode* op, bool
 
 	mem_op_type optp = memop_type(op);
 	bool isram = false;
-	void* ptr = _vmem_read_const(addr, isram, std::min(4u, memop_bytes[optp]));
+	void* ptr = _vmem_read_const_rec(addr, isram, memop_bytes[optp]);
 
 	Register rd = (optp != SZ_32F && optp != SZ_64F) ? reg.mapReg(op->rd) : r0;
 
@@ -1008,7 +1008,7 @@ static bool ngen_writemem_immediate(RuntimeBlockInfo* block, shil_opcode* op, bo
 
 	mem_op_type optp = memop_type(op);
 	bool isram = false;
-	void* ptr = _vmem_write_const(addr, isram, std::min(4u, memop_bytes[optp]));
+	void* ptr = _vmem_write_const_rec(addr, isram, memop_bytes[optp]);
 
 	Register rs2 = r1;
 	SRegister rs2f = s0;
@@ -1983,38 +1983,42 @@ void ngen_Compile(RuntimeBlockInfo* block, bool force_checks, bool reset, bool s
 
 		if (force_checks)
 		{
-			s32 sz = block->sh4_code_size;
-			while (sz > 0)
+			for (const BlockCheckRange& range : block->sh4_check_ranges)
 			{
-				if (sz > 2)
+				addr = range.addr;
+				s32 sz = range.size;
+				while (sz > 0)
 				{
-					u32* ptr = (u32*)GetMemPtr(addr, 4);
-					if (ptr != nullptr)
+					if (sz > 2)
 					{
-						ass.Mov(r2, (u32)ptr);
-						ass.Ldr(r2, MemOperand(r2));
-						ass.Mov(r1, *ptr);
-						ass.Cmp(r1, r2);
-
-						jump(ngen_blockcheckfail, ne);
+						u32* ptr = (u32*)GetMemPtr(addr, 4);
+						if (ptr != nullptr)
+						{
+							ass.Mov(r2, (u32)ptr);
+							ass.Ldr(r2, MemOperand(r2));
+							ass.Mov(r1, *ptr);
+							ass.Cmp(r1, r2);
+
+							jump(ngen_blockcheckfail, ne);
+						}
+						addr += 4;
+						sz -= 4;
 					}
-					addr += 4;
-					sz -= 4;
-				}
-				else
-				{
-					u16* ptr = (u16 *)GetMemPtr(addr, 2);
-					if (ptr != nullptr)
+					else
 					{
-						ass.Mov(r2, (u32)ptr);
-						ass.Ldrh(r2, MemOperand(r2));
-						ass.Mov(r1, *ptr);
-						ass.Cmp(r1, r2);
-
-						jump(ngen_blockcheckfail, ne);
+						u16* ptr = (u16 *)GetMemPtr(addr, 2);
+						if (ptr != nullptr)
+						{
+							ass.Mov(r2, (u32)ptr);
+							ass.Ldrh(r2, MemOperand(r2));
+							ass.Mov(r1, *ptr);
+							ass.Cmp(r1, r2);
+
+							jump(ngen_blockcheckfail, ne);
+						}
+						addr += 2;
+						sz -= 2;
 					}
-					addr += 2;
-					sz -= 2;
 				}
 			}
 		}
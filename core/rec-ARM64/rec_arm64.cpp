@@ -1123,6 +1123,87 @@ public:
 		EnsureCodeSize(start_instruction, write_memory_rewrite_size);
 	}
 
+	// Inline memory access through the software TLB, used when the fast memory mapping isn't available.
+	// The physical address is in w0 and the data to write in w1/x1.
+	// Reads return their result in w0/x0, sign-extended like the slow handlers.
+	void GenTlbMemAccess(u32 size, bool write)
+	{
+		Label miss;
+		Label done;
+
+		Lsr(w2, w0, VMEM_TLB_PAGE_BITS);
+		And(w3, w2, VMEM_TLB_SIZE - 1);
+		Mov(x4, reinterpret_cast<uintptr_t>(&vmem_tlb));
+		Add(x5, x4, offsetof(VMemTlb, tag));
+		Ldr(w5, MemOperand(x5, x3, LSL, 2));
+		Cmp(w5, w2);
+		B(&miss, ne);
+		Add(x4, x4, offsetof(VMemTlb, ptr));
+		Ldr(x4, MemOperand(x4, x3, LSL, 3));
+		And(w2, w0, (1 << VMEM_TLB_PAGE_BITS) - 1);
+		switch (size)
+		{
+		case 1:
+			if (write)
+				Strb(w1, MemOperand(x4, x2));
+			else
+				Ldrsb(w0, MemOperand(x4, x2));
+			break;
+		case 2:
+			if (write)
+				Strh(w1, MemOperand(x4, x2));
+			else
+				Ldrsh(w0, MemOperand(x4, x2));
+			break;
+		case 4:
+			if (write)
+				Str(w1, MemOperand(x4, x2));
+			else
+				Ldr(w0, MemOperand(x4, x2));
+			break;
+		case 8:
+			if (write)
+				Str(x1, MemOperand(x4, x2));
+			else
+				Ldr(x0, MemOperand(x4, x2));
+			break;
+		default:
+			die("1..8 bytes");
+			break;
+		}
+		B(&done);
+
+		Bind(&miss);
+		switch (size)
+		{
+		case 1:
+			if (write)
+				GenCallRuntime(_vmem_tlb_write<u8>);
+			else
+				GenCallRuntime(_vmem_tlb_read< ::s8, ::s32>);
+			break;
+		case 2:
+			if (write)
+				GenCallRuntime(_vmem_tlb_write<u16>);
+			else
+				GenCallRuntime(_vmem_tlb_read< ::s16, ::s32>);
+			break;
+		case 4:
+			if (write)
+				GenCallRuntime(_vmem_tlb_write<u32>);
+			else
+				GenCallRuntime(_vmem_tlb_read<u32, u32>);
+			break;
+		case 8:
+			if (write)
+				GenCallRuntime(_vmem_tlb_write<u64>);
+			else
+				GenCallRuntime(_vmem_tlb_read<u64, u64>);
+			break;
+		}
+		Bind(&done);
+	}
+
 	u32 RelinkBlock(RuntimeBlockInfo *block)
 	{
 		ptrdiff_t start_offset = GetBuffer()->GetCursorOffset();
@@ -1663,7 +1744,9 @@ private:
 		genMmuLookup(op, 0);
 
 		u32 size = op.flags & 0x7f;
-		if (!optimise || !GenReadMemoryFast(op, opid))
+		if (optimise && !_nvmem_enabled())
+			GenTlbMemAccess(size, false);
+		else if (!optimise || !GenReadMemoryFast(op, opid))
 			GenReadMemorySlow(size);
 
 		if (size < 8)
@@ -1708,7 +1791,7 @@ private:
 			addr = paddr;
 		}
 		bool isram = false;
-		void* ptr = _vmem_read_const(addr, isram, size > 4 ? 4 : size);
+		void* ptr = _vmem_read_const_rec(addr, isram, size);
 
 		if (isram)
 		{
@@ -1877,10 +1960,10 @@ private:
 			shil_param_to_host_reg(op.rs2, w1);
 		else
 			shil_param_to_host_reg(op.rs2, x1);
-		if (optimise && GenWriteMemoryFast(op, opid))
-			return;
-
-		GenWriteMemorySlow(size);
+		if (optimise && !_nvmem_enabled())
+			GenTlbMemAccess(size, true);
+		else if (!optimise || !GenWriteMemoryFast(op, opid))
+			GenWriteMemorySlow(size);
 	}
 
 	bool GenWriteMemoryImmediate(const shil_opcode& op)
@@ -1919,7 +2002,7 @@ private:
 			addr = paddr;
 		}
 		bool isram = false;
-		void* ptr = _vmem_write_const(addr, isram, size > 4 ? 4 : size);
+		void* ptr = _vmem_write_const_rec(addr, isram, size);
 
 		Register reg2;
 		if (size != 8)
@@ -2060,39 +2143,42 @@ private:
 		}
 		if (force_checks)
 		{
-			s32 sz = block->sh4_code_size;
-			u8* ptr = GetMemPtr(block->addr, sz);
-			if (ptr != NULL)
+			for (const BlockCheckRange& range : block->sh4_check_ranges)
 			{
-				Ldr(x9, reinterpret_cast<uintptr_t>(ptr));
-
-				while (sz > 0)
+				s32 sz = range.size;
+				u8* ptr = GetMemPtr(range.addr, sz);
+				if (ptr != NULL)
 				{
-					if (sz >= 8)
-					{
-						Ldr(x10, MemOperand(x9, 8, PostIndex));
-						Ldr(x11, *(u64*)ptr);
-						Cmp(x10, x11);
-						sz -= 8;
-						ptr += 8;
-					}
-					else if (sz >= 4)
-					{
-						Ldr(w10, MemOperand(x9, 4, PostIndex));
-						Ldr(w11, *(u32*)ptr);
-						Cmp(w10, w11);
-						sz -= 4;
-						ptr += 4;
-					}
-					else
+					Ldr(x9, reinterpret_cast<uintptr_t>(ptr));
+
+					while (sz > 0)
 					{
-						Ldrh(w10, MemOperand(x9, 2, PostIndex));
-						Mov(w11, *(u16*)ptr);
-						Cmp(w10, w11);
-						sz -= 2;
-						ptr += 2;
+						if (sz >= 8)
+						{
+							Ldr(x10, MemOperand(x9, 8, PostIndex));
+							Ldr(x11, *(u64*)ptr);
+							Cmp(x10, x11);
+							sz -= 8;
+							ptr += 8;
+						}
+						else if (sz >= 4)
+						{
+							Ldr(w10, MemOperand(x9, 4, PostIndex));
+							Ldr(w11, *(u32*)ptr);
+							Cmp(w10, w11);
+							sz -= 4;
+							ptr += 4;
+						}
+						else
+						{
+							Ldrh(w10, MemOperand(x9, 2, PostIndex));
+							Mov(w11, *(u16*)ptr);
+							Cmp(w10, w11);
+							sz -= 2;
+							ptr += 2;
+						}
+						B(ne, &blockcheck_fail);
 					}
-					B(ne, &blockcheck_fail);
 				}
 			}
 		}
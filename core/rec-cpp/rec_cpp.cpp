@@ -3,6 +3,7 @@
 #if FEAT_SHREC == DYNAREC_CPP
 #include "hw/sh4/sh4_opcode_list.h"
 #include "hw/sh4/modules/ccn.h"
+#include "hw/sh4/modules/mmu.h"
 #include "hw/sh4/sh4_interrupts.h"
 
 #include "hw/sh4/sh4_core.h"
@@ -14,11 +15,39 @@
 
 #include <algorithm>
 #include <map>
+#include <memory>
+#include <new>
+
+class fnblock_base;
+struct DynaRBI;
+
+// Direct link from the end of a block to one of its static successors
+struct BlockLink
+{
+	DynaRBI *owner;
+	fnblock_base *fnb;
+	void (*runner)(fnblock_base *fnb);
+};
 
 struct DynaRBI : RuntimeBlockInfo
 {
+	fnblock_base *fnb = nullptr;
+	void (*runner)(fnblock_base *fnb) = nullptr;
+	BlockLink nextLink;
+	BlockLink branchLink;
+
+	DynaRBI()
+	{
+		nextLink = { this, nullptr, nullptr };
+		branchLink = { this, nullptr, nullptr };
+	}
+
 	virtual u32 Relink() {
-		//verify(false);
+		// Drop the links whose target has been discarded
+		if (pNextBlock == nullptr)
+			nextLink.runner = nullptr;
+		if (pBranchBlock == nullptr)
+			branchLink.runner = nullptr;
 		return 0;
 	}
 
@@ -27,7 +56,70 @@ struct DynaRBI : RuntimeBlockInfo
 	}
 };
 
+// Bump allocator for the block closures. Everything is released at once when the code cache is reset.
+class ClosureArena
+{
+	static const size_t ChunkSize = 256 * 1024;
+
+	std::vector<std::unique_ptr<u8[]>> chunks;
+	std::vector<std::unique_ptr<u8[]>> retired;
+	size_t used = 0;
+
+public:
+	void *alloc(size_t size, size_t align)
+	{
+		size_t offset = (used + align - 1) & ~(align - 1);
+		if (chunks.empty() || offset + size > ChunkSize)
+		{
+			chunks.push_back(std::unique_ptr<u8[]>(new u8[size > ChunkSize ? size : ChunkSize]));
+			offset = 0;
+		}
+		used = offset + size;
+		return &chunks.back()[offset];
+	}
+
+	void reset()
+	{
+		// The block that triggered the reset (SMC check failure) is still running,
+		// so its closures are only freed at the next reset.
+		retired = std::move(chunks);
+		chunks.clear();
+		used = 0;
+	}
+};
+
+static ClosureArena arena;
+
+// Closures are trivially destructible and never deleted individually
+template<typename T>
+static T *arenaNew()
+{
+	return new (arena.alloc(sizeof(T), alignof(T))) T();
+}
+
 int cycle_counter;
+// Link to follow after the current block, set by the block end
+static BlockLink *chainedLink;
+
+static void linkBlock(BlockLink *link, u32 pc)
+{
+	RuntimeBlockInfoPtr source = bm_GetBlock((void *)link->owner->code);
+	// The source block may have been discarded while running
+	if (source.get() != link->owner)
+		return;
+	RuntimeBlockInfoPtr target = bm_GetBlock(pc);
+	if (!target)
+		return;
+	if (link == &link->owner->branchLink)
+		source->pBranchBlock = target.get();
+	else
+		source->pNextBlock = target.get();
+	target->AddRef(source);
+
+	DynaRBI *dtarget = (DynaRBI *)target.get();
+	link->fnb = dtarget->fnb;
+	link->runner = dtarget->runner;
+}
 
 void ngen_mainloop(void* v_cntx)
 {
@@ -39,13 +131,25 @@ void ngen_mainloop(void* v_cntx)
 	{
 		cycle_counter = SH4_TIMESLICE;
 		do {
-			DynarecCodeEntryPtr rcb = bm_GetCodeByVAddr(ctx->cntx.pc);
-			rcb();
+			BlockLink *link = chainedLink;
+			chainedLink = nullptr;
+			if (link != nullptr && link->runner != nullptr)
+			{
+				link->runner(link->fnb);
+			}
+			else
+			{
+				DynarecCodeEntryPtr rcb = bm_GetCodeByVAddr(ctx->cntx.pc);
+				if (link != nullptr && rcb != ngen_FailedToFindBlock && !mmu_enabled())
+					linkBlock(link, ctx->cntx.pc);
+				rcb();
+			}
 		} while (cycle_counter > 0);
+		// pc may be changed by interrupts
+		chainedLink = nullptr;
 
-		if (UpdateSystem()) {
-			rdv_DoInterrupts_pc(ctx->cntx.pc);
-		}
+		// Hot block sampling, idle loop skipping and interrupts, as in the x64 mainloop
+		rdv_UpdateSystem();
 	}
 }
 
@@ -1016,10 +1120,14 @@ struct opcode_blockend : public opcodeExec {
 	int next_pc_value;
 	int branch_pc_value;
 	const u32* jdyn;
+	BlockLink *nextLink;
+	BlockLink *branchLink;
 
 	opcodeExec* setup(RuntimeBlockInfo* block) {
 		next_pc_value = block->NextBlock;
 		branch_pc_value = block->BranchBlock;
+		nextLink = &((DynaRBI *)block)->nextLink;
+		branchLink = &((DynaRBI *)block)->branchLink;
 
 		jdyn = &Sh4cntx.jdyn;
 		if (!block->has_jcond && BET_GET_CLS(block->BlockType) == BET_CLS_COND) {
@@ -1037,20 +1145,12 @@ struct opcode_blockend : public opcodeExec {
 		case BET_StaticJump:
 		case BET_StaticCall:
 			next_pc = branch_pc_value;
+			chainedLink = branchLink;
 			break;
 
 		case BET_Cond_0:
-			if (*jdyn != 0)
-				next_pc = next_pc_value;
-			else
-				next_pc = branch_pc_value;
-			break;
-
 		case BET_Cond_1:
-			if (*jdyn != 1)
-				next_pc = next_pc_value;
-			else
-				next_pc = branch_pc_value;
+			branch(*jdyn);
 			break;
 
 		case BET_DynamicJump:
@@ -1073,28 +1173,82 @@ struct opcode_blockend : public opcodeExec {
 			die("NOT GONNA HAPPEN TODAY, ALRIGHY?");
 		}
 	}
+
+	void branch(u32 t)
+	{
+		if (t != (end_type == BET_Cond_0 ? 0 : 1))
+		{
+			next_pc = next_pc_value;
+			chainedLink = nextLink;
+		}
+		else
+		{
+			next_pc = branch_pc_value;
+			chainedLink = branchLink;
+		}
+	}
+};
+
+// Compare fused with the conditional block end that consumes its result
+template<int cmp, int end_type>
+struct opcode_cmp_blockend : public opcode_blockend<end_type> {
+	const u32* rs1;
+	const u32* rs2;
+	u32 imm2;
+
+	void execute()  {
+		u32 t;
+		switch (cmp)
+		{
+		case shop_test:
+			t = (*rs1 & *rs2) == 0;
+			break;
+		case shop_seteq:
+			t = *rs1 == *rs2;
+			break;
+		case shop_setge:
+			t = (s32)*rs1 >= (s32)*rs2;
+			break;
+		case shop_setgt:
+			t = (s32)*rs1 > (s32)*rs2;
+			break;
+		case shop_setae:
+			t = *rs1 >= *rs2;
+			break;
+		case shop_setab:
+			t = *rs1 > *rs2;
+			break;
+		default:
+			die("Invalid compare op");
+		}
+		sr.T = t;
+		this->branch(t);
+	}
 };
 
 template <int sz>
 struct opcode_check_block : public opcodeExec {
 	RuntimeBlockInfo* block;
-	std::vector<u8> code;
+	const u8* code;
 	const void* ptr;
 
 	opcodeExec* setup(RuntimeBlockInfo* block) {
 		this->block = block;
-		ptr = GetMemPtr(block->addr, 4);
+		code = nullptr;
+		ptr = GetMemPtr(block->sh4_check_ranges[0].addr, 4);
 		if (ptr != NULL)
 		{
-			code.resize(sz == -1 ? block->sh4_code_size : sz);
-			memcpy(&code[0], ptr, sz == -1 ? block->sh4_code_size : sz);
+			u32 size = sz == -1 ? block->sh4_check_ranges[0].size : sz;
+			u8 *copy = (u8 *)arena.alloc(size, 4);
+			memcpy(copy, ptr, size);
+			code = copy;
 		}
 
 		return this;
 	}
 
 	void execute() {
-		if (code.empty())
+		if (code == nullptr)
 			return;
 
 		switch (sz)
@@ -1112,13 +1266,51 @@ struct opcode_check_block : public opcodeExec {
 				ngen_blockcheckfail(block->addr);
 			break;
 		default:
-			if (memcmp(ptr, &code[0], block->sh4_code_size) != 0)
+			if (memcmp(ptr, &code[0], block->sh4_check_ranges[0].size) != 0)
 				ngen_blockcheckfail(block->addr);
 			break;
 		}
 	}
 };
 
+// Superblocks have several checked ranges
+struct opcode_check_ranges : public opcodeExec {
+	struct Range {
+		const void* ptr;
+		const u8* code;
+		u32 size;
+	};
+	RuntimeBlockInfo* block;
+	Range* ranges;
+	u32 count;
+
+	opcodeExec* setup(RuntimeBlockInfo* block) {
+		this->block = block;
+		ranges = (Range *)arena.alloc(sizeof(Range) * block->sh4_check_ranges.size(), alignof(Range));
+		count = 0;
+		for (const BlockCheckRange& range : block->sh4_check_ranges)
+		{
+			const void* ptr = GetMemPtr(range.addr, 4);
+			if (ptr == NULL)
+				continue;
+			u8 *copy = (u8 *)arena.alloc(range.size, 4);
+			memcpy(copy, ptr, range.size);
+			ranges[count++] = { ptr, copy, range.size };
+		}
+
+		return this;
+	}
+
+	void execute() {
+		for (u32 i = 0; i < count; i++)
+			if (memcmp(ranges[i].ptr, ranges[i].code, ranges[i].size) != 0)
+			{
+				ngen_blockcheckfail(block->addr);
+				return;
+			}
+	}
+};
+
 #if !defined(_DEBUG)
 	#define DREP_1(x, phrase) if (x < cnt) ops[x]->execute(); else return;
 	#define DREP_2(x, phrase) DREP_1(x, phrase) DREP_1(x+1, phrase)
@@ -1136,8 +1328,6 @@ struct opcode_check_block : public opcodeExec {
 
 class fnblock_base
 {
-public:
-	virtual ~fnblock_base() {}
 };
 
 template <int cnt>
@@ -1154,11 +1344,6 @@ public:
 	static void runner(fnblock_base* fnb) {
 		((fnblock<cnt>*)fnb)->execute();
 	}
-	~fnblock()
-	{
-		for (int i = 0; i < cnt; i++)
-			delete ops[i];
-	}
 };
 
 template <>
@@ -1176,7 +1361,7 @@ struct fnrv {
 
 template<int opcode_slots>
 fnrv fnnCtor(int cycles) {
-	auto rv = new fnblock<opcode_slots>();
+	auto rv = arenaNew<fnblock<opcode_slots>>();
 	rv->cc = cycles;
 	fnrv rvb = { rv, &fnblock<opcode_slots>::runner, rv->ops };
 	return rvb;
@@ -1191,7 +1376,7 @@ fnrv fnnCtor<0>(int cycles) {
 template <typename shilop, typename CTR>
 opcodeExec* createType2(const CC_pars_t& prms, void* fun) {
 	typedef typename CTR::template opex2<shilop> thetype;
-	auto rv = new thetype();
+	auto rv = arenaNew<thetype>();
 
 	rv->setup(prms, fun);
 	return rv;
@@ -1432,7 +1617,7 @@ opcodeExec* createType(const CC_pars_t& prms, void* fun, shil_opcode* opcode) {
 	}
 
 	typedef typename CTR::opex thetype;
-	auto rv = new thetype();
+	auto rv = arenaNew<thetype>();
 
 	rv->setup(prms, fun);
 	return rv;
@@ -1534,21 +1719,102 @@ class BlockCompiler {
 		return param.is_imm() ? &param._imm : param.reg_ptr();
 	}
 
+	bool canFuseCompare(RuntimeBlockInfo* block)
+	{
+		if (block->oplist.empty() || block->has_jcond || BET_GET_CLS(block->BlockType) != BET_CLS_COND)
+			return false;
+		const shil_opcode& op = block->oplist.back();
+		switch (op.op)
+		{
+		case shop_test:
+		case shop_seteq:
+		case shop_setge:
+		case shop_setgt:
+		case shop_setae:
+		case shop_setab:
+			return op.rd.is_reg() && op.rd._reg == reg_sr_T && op.rs1.is_reg()
+					&& (op.rs2.is_reg() || op.rs2.is_imm());
+		default:
+			return false;
+		}
+	}
+
+	template<int end_type>
+	opcodeExec* compileCompareBlockEnd(RuntimeBlockInfo* block, const shil_opcode& op)
+	{
+		opcodeExec* rv;
+		const u32 **rs1;
+		const u32 **rs2;
+		u32 *imm2;
+
+		#define CASECMP(n) case n: { \
+				auto opc = arenaNew<opcode_cmp_blockend<n, end_type>>(); \
+				opc->setup(block); \
+				rs1 = &opc->rs1; rs2 = &opc->rs2; imm2 = &opc->imm2; \
+				rv = opc; \
+			} \
+			break
+
+		switch (op.op)
+		{
+			CASECMP(shop_test);
+			CASECMP(shop_seteq);
+			CASECMP(shop_setge);
+			CASECMP(shop_setgt);
+			CASECMP(shop_setae);
+			CASECMP(shop_setab);
+		default:
+			die("Invalid compare op");
+			return nullptr;
+		}
+		#undef CASECMP
+
+		*rs1 = op.rs1.reg_ptr();
+		if (op.rs2.is_imm())
+		{
+			*imm2 = op.rs2.imm_value();
+			*rs2 = imm2;
+		}
+		else
+		{
+			*rs2 = op.rs2.reg_ptr();
+		}
+		return rv;
+	}
+
+	opcodeExec* compileCompareBlockEnd(RuntimeBlockInfo* block, const shil_opcode& op)
+	{
+		if (block->BlockType == BET_Cond_0)
+			return compileCompareBlockEnd<BET_Cond_0>(block, op);
+		else
+			return compileCompareBlockEnd<BET_Cond_1>(block, op);
+	}
+
 	size_t opcode_index;
 	opcodeExec** ptrsg;
 
 public:
 	void compile(RuntimeBlockInfo* block, bool smc_checks, bool reset, bool staging, bool optimise)
 	{
+		// a trailing compare is merged into the block end
+		size_t opcount = block->oplist.size();
+		bool fuseCompare = canFuseCompare(block);
+		if (fuseCompare)
+			opcount--;
+
 		//we need an extra one for the end opcode and optionally one more for block check
-		auto ptrs = fnnCtor_forreal(block->oplist.size() + 1 + (smc_checks ? 1 : 0))(block->guest_cycles);
+		auto ptrs = fnnCtor_forreal(opcount + 1 + (smc_checks ? 1 : 0))(block->guest_cycles);
 
 		ptrsg = ptrs.ptrs;
 
 		dispatchb[idxnxx].fnb = ptrs.fnb;
 		dispatchb[idxnxx].runner = ptrs.runner;
+		((DynaRBI *)block)->fnb = ptrs.fnb;
+		((DynaRBI *)block)->runner = ptrs.runner;
 
 		block->code = getndpn_forreal(idxnxx++);
+		// each block has its own dispatch function, so that bm_GetBlock(code) finds it
+		block->host_code_size = 1;
 
 		if (getndpn_forreal(idxnxx) == 0) {
 			emit_Skip(emit_FreeSpace()-16);
@@ -1558,25 +1824,30 @@ public:
 		if (smc_checks)
 		{
 			opcodeExec* op;
-			switch (block->sh4_code_size)
+			if (block->sh4_check_ranges.size() > 1)
+				op = arenaNew<opcode_check_ranges>()->setup(block);
+			else
 			{
-			case 4:
-				op = (new opcode_check_block<4>())->setup(block);
-				break;
-			case 6:
-				op = (new opcode_check_block<6>())->setup(block);
-				break;
-			case 8:
-				op = (new opcode_check_block<8>())->setup(block);
-				break;
-			default:
-				op = (new opcode_check_block<-1>())->setup(block);
-				break;
+				switch (block->sh4_check_ranges[0].size)
+				{
+				case 4:
+					op = arenaNew<opcode_check_block<4>>()->setup(block);
+					break;
+				case 6:
+					op = arenaNew<opcode_check_block<6>>()->setup(block);
+					break;
+				case 8:
+					op = arenaNew<opcode_check_block<8>>()->setup(block);
+					break;
+				default:
+					op = arenaNew<opcode_check_block<-1>>()->setup(block);
+					break;
+				}
 			}
 			ptrs.ptrs[i++] = op;
 		}
 
-		for (size_t opnum = 0; opnum < block->oplist.size(); opnum++, i++) {
+		for (size_t opnum = 0; opnum < opcount; opnum++, i++) {
 			opcode_index = i;
 			shil_opcode& op = block->oplist[opnum];
 			switch (op.op) {
@@ -1584,7 +1855,7 @@ public:
 			case shop_ifb:
 			{
 				if (op.rs1.imm_value()) {
-					auto opc = new opcode_ifb_pc();
+					auto opc = arenaNew<opcode_ifb_pc>();
 					ptrs.ptrs[i] = opc;
 					
 					opc->pc = op.rs2.imm_value();
@@ -1593,7 +1864,7 @@ public:
 					opc->oph = OpDesc[op.rs3.imm_value()]->oph;
 				}
 				else {
-					auto opc = new opcode_ifb();
+					auto opc = arenaNew<opcode_ifb>();
 					ptrs.ptrs[i] = opc;
 
 					opc->opcode = op.rs3.imm_value();
@@ -1607,14 +1878,14 @@ public:
 			case shop_jdyn:
 			{
 				if (op.rs2.is_imm()) {
-					auto opc = new opcode_jdyn_imm();
+					auto opc = arenaNew<opcode_jdyn_imm>();
 					ptrs.ptrs[i] = opc;
 
 					opc->src = op.rs1.reg_ptr();
 					opc->imm = op.rs2.imm_value();
 				}
 				else {
-					auto opc = new opcode_jdyn();
+					auto opc = arenaNew<opcode_jdyn>();
 					ptrs.ptrs[i] = opc;
 
 					opc->src = op.rs1.reg_ptr();
@@ -1631,14 +1902,14 @@ public:
 
 			
 				if (op.rs1.is_imm()) {
-					auto opc = new opcode_mov32_imm();
+					auto opc = arenaNew<opcode_mov32_imm>();
 					ptrs.ptrs[i] = opc;
 
 					opc->src = op.rs1.imm_value();
 					opc->dst = op.rd.reg_ptr();
 				}
 				else {
-					auto opc = new opcode_mov32();
+					auto opc = arenaNew<opcode_mov32>();
 					ptrs.ptrs[i] = opc;
 
 					opc->src = op.rs1.reg_ptr();
@@ -1655,7 +1926,7 @@ public:
 
 				verify(op.rs1.is_reg());
 
-				auto opc = new opcode_mov64();
+				auto opc = arenaNew<opcode_mov64>();
 				ptrs.ptrs[i] = opc;
 
 				opc->src = (u64*) op.rs1.reg_ptr();
@@ -1671,76 +1942,76 @@ public:
 
 					if (size == 1)
 					{
-						auto opc = new opcode_readm_imm<1>(); ptrs.ptrs[i] = opc; opc->src = op.rs1.imm_value(); opc->dst = op.rd.reg_ptr();
+						auto opc = arenaNew<opcode_readm_imm<1>>(); ptrs.ptrs[i] = opc; opc->src = op.rs1.imm_value(); opc->dst = op.rd.reg_ptr();
 					}
 					else if (size == 2)
 					{
-						auto opc = new opcode_readm_imm<2>(); ptrs.ptrs[i] = opc; opc->src = op.rs1.imm_value(); opc->dst = op.rd.reg_ptr();
+						auto opc = arenaNew<opcode_readm_imm<2>>(); ptrs.ptrs[i] = opc; opc->src = op.rs1.imm_value(); opc->dst = op.rd.reg_ptr();
 					}
 					else if (size == 4)
 					{
-						auto opc = new opcode_readm_imm<4>(); ptrs.ptrs[i] = opc; opc->src = op.rs1.imm_value(); opc->dst = op.rd.reg_ptr();
+						auto opc = arenaNew<opcode_readm_imm<4>>(); ptrs.ptrs[i] = opc; opc->src = op.rs1.imm_value(); opc->dst = op.rd.reg_ptr();
 					}
 					else if (size == 8)
 					{
-						auto opc = new opcode_readm_imm<8>(); ptrs.ptrs[i] = opc; opc->src = op.rs1.imm_value(); opc->dst = op.rd.reg_ptr();
+						auto opc = arenaNew<opcode_readm_imm<8>>(); ptrs.ptrs[i] = opc; opc->src = op.rs1.imm_value(); opc->dst = op.rd.reg_ptr();
 					}
 				}
 				else if (op.rs3.is_imm()) {
 					verify(op.rs2.is_null());
 					if (size == 1)
 					{
-						auto opc = new opcode_readm_offs_imm<1>(); ptrs.ptrs[i] = opc; opc->src = op.rs1.reg_ptr(); opc->offs = op.rs3.imm_value(); opc->dst = op.rd.reg_ptr();
+						auto opc = arenaNew<opcode_readm_offs_imm<1>>(); ptrs.ptrs[i] = opc; opc->src = op.rs1.reg_ptr(); opc->offs = op.rs3.imm_value(); opc->dst = op.rd.reg_ptr();
 					}
 					else if (size == 2)
 					{
-						auto opc = new opcode_readm_offs_imm<2>(); ptrs.ptrs[i] = opc; opc->src = op.rs1.reg_ptr(); opc->offs = op.rs3.imm_value(); opc->dst = op.rd.reg_ptr();
+						auto opc = arenaNew<opcode_readm_offs_imm<2>>(); ptrs.ptrs[i] = opc; opc->src = op.rs1.reg_ptr(); opc->offs = op.rs3.imm_value(); opc->dst = op.rd.reg_ptr();
 					}
 					else if (size == 4)
 					{
-						auto opc = new opcode_readm_offs_imm<4>(); ptrs.ptrs[i] = opc; opc->src = op.rs1.reg_ptr(); opc->offs = op.rs3.imm_value(); opc->dst = op.rd.reg_ptr();
+						auto opc = arenaNew<opcode_readm_offs_imm<4>>(); ptrs.ptrs[i] = opc; opc->src = op.rs1.reg_ptr(); opc->offs = op.rs3.imm_value(); opc->dst = op.rd.reg_ptr();
 					}
 					else if (size == 8)
 					{
-						auto opc = new opcode_readm_offs_imm<8>(); ptrs.ptrs[i] = opc; opc->src = op.rs1.reg_ptr(); opc->offs = op.rs3.imm_value(); opc->dst = op.rd.reg_ptr();
+						auto opc = arenaNew<opcode_readm_offs_imm<8>>(); ptrs.ptrs[i] = opc; opc->src = op.rs1.reg_ptr(); opc->offs = op.rs3.imm_value(); opc->dst = op.rd.reg_ptr();
 					}
 				}
 				else if (op.rs3.is_reg()) {
 					verify(op.rs2.is_null());
 					if (size == 1)
 					{
-						auto opc = new opcode_readm_offs<1>(); ptrs.ptrs[i] = opc; opc->src = op.rs1.reg_ptr(); opc->offs = op.rs3.reg_ptr(); opc->dst = op.rd.reg_ptr();
+						auto opc = arenaNew<opcode_readm_offs<1>>(); ptrs.ptrs[i] = opc; opc->src = op.rs1.reg_ptr(); opc->offs = op.rs3.reg_ptr(); opc->dst = op.rd.reg_ptr();
 					}
 					else if (size == 2)
 					{
-						auto opc = new opcode_readm_offs<2>(); ptrs.ptrs[i] = opc; opc->src = op.rs1.reg_ptr(); opc->offs = op.rs3.reg_ptr(); opc->dst = op.rd.reg_ptr();
+						auto opc = arenaNew<opcode_readm_offs<2>>(); ptrs.ptrs[i] = opc; opc->src = op.rs1.reg_ptr(); opc->offs = op.rs3.reg_ptr(); opc->dst = op.rd.reg_ptr();
 					}
 					else if (size == 4)
 					{
-						auto opc = new opcode_readm_offs<4>(); ptrs.ptrs[i] = opc; opc->src = op.rs1.reg_ptr(); opc->offs = op.rs3.reg_ptr(); opc->dst = op.rd.reg_ptr();
+						auto opc = arenaNew<opcode_readm_offs<4>>(); ptrs.ptrs[i] = opc; opc->src = op.rs1.reg_ptr(); opc->offs = op.rs3.reg_ptr(); opc->dst = op.rd.reg_ptr();
 					}
 					else if (size == 8)
 					{
-						auto opc = new opcode_readm_offs<8>(); ptrs.ptrs[i] = opc; opc->src = op.rs1.reg_ptr(); opc->offs = op.rs3.reg_ptr(); opc->dst = op.rd.reg_ptr();
+						auto opc = arenaNew<opcode_readm_offs<8>>(); ptrs.ptrs[i] = opc; opc->src = op.rs1.reg_ptr(); opc->offs = op.rs3.reg_ptr(); opc->dst = op.rd.reg_ptr();
 					}
 				}
 				else {
 					verify(op.rs2.is_null() && op.rs3.is_null());
 					if (size == 1)
 					{
-						auto opc = new opcode_readm<1>(); ptrs.ptrs[i] = opc; opc->src = op.rs1.reg_ptr(); opc->dst = op.rd.reg_ptr();
+						auto opc = arenaNew<opcode_readm<1>>(); ptrs.ptrs[i] = opc; opc->src = op.rs1.reg_ptr(); opc->dst = op.rd.reg_ptr();
 					}
 					else if (size == 2)
 					{
-						auto opc = new opcode_readm<2>(); ptrs.ptrs[i] = opc; opc->src = op.rs1.reg_ptr(); opc->dst = op.rd.reg_ptr();
+						auto opc = arenaNew<opcode_readm<2>>(); ptrs.ptrs[i] = opc; opc->src = op.rs1.reg_ptr(); opc->dst = op.rd.reg_ptr();
 					}
 					else if (size == 4)
 					{
-						auto opc = new opcode_readm<4>(); ptrs.ptrs[i] = opc; opc->src = op.rs1.reg_ptr(); opc->dst = op.rd.reg_ptr();
+						auto opc = arenaNew<opcode_readm<4>>(); ptrs.ptrs[i] = opc; opc->src = op.rs1.reg_ptr(); opc->dst = op.rd.reg_ptr();
 					}
 					else if (size == 8)
 					{
-						auto opc = new opcode_readm<8>(); ptrs.ptrs[i] = opc; opc->src = op.rs1.reg_ptr(); opc->dst = op.rd.reg_ptr();
+						auto opc = arenaNew<opcode_readm<8>>(); ptrs.ptrs[i] = opc; opc->src = op.rs1.reg_ptr(); opc->dst = op.rd.reg_ptr();
 					}
 				}
 			}
@@ -1754,74 +2025,74 @@ public:
 					verify(op.rs3.is_null());
 					if (size == 1)
 					{
-						auto opc = new opcode_writem_imm<1>(); ptrs.ptrs[i] = opc; opc->src = op.rs1.imm_value(); opc->src2 = get_reg_or_imm(op.rs2);
+						auto opc = arenaNew<opcode_writem_imm<1>>(); ptrs.ptrs[i] = opc; opc->src = op.rs1.imm_value(); opc->src2 = get_reg_or_imm(op.rs2);
 					}
 					else if (size == 2)
 					{
-						auto opc = new opcode_writem_imm<2>(); ptrs.ptrs[i] = opc; opc->src = op.rs1.imm_value(); opc->src2 = get_reg_or_imm(op.rs2);
+						auto opc = arenaNew<opcode_writem_imm<2>>(); ptrs.ptrs[i] = opc; opc->src = op.rs1.imm_value(); opc->src2 = get_reg_or_imm(op.rs2);
 					}
 					else if (size == 4)
 					{
-						auto opc = new opcode_writem_imm<4>(); ptrs.ptrs[i] = opc; opc->src = op.rs1.imm_value(); opc->src2 = get_reg_or_imm(op.rs2);
+						auto opc = arenaNew<opcode_writem_imm<4>>(); ptrs.ptrs[i] = opc; opc->src = op.rs1.imm_value(); opc->src2 = get_reg_or_imm(op.rs2);
 					}
 					else if (size == 8)
 					{
-						auto opc = new opcode_writem_imm<8>(); ptrs.ptrs[i] = opc; opc->src = op.rs1.imm_value(); opc->src2 = get_reg_or_imm(op.rs2);
+						auto opc = arenaNew<opcode_writem_imm<8>>(); ptrs.ptrs[i] = opc; opc->src = op.rs1.imm_value(); opc->src2 = get_reg_or_imm(op.rs2);
 					}
 				}
 				else if (op.rs3.is_imm()) {
 					if (size == 1)
 					{
-						auto opc = new opcode_writem_offs_imm<1>(); ptrs.ptrs[i] = opc; opc->src = op.rs1.reg_ptr(); opc->offs = op.rs3.imm_value(); opc->src2 = get_reg_or_imm(op.rs2);
+						auto opc = arenaNew<opcode_writem_offs_imm<1>>(); ptrs.ptrs[i] = opc; opc->src = op.rs1.reg_ptr(); opc->offs = op.rs3.imm_value(); opc->src2 = get_reg_or_imm(op.rs2);
 					}
 					else if (size == 2)
 					{
-						auto opc = new opcode_writem_offs_imm<2>(); ptrs.ptrs[i] = opc; opc->src = op.rs1.reg_ptr(); opc->offs = op.rs3.imm_value(); opc->src2 = get_reg_or_imm(op.rs2);
+						auto opc = arenaNew<opcode_writem_offs_imm<2>>(); ptrs.ptrs[i] = opc; opc->src = op.rs1.reg_ptr(); opc->offs = op.rs3.imm_value(); opc->src2 = get_reg_or_imm(op.rs2);
 					}
 					else if (size == 4)
 					{
-						auto opc = new opcode_writem_offs_imm<4>(); ptrs.ptrs[i] = opc; opc->src = op.rs1.reg_ptr(); opc->offs = op.rs3.imm_value(); opc->src2 = get_reg_or_imm(op.rs2);
+						auto opc = arenaNew<opcode_writem_offs_imm<4>>(); ptrs.ptrs[i] = opc; opc->src = op.rs1.reg_ptr(); opc->offs = op.rs3.imm_value(); opc->src2 = get_reg_or_imm(op.rs2);
 					}
 					else if (size == 8)
 					{
-						auto opc = new opcode_writem_offs_imm<8>(); ptrs.ptrs[i] = opc; opc->src = op.rs1.reg_ptr(); opc->offs = op.rs3.imm_value(); opc->src2 = get_reg_or_imm(op.rs2);
+						auto opc = arenaNew<opcode_writem_offs_imm<8>>(); ptrs.ptrs[i] = opc; opc->src = op.rs1.reg_ptr(); opc->offs = op.rs3.imm_value(); opc->src2 = get_reg_or_imm(op.rs2);
 					}
 				}
 				else if (op.rs3.is_reg()) {
 					if (size == 1)
 					{
-						auto opc = new opcode_writem_offs<1>(); ptrs.ptrs[i] = opc; opc->src = op.rs1.reg_ptr(); opc->offs = op.rs3.reg_ptr(); opc->src2 = get_reg_or_imm(op.rs2);
+						auto opc = arenaNew<opcode_writem_offs<1>>(); ptrs.ptrs[i] = opc; opc->src = op.rs1.reg_ptr(); opc->offs = op.rs3.reg_ptr(); opc->src2 = get_reg_or_imm(op.rs2);
 					}
 					else if (size == 2)
 					{
-						auto opc = new opcode_writem_offs<2>(); ptrs.ptrs[i] = opc; opc->src = op.rs1.reg_ptr(); opc->offs = op.rs3.reg_ptr(); opc->src2 = get_reg_or_imm(op.rs2);
+						auto opc = arenaNew<opcode_writem_offs<2>>(); ptrs.ptrs[i] = opc; opc->src = op.rs1.reg_ptr(); opc->offs = op.rs3.reg_ptr(); opc->src2 = get_reg_or_imm(op.rs2);
 					}
 					else if (size == 4)
 					{
-						auto opc = new opcode_writem_offs<4>(); ptrs.ptrs[i] = opc; opc->src = op.rs1.reg_ptr(); opc->offs = op.rs3.reg_ptr(); opc->src2 = get_reg_or_imm(op.rs2);
+						auto opc = arenaNew<opcode_writem_offs<4>>(); ptrs.ptrs[i] = opc; opc->src = op.rs1.reg_ptr(); opc->offs = op.rs3.reg_ptr(); opc->src2 = get_reg_or_imm(op.rs2);
 					}
 					else if (size == 8)
 					{
-						auto opc = new opcode_writem_offs<8>(); ptrs.ptrs[i] = opc; opc->src = op.rs1.reg_ptr(); opc->offs = op.rs3.reg_ptr(); opc->src2 = get_reg_or_imm(op.rs2);
+						auto opc = arenaNew<opcode_writem_offs<8>>(); ptrs.ptrs[i] = opc; opc->src = op.rs1.reg_ptr(); opc->offs = op.rs3.reg_ptr(); opc->src2 = get_reg_or_imm(op.rs2);
 					}
 				}
 				else {
 					verify(op.rs3.is_null());
 					if (size == 1)
 					{
-						auto opc = new opcode_writem<1>(); ptrs.ptrs[i] = opc; opc->src = op.rs1.reg_ptr(); opc->src2 = get_reg_or_imm(op.rs2);
+						auto opc = arenaNew<opcode_writem<1>>(); ptrs.ptrs[i] = opc; opc->src = op.rs1.reg_ptr(); opc->src2 = get_reg_or_imm(op.rs2);
 					}
 					else if (size == 2)
 					{
-						auto opc = new opcode_writem<2>(); ptrs.ptrs[i] = opc; opc->src = op.rs1.reg_ptr(); opc->src2 = get_reg_or_imm(op.rs2);
+						auto opc = arenaNew<opcode_writem<2>>(); ptrs.ptrs[i] = opc; opc->src = op.rs1.reg_ptr(); opc->src2 = get_reg_or_imm(op.rs2);
 					}
 					else if (size == 4)
 					{
-						auto opc = new opcode_writem<4>(); ptrs.ptrs[i] = opc; opc->src = op.rs1.reg_ptr(); opc->src2 = get_reg_or_imm(op.rs2);
+						auto opc = arenaNew<opcode_writem<4>>(); ptrs.ptrs[i] = opc; opc->src = op.rs1.reg_ptr(); opc->src2 = get_reg_or_imm(op.rs2);
 					}
 					else if (size == 8)
 					{
-						auto opc = new opcode_writem<8>(); ptrs.ptrs[i] = opc; opc->src = op.rs1.reg_ptr(); opc->src2 = get_reg_or_imm(op.rs2);
+						auto opc = arenaNew<opcode_writem<8>>(); ptrs.ptrs[i] = opc; opc->src = op.rs1.reg_ptr(); opc->src2 = get_reg_or_imm(op.rs2);
 					}
 				}
 			}
@@ -1834,10 +2105,15 @@ public:
 		}
 
 		//Block end opcode
+		if (fuseCompare)
+		{
+			ptrs.ptrs[i] = compileCompareBlockEnd(block, block->oplist.back());
+		}
+		else
 		{
 			opcodeExec* op;
 
-			#define CASEWS(n) case n: op = (new opcode_blockend<n>())->setup(block); break
+			#define CASEWS(n) case n: op = arenaNew<opcode_blockend<n>>()->setup(block); break
 
 			switch (block->BlockType) {
 				CASEWS(BET_StaticJump);
@@ -1892,7 +2168,7 @@ public:
 		}
 		else {
 			ERROR_LOG(DYNAREC, "IMPLEMENT CC_CALL CLASS: %s", nm.c_str());
-			ptrsg[opcode_index] = new opcodeDie();
+			ptrsg[opcode_index] = arenaNew<opcodeDie>();
 		}
 	}
 
@@ -1937,13 +2213,8 @@ void ngen_CC_Finish(shil_opcode* op)
 void ngen_ResetBlocks()
 {
 	idxnxx = 0;
-	/* FIXME issues when block check fails -> delete current block/op
-	for (int i = 0; i < CODE_ENTRY_COUNT && dispatchb[i].fnb != nullptr; i++)
-	{
-		delete dispatchb[i].fnb;
-		dispatchb[i].fnb = nullptr;
-	}
-	*/
+	chainedLink = nullptr;
+	arena.reset();
 }
 
 void ngen_HandleException(host_context_t &context)
@@ -20,6 +20,7 @@ using namespace Xbyak::util;
 #include "x64_regalloc.h"
 #include "xbyak_base.h"
 #include "oslib/oslib.h"
+#include "profiler/profiler.h"
 
 struct DynaRBI : RuntimeBlockInfo
 {
@@ -249,7 +250,10 @@ public:
 
 					int size = op.flags & 0x7f;
 					size = size == 1 ? MemSize::S8 : size == 2 ? MemSize::S16 : size == 4 ? MemSize::S32 : MemSize::S64;
-					GenCall((void (*)())MemHandlers[optimise ? MemType::Fast : MemType::Slow][size][MemOp::R], mmu_enabled());
+					if (optimise && !_nvmem_enabled())
+						genTlbMemAccess(size, MemOp::R);
+					else
+						GenCall((void (*)())MemHandlers[optimise ? MemType::Fast : MemType::Slow][size][MemOp::R], mmu_enabled());
 
 					if (size != MemSize::S64)
 						host_reg_to_shil_param(op.rd, eax);
@@ -288,7 +292,10 @@ public:
 					}
 
 					size = size == 1 ? MemSize::S8 : size == 2 ? MemSize::S16 : size == 4 ? MemSize::S32 : MemSize::S64;
-					GenCall((void (*)())MemHandlers[optimise ? MemType::Fast : MemType::Slow][size][MemOp::W], mmu_enabled());
+					if (optimise && !_nvmem_enabled())
+						genTlbMemAccess(size, MemOp::W);
+					else
+						GenCall((void (*)())MemHandlers[optimise ? MemType::Fast : MemType::Slow][size][MemOp::W], mmu_enabled());
 				}
 			}
 			break;
@@ -681,7 +688,7 @@ public:
 
 		add(ecx, SH4_TIMESLICE);
 		mov(dword[rip + &cycle_counter], ecx);
-		call(UpdateSystem_INTC);
+		call(rdv_UpdateSystem);
 		jmp(run_loop);
 
 	//end_run_loop:
@@ -824,6 +831,84 @@ private:
 			L(done);
 		}
 	}
+	// Inline memory access through the software TLB, used when the fast memory mapping isn't available.
+	// The physical address is in call_regs[0] and the data to write in call_regs[1].
+	// Reads return their result in eax (rax for 64-bit), sign-extended like the slow handlers.
+	void genTlbMemAccess(int size, int memop)
+	{
+		Xbyak::Label miss;
+		Xbyak::Label done;
+
+		mov(eax, call_regs[0]);
+		shr(eax, VMEM_TLB_PAGE_BITS);
+		mov(r9d, eax);
+		and_(r9d, VMEM_TLB_SIZE - 1);
+		mov(r10, (uintptr_t)&vmem_tlb);
+		cmp(dword[r10 + r9 * 4 + offsetof(VMemTlb, tag)], eax);
+		jne(miss, T_NEAR);
+		mov(r10, qword[r10 + r9 * 8 + offsetof(VMemTlb, ptr)]);
+		mov(r9d, call_regs[0]);
+		and_(r9d, (1 << VMEM_TLB_PAGE_BITS) - 1);
+		switch (size)
+		{
+		case MemSize::S8:
+			if (memop == MemOp::R)
+				movsx(eax, byte[r10 + r9]);
+			else
+				mov(byte[r10 + r9], call_regs[1].cvt8());
+			break;
+		case MemSize::S16:
+			if (memop == MemOp::R)
+				movsx(eax, word[r10 + r9]);
+			else
+				mov(word[r10 + r9], call_regs[1].cvt16());
+			break;
+		case MemSize::S32:
+			if (memop == MemOp::R)
+				mov(eax, dword[r10 + r9]);
+			else
+				mov(dword[r10 + r9], call_regs[1]);
+			break;
+		case MemSize::S64:
+			if (memop == MemOp::R)
+				mov(rax, qword[r10 + r9]);
+			else
+				mov(qword[r10 + r9], call_regs64[1]);
+			break;
+		}
+		jmp(done, T_NEAR);
+
+		L(miss);
+		switch (size)
+		{
+		case MemSize::S8:
+			if (memop == MemOp::R)
+				GenCall(_vmem_tlb_read<s8, s32>, mmu_enabled());
+			else
+				GenCall(_vmem_tlb_write<u8>, mmu_enabled());
+			break;
+		case MemSize::S16:
+			if (memop == MemOp::R)
+				GenCall(_vmem_tlb_read<s16, s32>, mmu_enabled());
+			else
+				GenCall(_vmem_tlb_write<u16>, mmu_enabled());
+			break;
+		case MemSize::S32:
+			if (memop == MemOp::R)
+				GenCall(_vmem_tlb_read<u32, u32>, mmu_enabled());
+			else
+				GenCall(_vmem_tlb_write<u32>, mmu_enabled());
+			break;
+		case MemSize::S64:
+			if (memop == MemOp::R)
+				GenCall(_vmem_tlb_read<u64, u64>, mmu_enabled());
+			else
+				GenCall(_vmem_tlb_write<u64>, mmu_enabled());
+			break;
+		}
+		L(done);
+	}
+
 	bool GenReadMemImmediate(const shil_opcode& op, RuntimeBlockInfo* block)
 	{
 		if (!op.rs1.is_imm())
@@ -860,7 +945,7 @@ private:
 			addr = paddr;
 		}
 		bool isram = false;
-		void* ptr = _vmem_read_const(addr, isram, size > 4 ? 4 : size);
+		void* ptr = _vmem_read_const_rec(addr, isram, size);
 
 		if (isram)
 		{
@@ -999,7 +1084,7 @@ private:
 			addr = paddr;
 		}
 		bool isram = false;
-		void* ptr = _vmem_write_const(addr, isram, size > 4 ? 4 : size);
+		void* ptr = _vmem_write_const_rec(addr, isram, size);
 
 		if (isram)
 		{
@@ -1090,37 +1175,40 @@ private:
 		if (!force_checks)
 			return;
 
-		s32 sz=block->sh4_code_size;
-		u32 sa=block->addr;
-
-		void* ptr = (void*)GetMemPtr(sa, sz > 8 ? 8 : sz);
-		if (ptr)
+		for (const BlockCheckRange& range : block->sh4_check_ranges)
 		{
-			while (sz > 0)
+			s32 sz = range.size;
+			u32 sa = range.addr;
+
+			void* ptr = (void*)GetMemPtr(sa, sz > 8 ? 8 : sz);
+			if (ptr)
 			{
-				uintptr_t uintptr = reinterpret_cast<uintptr_t>(ptr);
-				mov(rax, uintptr);
-
-				if (sz >= 8 && !(uintptr & 7)) {
-					mov(rdx, *(u64*)ptr);
-					cmp(qword[rax], rdx);
-					sz -= 8;
-					sa += 8;
-				}
-				else if (sz >= 4 && !(uintptr & 3)) {
-					mov(edx, *(u32*)ptr);
-					cmp(dword[rax], edx);
-					sz -= 4;
-					sa += 4;
-				}
-				else {
-					mov(edx, *(u16*)ptr);
-					cmp(word[rax],dx);
-					sz -= 2;
-					sa += 2;
+				while (sz > 0)
+				{
+					uintptr_t uintptr = reinterpret_cast<uintptr_t>(ptr);
+					mov(rax, uintptr);
+
+					if (sz >= 8 && !(uintptr & 7)) {
+						mov(rdx, *(u64*)ptr);
+						cmp(qword[rax], rdx);
+						sz -= 8;
+						sa += 8;
+					}
+					else if (sz >= 4 && !(uintptr & 3)) {
+						mov(edx, *(u32*)ptr);
+						cmp(dword[rax], edx);
+						sz -= 4;
+						sa += 4;
+					}
+					else {
+						mov(edx, *(u16*)ptr);
+						cmp(word[rax],dx);
+						sz -= 2;
+						sa += 2;
+					}
+					jne(reinterpret_cast<const void*>(CC_RX2RW(&ngen_blockcheckfail)));
+					ptr = (void*)GetMemPtr(sa, sz > 8 ? 8 : sz);
 				}
-				jne(reinterpret_cast<const void*>(CC_RX2RW(&ngen_blockcheckfail)));
-				ptr = (void*)GetMemPtr(sa, sz > 8 ? 8 : sz);
 			}
 		}
 	}
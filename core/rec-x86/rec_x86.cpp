@@ -532,7 +532,7 @@ bool X86Compiler::genReadMemImmediate(const shil_opcode& op, RuntimeBlockInfo* b
 	u32 size = op.flags & 0x7f;
 	u32 addr = op.rs1.imm_value();
 	bool isram = false;
-	void* ptr = _vmem_read_const(addr, isram, size > 4 ? 4 : size);
+	void* ptr = _vmem_read_const_rec(addr, isram, size);
 
 	if (isram)
 	{
@@ -645,7 +645,7 @@ bool X86Compiler::genWriteMemImmediate(const shil_opcode& op, RuntimeBlockInfo*
 	u32 size = op.flags & 0x7f;
 	u32 addr = op.rs1.imm_value();
 	bool isram = false;
-	void* ptr = _vmem_write_const(addr, isram, size > 4 ? 4 : size);
+	void* ptr = _vmem_write_const_rec(addr, isram, size);
 
 	if (isram)
 	{
@@ -737,21 +737,24 @@ void X86Compiler::checkBlock(bool smc_checks, RuntimeBlockInfo* block)
 		return;
 
 	mov(ecx, block->addr);
-	s32 sz = block->sh4_code_size;
-	u32 sa = block->addr;
-	while (sz > 0)
+	for (const BlockCheckRange& range : block->sh4_check_ranges)
 	{
-		void* p = GetMemPtr(sa, 4);
-		if (p)
+		s32 sz = range.size;
+		u32 sa = range.addr;
+		while (sz > 0)
 		{
-			if (sz == 2)
-				cmp(word[p], (u32)*(s16*)p);
-			else
-				cmp(dword[p], *(u32*)p);
-			jne((const void *)ngen_blockcheckfail);
+			void* p = GetMemPtr(sa, 4);
+			if (p)
+			{
+				if (sz == 2)
+					cmp(word[p], (u32)*(s16*)p);
+				else
+					cmp(dword[p], *(u32*)p);
+				jne((const void *)ngen_blockcheckfail);
+			}
+			sz -= 4;
+			sa += 4;
 		}
-		sz -= 4;
-		sa += 4;
 	}
 }
 
@@ -16,6 +16,8 @@
 #include "hw/holly/holly_intc.h"
 #include "reios.h"
 #include "imgread/common.h"
+#include "imgread/readahead.h"
+#include "cfg/option.h"
 
 #include <algorithm>
 
@@ -68,11 +70,20 @@ static void GDROM_HLE_ReadTOC()
 		WriteMem32(dest, toc[i]);
 }
 
+// Returns a host pointer to a range of guest RAM, or nullptr if the range isn't contiguous host memory
+static u8 *getRamPtr(u32 addr, u32 size)
+{
+	u8 *ptr = GetMemPtr(addr, size);
+	if (ptr == nullptr || (addr & RAM_MASK) + size > RAM_SIZE)
+		return nullptr;
+	return ptr;
+}
+
 template<bool virtual_addr>
 static void read_sectors_to(u32 addr, u32 sector, u32 count)
 {
 	gd_hle_state.cur_sector = sector + count - 1;
-	if (virtual_addr)
+	if (virtual_addr || config::InstantGDRomLoad)
 		gd_hle_state.xfer_end_time = 0;
 	else if (count > 5 && !config::FastGDRomLoad)
 		// Large Transfers: GD-ROM rate (approx. 1.8 MB/s)
@@ -80,13 +91,14 @@ static void read_sectors_to(u32 addr, u32 sector, u32 count)
 	else
 		// Small transfers: Max G1 bus rate: 50 MHz x 16 bits
 		gd_hle_state.xfer_end_time = sh4_sched_now64() + 5 * 2048 * 2;
-	if (!virtual_addr || !mmu_enabled())
+	const bool direct = !virtual_addr || !mmu_enabled();
+	if (direct)
 	{
-		u8 * pDst = GetMemPtr(addr, 0);
-
-		if (pDst != NULL)
+		// Sectors are read straight into guest RAM
+		u8 *pDst = getRamPtr(addr, count * 2048);
+		if (pDst != nullptr)
 		{
-			libGDR_ReadSector(pDst, sector, count, 2048);
+			readahead::read(pDst, sector, count, 2048);
 			return;
 		}
 	}
@@ -94,15 +106,24 @@ static void read_sectors_to(u32 addr, u32 sector, u32 count)
 
 	while (count > 0)
 	{
-		libGDR_ReadSector((u8 *)temp, sector, 1, sizeof(temp));
-
-		for (std::size_t i = 0; i < ARRAY_SIZE(temp); i++)
+		u8 *pDst = direct ? getRamPtr(addr, sizeof(temp)) : nullptr;
+		if (pDst != nullptr)
 		{
-			if (virtual_addr)
-				WriteMem32(addr, temp[i]);
-			else
-				WriteMem32_nommu(addr, temp[i]);
-			addr += 4;
+			readahead::read(pDst, sector, 1, sizeof(temp));
+			addr += sizeof(temp);
+		}
+		else
+		{
+			readahead::read((u8 *)temp, sector, 1, sizeof(temp));
+
+			for (std::size_t i = 0; i < ARRAY_SIZE(temp); i++)
+			{
+				if (virtual_addr)
+					WriteMem32(addr, temp[i]);
+				else
+					WriteMem32_nommu(addr, temp[i]);
+				addr += 4;
+			}
 		}
 
 		sector++;
@@ -191,10 +212,41 @@ static void multi_xfer()
 	u32 size = gd_hle_state.params[1];
 
 	size = std::min(size, gd_hle_state.multi_read_count);
+	const bool direct = dma || !mmu_enabled();
+	if (direct && gd_hle_state.multi_read_offset == 0 && size >= 2048)
+	{
+		// Whole sectors are read straight into guest RAM
+		u32 count = size / 2048;
+		u8 *ptr = getRamPtr(dest, count * 2048);
+		if (ptr != nullptr)
+		{
+			readahead::read(ptr, gd_hle_state.multi_read_sector, count, 2048);
+			gd_hle_state.multi_read_sector += count;
+			gd_hle_state.multi_read_count -= count * 2048;
+			dest += count * 2048;
+			size -= count * 2048;
+		}
+	}
 	while (size > 0)
 	{
 		u8 buf[2048];
-		libGDR_ReadSector(buf, gd_hle_state.multi_read_sector, 1, 2048);
+		readahead::read(buf, gd_hle_state.multi_read_sector, 1, 2048);
+		u32 chunk = std::min(size, 2048 - gd_hle_state.multi_read_offset);
+		u8 *ptr = direct ? getRamPtr(dest, chunk) : nullptr;
+		if (ptr != nullptr)
+		{
+			memcpy(ptr, &buf[gd_hle_state.multi_read_offset], chunk);
+			dest += chunk;
+			gd_hle_state.multi_read_offset += chunk;
+			gd_hle_state.multi_read_count -= chunk;
+			size -= chunk;
+			if (gd_hle_state.multi_read_offset == 2048)
+			{
+				gd_hle_state.multi_read_sector++;
+				gd_hle_state.multi_read_offset = 0;
+			}
+			continue;
+		}
 		while (size > 0)
 		{
 			int remaining = 2048 - gd_hle_state.multi_read_offset;
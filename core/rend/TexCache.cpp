@@ -6,7 +6,10 @@
 #include "hw/sh4/modules/mmu.h"
 
 #include <algorithm>
+#include <condition_variable>
+#include <deque>
 #include <mutex>
+#include <thread>
 #include <xxhash.h>
 
 #ifndef TARGET_NO_OPENMP
@@ -977,6 +980,91 @@ void WriteTextureToVRam(u32 width, u32 height, u8 *data, u16 *dst, u32 fb_w_ctrl
 template void WriteTextureToVRam<0, 1, 2, 3>(u32 width, u32 height, u8 *data, u16 *dst, u32 fb_w_ctrl_in, u32 linestride);
 template void WriteTextureToVRam<2, 1, 0, 3>(u32 width, u32 height, u8 *data, u16 *dst, u32 fb_w_ctrl_in, u32 linestride);
 
+//
+// Single worker thread running the render-to-texture readback jobs in order,
+// so that jobs writing to the same vram area can't be reordered.
+//
+class VramWriter
+{
+public:
+	~VramWriter() {
+		term();
+	}
+
+	void post(const std::function<void()>& job)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (!thread.joinable())
+		{
+			stopping = false;
+			thread = std::thread(&VramWriter::run, this);
+		}
+		jobs.push_back(job);
+		cond.notify_all();
+	}
+
+	void flush()
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		cond.wait(lock, [this]() { return jobs.empty() && !busy; });
+	}
+
+	void term()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (!thread.joinable())
+				return;
+			stopping = true;
+			cond.notify_all();
+		}
+		thread.join();
+	}
+
+private:
+	void run()
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		while (true)
+		{
+			cond.wait(lock, [this]() { return !jobs.empty() || stopping; });
+			if (jobs.empty())
+				break;
+			std::function<void()> job = std::move(jobs.front());
+			jobs.pop_front();
+			busy = true;
+			lock.unlock();
+			job();
+			lock.lock();
+			busy = false;
+			cond.notify_all();
+		}
+	}
+
+	std::thread thread;
+	std::mutex mutex;
+	std::condition_variable cond;
+	std::deque<std::function<void()>> jobs;
+	bool busy = false;
+	bool stopping = false;
+};
+static VramWriter vramWriter;
+
+void WriteTextureToVRamAsync(const std::function<void()>& job)
+{
+	vramWriter.post(job);
+}
+
+void FlushTextureToVRam()
+{
+	vramWriter.flush();
+}
+
+void TermTextureToVRam()
+{
+	vramWriter.term();
+}
+
 static void rend_text_invl(vram_block* bl)
 {
 	BaseTextureCacheData* tcd = (BaseTextureCacheData*)bl->userdata;
@@ -6,6 +6,7 @@
 #include <algorithm>
 #include <array>
 #include <atomic>
+#include <functional>
 #include <memory>
 #include <unordered_map>
 
@@ -746,6 +747,14 @@ template<typename Packer = RGBAPacker>
 void ReadFramebuffer(PixelBuffer<u32>& pb, int& width, int& height);
 template<int Red = 0, int Green = 1, int Blue = 2, int Alpha = 3>
 void WriteTextureToVRam(u32 width, u32 height, u8 *data, u16 *dst, u32 fb_w_ctrl = -1, u32 linestride = -1);
+// Runs a render-to-texture readback job, typically ending with WriteTextureToVRam(), on a worker thread.
+// Jobs are run in order. They must not use any emulator state that can change in the meantime.
+void WriteTextureToVRamAsync(const std::function<void()>& job);
+// Waits until all the pending jobs have written their result to vram.
+// Called at the end of render, before the sh4 can read the render-to-texture area.
+void FlushTextureToVRam();
+// Runs the pending jobs and stops the worker thread
+void TermTextureToVRam();
 
 static inline void MakeFogTexture(u8 *tex_data)
 {
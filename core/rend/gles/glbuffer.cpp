@@ -0,0 +1,207 @@
+/*
+	Copyright 2021 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#include "glbuffer.h"
+#include "gles.h"
+
+#if !defined(GLES) && !defined(GLES2) && defined(GL_MAP_PERSISTENT_BIT)
+#define HAVE_BUFFER_STORAGE
+static const GLbitfield PersistentFlags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+#endif
+
+GlStreamBuffer::Mode GlStreamBuffer::getBestMode()
+{
+#ifdef HAVE_BUFFER_STORAGE
+	if (gl.buffer_storage_supported)
+		return Persistent;
+#endif
+#ifndef GLES2
+	if (gl.gl_major >= 3)
+		return MapRange;
+#endif
+	return Copy;
+}
+
+void GlStreamBuffer::init(GLenum target, Mode mode)
+{
+	this->target = target;
+	this->mode = mode;
+	current = 0;
+	if (mode != Persistent)
+		glGenBuffers(1, &slots[0].name);
+}
+
+void GlStreamBuffer::term()
+{
+	for (Slot& slot : slots)
+		release(slot);
+	staging.clear();
+	staging.shrink_to_fit();
+}
+
+void GlStreamBuffer::allocate(Slot& slot, size_t size)
+{
+	size_t newSize = 256 * 1024;
+	while (newSize < size)
+		newSize *= 2;
+	if (mode == Persistent)
+	{
+#ifdef HAVE_BUFFER_STORAGE
+		glGenBuffers(1, &slot.name);
+		glBindBuffer(target, slot.name);
+		glBufferStorage(target, newSize, nullptr, PersistentFlags);
+		slot.mapped = glMapBufferRange(target, 0, newSize, PersistentFlags);
+		glCheck();
+		if (slot.mapped == nullptr)
+		{
+			// Shouldn't happen but keep going with a regular buffer
+			WARN_LOG(RENDERER, "Persistent buffer mapping failed. Using glMapBufferRange");
+			glDeleteBuffers(1, &slot.name);
+			slot.name = 0;
+			for (Slot& other : slots)
+				release(other);
+			mode = MapRange;
+			glGenBuffers(1, &slots[0].name);
+			current = 0;
+			allocate(slots[0], size);
+			return;
+		}
+#endif
+	}
+	else
+	{
+		glBindBuffer(target, slot.name);
+		glBufferData(target, newSize, nullptr, GL_STREAM_DRAW);
+	}
+	slot.size = newSize;
+}
+
+void GlStreamBuffer::release(Slot& slot)
+{
+#ifndef GLES2
+	if (slot.fence != nullptr)
+	{
+		glDeleteSync(slot.fence);
+		slot.fence = nullptr;
+	}
+#endif
+	if (slot.name != 0)
+	{
+#ifndef GLES2
+		if (slot.mapped != nullptr)
+		{
+			glBindBuffer(target, slot.name);
+			glUnmapBuffer(target);
+		}
+#endif
+		glDeleteBuffers(1, &slot.name);
+	}
+	slot.name = 0;
+	slot.mapped = nullptr;
+	slot.size = 0;
+}
+
+void *GlStreamBuffer::map(size_t size)
+{
+	mappedSize = size;
+	mappedStaging = false;
+#ifdef HAVE_BUFFER_STORAGE
+	if (mode == Persistent && size > 0)
+	{
+		// All the commands using the current buffer have been issued
+		Slot& previous = slots[current];
+		if (previous.name != 0 && previous.fence == nullptr)
+			previous.fence = (GLsync)glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		current = (current + 1) % RingSize;
+		Slot& slot = slots[current];
+		if (slot.fence != nullptr)
+		{
+			// Wait until the GPU is done with this buffer. Shouldn't happen unless it's more than 2 frames behind.
+			glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000ull);
+			glDeleteSync(slot.fence);
+			slot.fence = nullptr;
+		}
+		if (slot.size < size)
+		{
+			release(slot);
+			allocate(slot, size);
+		}
+		if (mode == Persistent)
+		{
+			glBindBuffer(target, slot.name);
+			return slot.mapped;
+		}
+	}
+#endif
+#ifndef GLES2
+	if (mode == MapRange && size > 0)
+	{
+		Slot& slot = slots[0];
+		if (slot.size < size)
+			allocate(slot, size);
+		else
+			glBindBuffer(target, slot.name);
+		// Orphan the previous content so that the driver doesn't have to wait for the GPU
+		void *p = glMapBufferRange(target, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+		if (p != nullptr)
+		{
+			slot.mapped = p;
+			return p;
+		}
+	}
+#endif
+	mappedStaging = true;
+	if (staging.size() < size)
+		staging.resize(size);
+	return staging.data();
+}
+
+void GlStreamBuffer::unmap()
+{
+	Slot& slot = slots[current];
+	if (mappedSize == 0)
+	{
+		// Nothing to upload
+		glBindBuffer(target, slot.name);
+	}
+	else if (mappedStaging)
+	{
+		if (slot.name == 0)
+			glGenBuffers(1, &slot.name);
+		glBindBuffer(target, slot.name);
+		glBufferData(target, mappedSize, staging.data(), GL_STREAM_DRAW);
+		// The buffer store has been reallocated
+		slot.size = 0;
+	}
+#ifndef GLES2
+	else if (mode == MapRange)
+	{
+		glUnmapBuffer(target);
+		slot.mapped = nullptr;
+	}
+#endif
+	glCheck();
+}
+
+void GlStreamBuffer::upload(const void *data, size_t size)
+{
+	void *p = map(size);
+	if (size > 0)
+		memcpy(p, data, size);
+	unmap();
+}
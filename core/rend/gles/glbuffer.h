@@ -0,0 +1,72 @@
+/*
+	Copyright 2021 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#pragma once
+#include "wsi/gl_context.h"
+
+#include <vector>
+
+//
+// Buffer object whose content is fully replaced at least once per frame.
+// Depending on what the driver supports, data is written:
+// - into a ring of persistently mapped buffers, each protected by a fence (GL_ARB_buffer_storage)
+// - into an orphaned buffer mapped with glMapBufferRange
+// - into a host staging area then copied with glBufferData
+//
+class GlStreamBuffer
+{
+public:
+	enum Mode { Copy, MapRange, Persistent };
+
+	void init(GLenum target, Mode mode);
+	void term();
+
+	// Binds the next buffer and returns a pointer to write size bytes into it
+	void *map(size_t size);
+	// Must be called once the data has been written
+	void unmap();
+	// Allocates, copies and binds
+	void upload(const void *data, size_t size);
+
+	GLuint getName() const { return slots[current].name; }
+
+	static Mode getBestMode();
+
+private:
+	static constexpr int RingSize = 3;
+
+	struct Slot
+	{
+		GLuint name = 0;
+		size_t size = 0;
+		void *mapped = nullptr;
+#ifndef GLES2
+		GLsync fence = nullptr;
+#endif
+	};
+	void allocate(Slot& slot, size_t size);
+	void release(Slot& slot);
+
+	GLenum target = 0;
+	Mode mode = Copy;
+	Slot slots[RingSize];
+	int current = 0;
+	size_t mappedSize = 0;
+	bool mappedStaging = false;
+	std::vector<u8> staging;
+};
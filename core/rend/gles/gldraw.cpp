@@ -270,41 +270,60 @@ void DrawList(const List<PolyParam>& gply, int first, int count)
 	}
 }
 
-static std::vector<SortTrigDrawParam> pidx_sort;
+// Sorted triangles of each render pass
+static std::vector<std::vector<SortTrigDrawParam>> sortedPolys;
 
-static void SortTriangles(int first, int count)
+// Sorts the triangles of all auto-sorted render passes and uploads their indices at once,
+// so that the index buffer is mapped only once per frame
+static void SortTriangles()
 {
-	std::vector<u32> vidx_sort;
-	GenSorted(first, count, pidx_sort, vidx_sort);
+	sortedPolys.resize(pvrrc.render_passes.used());
+	static std::vector<u32> vidx_sort;
+	static std::vector<u32> sortedIndexes;
+	sortedIndexes.clear();
 
-	//Upload to GPU if needed
-	if (!pidx_sort.empty())
+	RenderPass previous_pass = {};
+	for (int render_pass = 0; render_pass < pvrrc.render_passes.used(); render_pass++)
 	{
-		//Bind and upload sorted index buffer
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gl.vbo.idxs2); glCheck();
-		if (gl.index_type == GL_UNSIGNED_SHORT)
+		const RenderPass& current_pass = pvrrc.render_passes.head()[render_pass];
+		std::vector<SortTrigDrawParam>& pidx_sort = sortedPolys[render_pass];
+		pidx_sort.clear();
+		if (current_pass.autosort)
 		{
-			static bool overrun;
-			static List<u16> short_vidx;
-			if (short_vidx.daty != NULL)
-				short_vidx.Free();
-			short_vidx.Init(vidx_sort.size(), &overrun, NULL);
-			for (size_t i = 0; i < vidx_sort.size(); i++)
-				*(short_vidx.Append()) = vidx_sort[i];
-			glBufferData(GL_ELEMENT_ARRAY_BUFFER, short_vidx.bytes(), short_vidx.head(), GL_STREAM_DRAW);
+			GenSorted(previous_pass.tr_count, current_pass.tr_count - previous_pass.tr_count, pidx_sort, vidx_sort);
+			if (!pidx_sort.empty())
+			{
+				for (auto& poly : pidx_sort)
+					poly.first += sortedIndexes.size();
+				sortedIndexes.insert(sortedIndexes.end(), vidx_sort.begin(), vidx_sort.end());
+			}
 		}
-		else
-			glBufferData(GL_ELEMENT_ARRAY_BUFFER, vidx_sort.size() * sizeof(u32), &vidx_sort[0], GL_STREAM_DRAW);
-		glCheck();
+		previous_pass = current_pass;
 	}
+	if (sortedIndexes.empty())
+		return;
+
+	//Upload to GPU
+	if (gl.index_type == GL_UNSIGNED_SHORT)
+	{
+		u16 *p = (u16 *)gl.vbo.idxs2.map(sortedIndexes.size() * sizeof(u16));
+		for (u32 idx : sortedIndexes)
+			*p++ = idx;
+		gl.vbo.idxs2.unmap();
+	}
+	else
+		gl.vbo.idxs2.upload(&sortedIndexes[0], sortedIndexes.size() * sizeof(u32));
+	// Re-bind the main index buffer
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gl.vbo.idxs.getName());
 }
 
-void DrawSorted(bool multipass)
+static void DrawSorted(const std::vector<SortTrigDrawParam>& pidx_sort, bool multipass)
 {
 	//if any drawing commands, draw them
 	if (!pidx_sort.empty())
 	{
 		u32 count=pidx_sort.size();
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gl.vbo.idxs2.getName());
 		
 		{
 			//set some 'global' modes for all primitives
@@ -373,7 +392,7 @@ void DrawSorted(bool multipass)
 			}
 		}
 		// Re-bind the previous index buffer for subsequent render passes
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gl.vbo.idxs);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gl.vbo.idxs.getName());
 	}
 }
 
@@ -480,18 +499,21 @@ void SetupMainVBO()
 	if (gl.vbo.mainVAO != 0)
 	{
 		glBindVertexArray(gl.vbo.mainVAO);
-		glBindBuffer(GL_ARRAY_BUFFER, gl.vbo.geometry);
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gl.vbo.idxs);
-		return;
+		glBindBuffer(GL_ARRAY_BUFFER, gl.vbo.geometry.getName());
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gl.vbo.idxs.getName());
+		// The vertex buffer changes every frame when using a buffer ring
+		if (gl.vbo.mainVAOBuffer == gl.vbo.geometry.getName())
+			return;
 	}
-	if (gl.gl_major >= 3)
+	else if (gl.gl_major >= 3)
 	{
 		glGenVertexArrays(1, &gl.vbo.mainVAO);
 		glBindVertexArray(gl.vbo.mainVAO);
 	}
 #endif
-	glBindBuffer(GL_ARRAY_BUFFER, gl.vbo.geometry);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gl.vbo.idxs);
+	glBindBuffer(GL_ARRAY_BUFFER, gl.vbo.geometry.getName());
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gl.vbo.idxs.getName());
+	gl.vbo.mainVAOBuffer = gl.vbo.geometry.getName();
 
 	//setup vertex buffers attrib pointers
 	glEnableVertexAttribArray(VERTEX_POS_ARRAY);
@@ -514,18 +536,20 @@ static void SetupModvolVBO()
 	if (gl.vbo.modvolVAO != 0)
 	{
 		glBindVertexArray(gl.vbo.modvolVAO);
-		glBindBuffer(GL_ARRAY_BUFFER, gl.vbo.modvols);
+		glBindBuffer(GL_ARRAY_BUFFER, gl.vbo.modvols.getName());
 		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-		return;
+		if (gl.vbo.modvolVAOBuffer == gl.vbo.modvols.getName())
+			return;
 	}
-	if (gl.gl_major >= 3)
+	else if (gl.gl_major >= 3)
 	{
 		glGenVertexArrays(1, &gl.vbo.modvolVAO);
 		glBindVertexArray(gl.vbo.modvolVAO);
 	}
 #endif
-	glBindBuffer(GL_ARRAY_BUFFER, gl.vbo.modvols); glCheck();
+	glBindBuffer(GL_ARRAY_BUFFER, gl.vbo.modvols.getName()); glCheck();
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	gl.vbo.modvolVAOBuffer = gl.vbo.modvols.getName();
 
 	//setup vertex buffers attrib pointers
 	glEnableVertexAttribArray(VERTEX_POS_ARRAY);
@@ -616,6 +640,8 @@ void DrawModVols(int first, int count)
 void DrawStrips()
 {
 	SetupMainVBO();
+	if (!config::PerStripSorting)
+		SortTriangles();
 	//Draw the strips !
 
 	//We use sampler 0
@@ -651,8 +677,7 @@ void DrawStrips()
             {
 				if (!config::PerStripSorting)
 				{
-					SortTriangles(previous_pass.tr_count, current_pass.tr_count - previous_pass.tr_count);
-					DrawSorted(render_pass < pvrrc.render_passes.used() - 1);
+					DrawSorted(sortedPolys[render_pass], render_pass < pvrrc.render_passes.used() - 1);
 				}
 				else
 				{
@@ -8,12 +8,14 @@
 #include "vmu_xhair.h"
 #endif
 #include "rend/osd.h"
+#include "rend/shader_cache.h"
 #include "rend/TexCache.h"
 #include "rend/transform_matrix.h"
 #include "wsi/gl_context.h"
 #include "emulator.h"
 
 #include <cmath>
+#include <xxhash.h>
 
 #ifdef GLES
 #ifndef GL_RED
@@ -367,7 +369,13 @@ void do_swap_automation()
 
 #endif
 
-static void gl_delete_shaders()
+static ShaderCache programCache(".glprog");
+// Not used by the OIT renderer
+static bool programCacheEnabled;
+
+static void saveProgramCache();
+
+static void deletePipelineShaders()
 {
 	for (const auto& it : gl.shaders)
 	{
@@ -375,6 +383,11 @@ static void gl_delete_shaders()
 			glcache.DeleteProgram(it.second.program);
 	}
 	gl.shaders.clear();
+}
+
+static void gl_delete_shaders()
+{
+	deletePipelineShaders();
 	glcache.DeleteProgram(gl.modvol_shader.program);
 	gl.modvol_shader.program = 0;
 }
@@ -418,16 +431,42 @@ static void gles_term()
 	glDeleteVertexArrays(1, &gl.vbo.modvolVAO);
 	gl.vbo.modvolVAO = 0;
 #endif
-	glDeleteBuffers(1, &gl.vbo.geometry);
-	gl.vbo.geometry = 0;
-	glDeleteBuffers(1, &gl.vbo.modvols);
-	glDeleteBuffers(1, &gl.vbo.idxs);
-	glDeleteBuffers(1, &gl.vbo.idxs2);
+	gl.vbo.geometry.term();
+	gl.vbo.modvols.term();
+	gl.vbo.idxs.term();
+	gl.vbo.idxs2.term();
+	gl.vbo.mainVAOBuffer = 0;
+	gl.vbo.modvolVAOBuffer = 0;
+	gl.vbo.initialized = false;
 	termGLCommon();
 
+	saveProgramCache();
+	programCacheEnabled = false;
 	gl_delete_shaders();
 }
 
+#if !defined(GLES2)
+static bool isExtensionSupported(const char *name)
+{
+	const char *extensions = (const char *)glGetString(GL_EXTENSIONS);
+	// glGetString(GL_EXTENSIONS) is deprecated and might return NULL in core contexts.
+	// In that case, use glGetStringi instead
+	if (extensions == nullptr)
+	{
+		GLint n = 0;
+		glGetIntegerv(GL_NUM_EXTENSIONS, &n);
+		for (GLint i = 0; i < n; i++)
+		{
+			const char* extension = (const char *)glGetStringi(GL_EXTENSIONS, i);
+			if (!strcmp(extension, name))
+				return true;
+		}
+		return false;
+	}
+	return strstr(extensions, name) != nullptr;
+}
+#endif
+
 void findGLVersion()
 {
 	gl.index_type = GL_UNSIGNED_INT;
@@ -484,31 +523,27 @@ void findGLVersion()
 #if !defined(GLES2)
 	if (gl.gl_major >= 3)
 	{
-		bool anisotropicExtension = false;
-		const char *extensions = (const char *)glGetString(GL_EXTENSIONS);
-		// glGetString(GL_EXTENSIONS) is deprecated and might return NULL in core contexts.
-		// In that case, use glGetStringi instead
-		if (extensions == nullptr)
-		{
-			GLint n = 0;
-			glGetIntegerv(GL_NUM_EXTENSIONS, &n);
-			for (GLint i = 0; i < n; i++)
-			{
-				const char* extension = (const char *)glGetStringi(GL_EXTENSIONS, i);
-				if (!strcmp(extension, "GL_EXT_texture_filter_anisotropic"))
-				{
-					anisotropicExtension = true;
-					break;
-				}
-			}
-		}
-		else if (strstr(extensions, "GL_EXT_texture_filter_anisotropic") != nullptr)
-			anisotropicExtension = true;
+		bool anisotropicExtension = isExtensionSupported("GL_EXT_texture_filter_anisotropic");
 		if (anisotropicExtension)
 			glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY, &gl.max_anisotropy);
 	}
 #endif
 	gl.mesa_nouveau = strstr((const char *)glGetString(GL_VERSION), "Mesa") != nullptr && !strcmp((const char *)glGetString(GL_VENDOR), "nouveau");
+	gl.program_binary_supported = false;
+#if !defined(GLES2)
+	if ((gl.is_gles && gl.gl_major >= 3) || gl.gl_major > 4 || (gl.gl_major == 4 && gl.gl_minor >= 1))
+	{
+		GLint formats = 0;
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+		gl.program_binary_supported = formats > 0;
+	}
+#endif
+	gl.buffer_storage_supported = false;
+#if !defined(GLES2)
+	if (!gl.is_gles && gl.gl_major >= 3)
+		gl.buffer_storage_supported = gl.gl_major > 4 || (gl.gl_major == 4 && gl.gl_minor >= 4)
+				|| isExtensionSupported("GL_ARB_buffer_storage");
+#endif
 	NOTICE_LOG(RENDERER, "Open GL%s version %d.%d", gl.is_gles ? "ES" : "", gl.gl_major, gl.gl_minor);
 	while (glGetError() != GL_NO_ERROR)
 		;
@@ -565,6 +600,10 @@ GLuint gl_CompileAndLink(const char* VertexShader, const char* FragmentShader)
 	if (!gl.is_gles && gl.gl_major >= 3)
 		glBindFragDataLocation(program, 0, "FragColor");
 #endif
+#ifndef GLES2
+	if (gl.program_binary_supported)
+		glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+#endif
 
 	glLinkProgram(program);
 
@@ -602,6 +641,7 @@ GLuint gl_CompileAndLink(const char* VertexShader, const char* FragmentShader)
 	return program;
 }
 
+
 PipelineShader *GetProgram(bool cp_AlphaTest, bool pp_InsideClipping,
 		bool pp_Texture, bool pp_UseAlpha, bool pp_IgnoreTexA, u32 pp_ShadInstr, bool pp_Offset,
 		u32 pp_FogCtrl, bool pp_Gouraud, bool pp_BumpMap, bool fog_clamping, bool trilinear,
@@ -640,11 +680,31 @@ PipelineShader *GetProgram(bool cp_AlphaTest, bool pp_InsideClipping,
 		shader->trilinear = trilinear;
 		shader->palette = palette;
 		CompilePipelineShader(shader);
+		programCache.add(rv);
+		programCache.firstUseCompiles++;
 	}
 
 	return shader;
 }
 
+// Inverse of the key computation in GetProgram()
+static void decodeProgramKey(u32 key, PipelineShader *s)
+{
+	s->palette = key & 1;
+	s->trilinear = (key >> 1) & 1;
+	s->fog_clamping = (key >> 2) & 1;
+	s->pp_BumpMap = (key >> 3) & 1;
+	s->pp_Gouraud = (key >> 4) & 1;
+	s->pp_FogCtrl = (key >> 5) & 3;
+	s->pp_Offset = (key >> 7) & 1;
+	s->pp_ShadInstr = (key >> 8) & 3;
+	s->pp_IgnoreTexA = (key >> 10) & 1;
+	s->pp_UseAlpha = (key >> 11) & 1;
+	s->pp_Texture = (key >> 12) & 1;
+	s->cp_AlphaTest = (key >> 13) & 1;
+	s->pp_InsideClipping = (key >> 14) & 1;
+}
+
 class VertexSource : public OpenGlSource
 {
 public:
@@ -682,6 +742,8 @@ public:
 	}
 };
 
+static bool SetupPipelineShader(PipelineShader* s);
+
 bool CompilePipelineShader(PipelineShader* s)
 {
 	VertexSource vertexSource(s->pp_Gouraud);
@@ -689,6 +751,35 @@ bool CompilePipelineShader(PipelineShader* s)
 
 	s->program = gl_CompileAndLink(vertexSource.generate().c_str(), fragmentSource.generate().c_str());
 
+	return SetupPipelineShader(s);
+}
+
+static bool LoadPipelineShaderBinary(PipelineShader* s, const ShaderCache::Entry& entry)
+{
+#ifndef GLES2
+	if (!gl.program_binary_supported || entry.data.empty())
+		return false;
+	GLuint program = glCreateProgram();
+	glProgramBinary(program, entry.format, &entry.data[0], (GLsizei)entry.data.size());
+	GLint result = GL_FALSE;
+	glGetProgramiv(program, GL_LINK_STATUS, &result);
+	if (result != GL_TRUE)
+	{
+		// Driver or GPU changed
+		glDeleteProgram(program);
+		return false;
+	}
+	glcache.UseProgram(program);
+	s->program = program;
+
+	return SetupPipelineShader(s);
+#else
+	return false;
+#endif
+}
+
+static bool SetupPipelineShader(PipelineShader* s)
+{
 	//setup texture 0 as the input for the shader
 	GLint gu = glGetUniformLocation(s->program, "tex");
 	if (s->pp_Texture==1)
@@ -745,6 +836,78 @@ bool CompilePipelineShader(PipelineShader* s)
 	return glIsProgram(s->program)==GL_TRUE;
 }
 
+// Program binaries can only be reused with the same driver and shader sources
+static u32 programBinaryTag()
+{
+	std::string id = (const char *)glGetString(GL_VENDOR);
+	id += (const char *)glGetString(GL_RENDERER);
+	id += (const char *)glGetString(GL_VERSION);
+	// The constants depend on the program key only, so any program covers all the source templates
+	PipelineShader shader{};
+	id += VertexSource(shader.pp_Gouraud).generate();
+	id += FragmentShaderSource(&shader).generate();
+
+	return XXH32(id.data(), id.size(), 7);
+}
+
+// Compile the programs used the last time the current game was run
+static void precompilePrograms()
+{
+	programCache.load();
+	u32 count = 0;
+	for (const auto& it : programCache.getEntries())
+	{
+		PipelineShader& shader = gl.shaders[it.first];
+		if (shader.program != 0)
+			continue;
+		decodeProgramKey(it.first, &shader);
+		if (!LoadPipelineShaderBinary(&shader, it.second))
+			CompilePipelineShader(&shader);
+		count++;
+	}
+	programCache.precompiled += count;
+	if (count > 0)
+		INFO_LOG(RENDERER, "%d shader programs precompiled", count);
+}
+
+// Save the binaries of all programs used by the current game
+static void saveProgramCache()
+{
+#ifndef GLES2
+	if (gl.program_binary_supported)
+	{
+		const auto& entries = programCache.getEntries();
+		for (const auto& it : gl.shaders)
+		{
+			if (it.second.program == 0)
+				continue;
+			auto entry = entries.find(it.first);
+			if (entry != entries.end() && !entry->second.data.empty())
+				continue;
+			GLint length = 0;
+			glGetProgramiv(it.second.program, GL_PROGRAM_BINARY_LENGTH, &length);
+			if (length <= 0)
+				continue;
+			std::vector<u8> data(length);
+			GLenum format;
+			glGetProgramBinary(it.second.program, length, &length, &format, &data[0]);
+			data.resize(length);
+			programCache.setData(it.first, format, std::move(data));
+		}
+	}
+#endif
+	programCache.save();
+}
+
+// Called when a new game is started
+static void reloadProgramCache()
+{
+	saveProgramCache();
+	// Programs used by the previous game must be recorded again if this one uses them
+	deletePipelineShaders();
+	precompilePrograms();
+}
+
 static void SetupOSDVBO()
 {
 #ifndef GLES2
@@ -848,7 +1011,7 @@ static void create_modvol_shader()
 
 bool gl_create_resources()
 {
-	if (gl.vbo.geometry != 0)
+	if (gl.vbo.initialized)
 		// Assume the resources have already been created
 		return true;
 
@@ -859,10 +1022,14 @@ bool gl_create_resources()
 		verify(glGenVertexArrays != nullptr);
 
 	//create vbos
-	glGenBuffers(1, &gl.vbo.geometry);
-	glGenBuffers(1, &gl.vbo.modvols);
-	glGenBuffers(1, &gl.vbo.idxs);
-	glGenBuffers(1, &gl.vbo.idxs2);
+	GlStreamBuffer::Mode mode = GlStreamBuffer::getBestMode();
+	gl.vbo.geometry.init(GL_ARRAY_BUFFER, mode);
+	gl.vbo.modvols.init(GL_ARRAY_BUFFER, mode);
+	gl.vbo.idxs.init(GL_ELEMENT_ARRAY_BUFFER, mode);
+	gl.vbo.idxs2.init(GL_ELEMENT_ARRAY_BUFFER, mode);
+	gl.vbo.initialized = true;
+	static const char *modeNames[] = { "glBufferData", "glMapBufferRange", "persistent mapping" };
+	INFO_LOG(RENDERER, "Vertex buffer uploads using %s", modeNames[mode]);
 
 	create_modvol_shader();
 	initQuad();
@@ -910,6 +1077,9 @@ bool gles_init()
 
 	if (!gl_create_resources())
 		return false;
+	programCache.setBinaryTag(programBinaryTag());
+	precompilePrograms();
+	programCacheEnabled = true;
 
 #if 0
 	glEnable(GL_DEBUG_OUTPUT);
@@ -1078,6 +1248,11 @@ void OSD_DRAW(bool clear_screen)
 
 bool ProcessFrame(TA_context* ctx)
 {
+	if (programCacheEnabled && programCache.isStale())
+		reloadProgramCache();
+	// Fetch the last render to texture result, which should be ready by now
+	if (gl.rtt.texAddress != ~0u)
+		readAsyncPixelBuffer(gl.rtt.texAddress);
 	if (KillTex)
 		TexCache.Clear();
 	TexCache.Cleanup();
@@ -1099,18 +1274,13 @@ static void upload_vertex_indices()
 {
 	if (gl.index_type == GL_UNSIGNED_SHORT)
 	{
-		static bool overrun;
-		static List<u16> short_idx;
-		if (short_idx.daty != NULL)
-			short_idx.Free();
-		short_idx.Init(pvrrc.idx.used(), &overrun, NULL);
-		for (u32 *p = pvrrc.idx.head(); p < pvrrc.idx.LastPtr(0); p++)
-			*(short_idx.Append()) = *p;
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER, short_idx.bytes(), short_idx.head(), GL_STREAM_DRAW);
+		u16 *p = (u16 *)gl.vbo.idxs.map(pvrrc.idx.used() * sizeof(u16));
+		for (u32 *idx = pvrrc.idx.head(); idx < pvrrc.idx.LastPtr(0); idx++)
+			*p++ = *idx;
+		gl.vbo.idxs.unmap();
 	}
 	else
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER,pvrrc.idx.bytes(),pvrrc.idx.head(),GL_STREAM_DRAW);
-	glCheck();
+		gl.vbo.idxs.upload(pvrrc.idx.head(), pvrrc.idx.bytes());
 }
 
 bool RenderFrame(int width, int height)
@@ -1241,19 +1411,15 @@ bool RenderFrame(int width, int height)
 	if (!pvrrc.isRenderFramebuffer)
 	{
 		//Main VBO
-		glBindBuffer(GL_ARRAY_BUFFER, gl.vbo.geometry); glCheck();
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gl.vbo.idxs); glCheck();
-
-		glBufferData(GL_ARRAY_BUFFER,pvrrc.verts.bytes(),pvrrc.verts.head(),GL_STREAM_DRAW); glCheck();
-
+		double startTime = os_GetSeconds();
+		gl.vbo.geometry.upload(pvrrc.verts.head(), pvrrc.verts.bytes());
 		upload_vertex_indices();
 
 		//Modvol VBO
 		if (pvrrc.modtrig.used())
-		{
-			glBindBuffer(GL_ARRAY_BUFFER, gl.vbo.modvols); glCheck();
-			glBufferData(GL_ARRAY_BUFFER,pvrrc.modtrig.bytes(),pvrrc.modtrig.head(),GL_STREAM_DRAW); glCheck();
-		}
+			gl.vbo.modvols.upload(pvrrc.modtrig.head(), pvrrc.modtrig.bytes());
+		DEBUG_LOG(RENDERER, "Vertex upload: %d KB in %.3f ms",
+				(pvrrc.verts.bytes() + pvrrc.idx.bytes() + pvrrc.modtrig.bytes()) / 1024, (os_GetSeconds() - startTime) * 1000.0);
 
 		if (!wide_screen_on)
 		{
@@ -4,6 +4,7 @@
 #include "rend/TexCache.h"
 #include "wsi/gl_context.h"
 #include "glcache.h"
+#include "glbuffer.h"
 #include "postprocess.h"
 #include "rend/shader_util.h"
 
@@ -92,9 +93,13 @@ struct gl_ctx
 
 	struct
 	{
-		GLuint geometry,modvols,idxs,idxs2;
+		GlStreamBuffer geometry, modvols, idxs, idxs2;
 		GLuint mainVAO;
 		GLuint modvolVAO;
+		// Buffers the VAO attribute pointers refer to
+		GLuint mainVAOBuffer;
+		GLuint modvolVAOBuffer;
+		bool initialized;
 	} vbo;
 
 	struct
@@ -135,6 +140,8 @@ struct gl_ctx
 	bool highp_float_supported;
 	float max_anisotropy;
 	bool mesa_nouveau;
+	bool program_binary_supported;
+	bool buffer_storage_supported;
 
 	size_t get_index_size() { return index_type == GL_UNSIGNED_INT ? sizeof(u32) : sizeof(u16); }
 };
@@ -165,6 +172,7 @@ void SetMVS_Mode(ModifierVolumeMode mv_mode, ISP_Modvol ispc);
 
 GLuint BindRTT(bool withDepthBuffer = true);
 void ReadRTTBuffer();
+void readAsyncPixelBuffer(u32 addr);
 void RenderFramebuffer();
 void DrawFramebuffer();
 GLuint init_output_framebuffer(int width, int height);
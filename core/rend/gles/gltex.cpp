@@ -8,7 +8,6 @@
 
 GlTextureCache TexCache;
 
-static void readAsyncPixelBuffer(u32 addr);
 
 void TextureCacheData::UploadToGPU(int width, int height, u8 *temp_tex_buffer, bool mipmapped, bool mipmapsIncluded)
 {
@@ -371,7 +370,7 @@ void ReadRTTBuffer()
 	glBindFramebuffer(GL_FRAMEBUFFER, gl.ofbo.origFbo);
 }
 
-static void readAsyncPixelBuffer(u32 addr)
+void readAsyncPixelBuffer(u32 addr)
 {
 #ifndef GLES2
 	if (!config::RenderToTextureBuffer || gl.rtt.pbo == 0)
@@ -1580,6 +1580,8 @@ static void gui_display_settings()
 			OptionCheckbox("禁用音频", config::DisableSound, "禁用模拟器音频输出");
 			OptionCheckbox("启用 DSP", config::DSPEnabled,
 					"启用Dreamcast数字音频处理器. 仅推荐在高配置平台上使用");
+			OptionCheckbox("多线程音频", config::ThreadedAica,
+					"在独立线程上运行ARM7, 声音生成器和DSP. 适用于多核处理器");
 			if (OptionSlider("音量级别", config::AudioVolume, 0, 100, "调整模拟器的音频级别"))
 			{
 				config::AudioVolume.calcDbPower();
@@ -1707,6 +1709,7 @@ static void gui_display_settings()
 		    	OptionCheckbox("安全模式", config::DynarecSafeMode,
 		    			"不优化整数算法. 不推荐");
 		    	OptionCheckbox("闲置跳过", config::DynarecIdleSkip, "跳过等待循环. 推荐");
+		    	OptionCheckbox("超级块", config::DynarecSuperblocks, "将频繁执行的代码重新编译为更大的块. 推荐");
 		    }
 	    	ImGui::Spacing();
 		    header("网络");
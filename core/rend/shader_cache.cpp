@@ -0,0 +1,134 @@
+/*
+	Copyright 2021 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#include "shader_cache.h"
+#include "oslib/oslib.h"
+#include "cfg/option.h"
+
+static const u32 CacheMagic = 0x43534c46;	// FLSC
+// Must be increased when the meaning of shader keys or the file format changes
+static const u32 CacheVersion = 2;
+// Sanity limits when loading
+static const u32 MaxEntries = 65536;
+static const u32 MaxEntrySize = 16 * 1024 * 1024;
+
+void ShaderCache::load()
+{
+	imagePath = settings.imgread.ImagePath;
+	std::string newPath = config::ShaderPrecompile ? hostfs::getShaderCachePath(suffix) : "";
+	if (newPath == path)
+		return;
+	save();
+	entries.clear();
+	dirty = false;
+	path = newPath;
+	if (path.empty())
+		return;
+
+	FILE *f = nowide::fopen(path.c_str(), "rb");
+	if (f == nullptr)
+		return;
+	std::fseek(f, 0, SEEK_END);
+	long fileSize = std::ftell(f);
+	std::fseek(f, 0, SEEK_SET);
+	u32 header[4];	// magic, version, binary tag, entry count
+	if (fileSize < (long)sizeof(header) || std::fread(header, sizeof(header), 1, f) != 1
+			|| header[0] != CacheMagic || header[1] != CacheVersion)
+	{
+		WARN_LOG(RENDERER, "Ignoring invalid or obsolete shader cache %s", path.c_str());
+		std::fclose(f);
+		return;
+	}
+	size_t remaining = fileSize - sizeof(header);
+	// Binaries built by another driver or from other shader sources
+	const bool keepData = header[2] == binaryTag;
+	bool valid = header[3] <= MaxEntries;
+	for (u32 i = 0; valid && i < header[3]; i++)
+	{
+		u32 entryHeader[3];	// key, format, size
+		if (remaining < sizeof(entryHeader) || std::fread(entryHeader, sizeof(entryHeader), 1, f) != 1)
+		{
+			valid = false;
+			break;
+		}
+		remaining -= sizeof(entryHeader);
+		if (entryHeader[2] > MaxEntrySize || entryHeader[2] > remaining)
+		{
+			valid = false;
+			break;
+		}
+		remaining -= entryHeader[2];
+		Entry& entry = entries[entryHeader[0]];
+		if (!keepData)
+		{
+			if (entryHeader[2] != 0)
+				dirty = true;
+			if (std::fseek(f, entryHeader[2], SEEK_CUR) != 0)
+				valid = false;
+			continue;
+		}
+		entry.format = entryHeader[1];
+		entry.data.resize(entryHeader[2]);
+		if (!entry.data.empty() && std::fread(&entry.data[0], 1, entry.data.size(), f) != entry.data.size())
+			valid = false;
+	}
+	std::fclose(f);
+	if (!valid)
+	{
+		WARN_LOG(RENDERER, "Ignoring corrupted shader cache %s", path.c_str());
+		entries.clear();
+		dirty = false;
+		return;
+	}
+	if (dirty)
+		INFO_LOG(RENDERER, "Shader cache %s: driver or shaders changed, binaries dropped", path.c_str());
+	INFO_LOG(RENDERER, "Shader cache loaded from %s: %d entries", path.c_str(), (int)entries.size());
+}
+
+void ShaderCache::save()
+{
+	if (!dirty || path.empty())
+		return;
+	dirty = false;
+	FILE *f = nowide::fopen(path.c_str(), "wb");
+	if (f == nullptr)
+	{
+		WARN_LOG(RENDERER, "Can't save shader cache to %s", path.c_str());
+		return;
+	}
+	u32 header[4] = { CacheMagic, CacheVersion, binaryTag, (u32)entries.size() };
+	bool success = std::fwrite(header, sizeof(header), 1, f) == 1;
+	for (const auto& it : entries)
+	{
+		if (!success)
+			break;
+		u32 entryHeader[3] = { it.first, it.second.format, (u32)it.second.data.size() };
+		success = std::fwrite(entryHeader, sizeof(entryHeader), 1, f) == 1;
+		if (success && !it.second.data.empty())
+			success = std::fwrite(&it.second.data[0], 1, it.second.data.size(), f) == it.second.data.size();
+	}
+	std::fclose(f);
+	if (!success)
+	{
+		WARN_LOG(RENDERER, "Error writing shader cache %s", path.c_str());
+		nowide::remove(path.c_str());
+	}
+	else
+		INFO_LOG(RENDERER, "Shader cache saved to %s: %d entries, %d precompiled, %d compiled on first use",
+				path.c_str(), (int)entries.size(), precompiled, firstUseCompiles);
+}
@@ -0,0 +1,108 @@
+/*
+	Copyright 2021 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#pragma once
+#include "types.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+//
+// Per-game record of the shader/pipeline keys used by a renderer, so that they
+// can be compiled before their first use the next time the game is started.
+// An optional binary blob (i.e. GL program binary) can be stored with each key.
+// Blobs are only valid for the binary tag they were saved with.
+//
+class ShaderCache
+{
+public:
+	struct Entry
+	{
+		u32 format = 0;
+		std::vector<u8> data;
+	};
+
+	ShaderCache(const char *suffix) : suffix(suffix) {}
+
+	// Loads the cache of the current game. Does nothing if it's already loaded.
+	void load();
+	// Returns true if another game has been started since the cache was loaded
+	bool isStale() const { return imagePath != settings.imgread.ImagePath; }
+	// Saves the cache if modified
+	void save();
+	// Identifies the driver and shader sources that produce the binary blobs.
+	// Blobs saved with another tag are dropped but their keys are kept.
+	void setBinaryTag(u32 tag)
+	{
+		if (tag == binaryTag)
+			return;
+		binaryTag = tag;
+		for (auto& it : entries)
+			if (!it.second.data.empty())
+			{
+				it.second.data.clear();
+				dirty = true;
+			}
+	}
+
+	// Returns true if the key wasn't already in the cache
+	bool add(u32 key)
+	{
+		if (entries.count(key) != 0)
+			return false;
+		entries[key];
+		dirty = true;
+		return true;
+	}
+	void setData(u32 key, u32 format, std::vector<u8>&& data)
+	{
+		Entry& entry = entries[key];
+		entry.format = format;
+		entry.data = std::move(data);
+		dirty = true;
+	}
+	const std::map<u32, Entry>& getEntries() const { return entries; }
+	std::vector<u32> getKeys() const
+	{
+		std::vector<u32> keys;
+		keys.reserve(entries.size());
+		for (const auto& it : entries)
+			keys.push_back(it.first);
+		return keys;
+	}
+	void clear()
+	{
+		entries.clear();
+		path.clear();
+		imagePath.clear();
+		dirty = false;
+	}
+
+	// Statistics
+	u32 precompiled = 0;		// compiled ahead of time
+	u32 firstUseCompiles = 0;	// compiled on the render thread when first used (hitches)
+
+private:
+	const char *suffix;
+	std::string path;
+	std::string imagePath;
+	std::map<u32, Entry> entries;
+	u32 binaryTag = 0;
+	bool dirty = false;
+};
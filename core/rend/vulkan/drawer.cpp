@@ -20,6 +20,7 @@
 */
 #include "drawer.h"
 #include "hw/pvr/pvr_mem.h"
+#include "oslib/oslib.h"
 
 void Drawer::SortTriangles()
 {
@@ -176,11 +177,12 @@ void Drawer::DrawPoly(const vk::CommandBuffer& cmdBuffer, u32 listType, bool sor
 		GetCurrentDescSet().SetTexture((Texture *)poly.texture, poly.tsp);
 
 	vk::Pipeline pipeline = pipelineManager->GetPipeline(listType, sortTriangles, poly, gpuPalette);
-	cmdBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline);
-	if (poly.pcw.Texture)
-		GetCurrentDescSet().BindPerPolyDescriptorSets(cmdBuffer, (Texture *)poly.texture, poly.tsp);
+	BindPipeline(cmdBuffer, pipeline);
+	if (poly.pcw.Texture && GetCurrentDescSet().BindPerPolyDescriptorSets(cmdBuffer))
+		drawStats.descSetBinds++;
 
 	cmdBuffer.drawIndexed(count, 1, first, 0, 0);
+	drawStats.drawCalls++;
 }
 
 void Drawer::DrawSorted(const vk::CommandBuffer& cmdBuffer, const std::vector<SortTrigDrawParam>& polys)
@@ -227,14 +229,14 @@ void Drawer::DrawModVols(const vk::CommandBuffer& cmdBuffer, int first, int coun
 			pipeline = pipelineManager->GetModifierVolumePipeline(ModVolMode::Or, param.isp.CullMode);	// OR'ing (open volume or quad)
 		else
 			pipeline = pipelineManager->GetModifierVolumePipeline(ModVolMode::Xor, param.isp.CullMode);	// XOR'ing (closed volume)
-		cmdBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline);
+		BindPipeline(cmdBuffer, pipeline);
 		cmdBuffer.draw(param.count * 3, 1, param.first * 3, 0);
 
 		if (mv_mode == 1 || mv_mode == 2)
 		{
 			// Sum the area
 			pipeline = pipelineManager->GetModifierVolumePipeline(mv_mode == 1 ? ModVolMode::Inclusion : ModVolMode::Exclusion, param.isp.CullMode);
-			cmdBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline);
+			BindPipeline(cmdBuffer, pipeline);
 			cmdBuffer.draw((param.first + param.count - mod_base) * 3, 1, mod_base * 3, 0);
 			mod_base = -1;
 		}
@@ -246,7 +248,7 @@ void Drawer::DrawModVols(const vk::CommandBuffer& cmdBuffer, int first, int coun
 	cmdBuffer.pushConstants<float>(pipelineManager->GetPipelineLayout(), vk::ShaderStageFlagBits::eFragment, 0, pushConstants);
 
 	pipeline = pipelineManager->GetModifierVolumePipeline(ModVolMode::Final, 0);
-	cmdBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline);
+	BindPipeline(cmdBuffer, pipeline);
 	cmdBuffer.drawIndexed(4, 1, 0, 0, 0);
 }
 
@@ -312,8 +314,11 @@ bool Drawer::Draw(const Texture *fogTexture, const Texture *paletteTexture)
 
 	SortTriangles();
 	currentScissor = vk::Rect2D();
+	currentPipeline = nullptr;
+	drawStats = DrawStats();
 
 	vk::CommandBuffer cmdBuffer = BeginRenderPass();
+	double startTime = os_GetSeconds();
 
 	SetProvokingVertices();
 
@@ -367,6 +372,8 @@ bool Drawer::Draw(const Texture *fogTexture, const Texture *paletteTexture)
 			DrawList(cmdBuffer, ListType_Translucent, false, pvrrc.global_param_tr, previous_pass.tr_count, current_pass.tr_count);
 		previous_pass = current_pass;
     }
+	DEBUG_LOG(RENDERER, "Draw submission: %.3f ms, %d draw calls, %d pipeline binds, %d descriptor set binds",
+			(os_GetSeconds() - startTime) * 1000.0, drawStats.drawCalls, drawStats.pipelineBinds, drawStats.descSetBinds);
 
 	return !pvrrc.isRTT;
 }
@@ -387,6 +394,8 @@ vk::CommandBuffer TextureDrawer::BeginRenderPass()
 			pvrrc.fb_X_CLIP.max + 1, pvrrc.fb_Y_CLIP.max + 1, FB_W_SOF1 & VRAM_MASK);
 	matrices.CalcMatrices(&pvrrc);
 
+	// The previous readback may still be using the color attachment buffer
+	FlushTextureToVRam();
 	textureAddr = FB_W_SOF1 & VRAM_MASK;
 	u32 origWidth = pvrrc.fb_X_CLIP.max + 1;
 	u32 origHeight = pvrrc.fb_Y_CLIP.max + 1;
@@ -550,15 +559,26 @@ void TextureDrawer::EndRenderPass()
 
 	if (config::RenderToTextureBuffer)
 	{
+		// The result is written to vram asynchronously. It is flushed by rend_end_render() before the end of render interrupt is seen by the sh4.
+		// The fence can't be reset before the job has run since the command pool needs two more frames to cycle back to it.
 		vk::Fence fence = commandPool->GetCurrentFence();
-		GetContext()->GetDevice().waitForFences(1, &fence, true, UINT64_MAX);
-
+		vk::Device device = GetContext()->GetDevice();
+		const BufferData *bufferData = colorAttachment->GetBufferData();
 		u16 *dst = (u16 *)&vram[textureAddr];
-
-		PixelBuffer<u32> tmpBuf;
-		tmpBuf.init(clippedWidth, clippedHeight);
-		colorAttachment->GetBufferData()->download(clippedWidth * clippedHeight * 4, tmpBuf.data());
-		WriteTextureToVRam(clippedWidth, clippedHeight, (u8 *)tmpBuf.data(), dst);
+		u32 fbWCtrl = FB_W_CTRL.full;
+		u32 lineStride = FB_W_LINESTRIDE.stride * 8;
+		WriteTextureToVRamAsync([=]() {
+			try {
+				device.waitForFences(1, &fence, true, UINT64_MAX);
+			} catch (const vk::SystemError& e) {
+				WARN_LOG(RENDERER, "Render to texture readback failed: %s", e.what());
+				return;
+			}
+			PixelBuffer<u32> tmpBuf;
+			tmpBuf.init(clippedWidth, clippedHeight);
+			bufferData->download(clippedWidth * clippedHeight * 4, tmpBuf.data());
+			WriteTextureToVRam(clippedWidth, clippedHeight, (u8 *)tmpBuf.data(), dst, fbWCtrl, lineStride);
+		});
 	}
 	else
 	{
@@ -120,6 +120,8 @@ protected:
 			perStripSorting = config::PerStripSorting;
 			pipelineManager->Reset();
 		}
+		else
+			pipelineManager->CheckGameChange();
 		renderPass = 0;
 	}
 
@@ -171,6 +173,15 @@ private:
 	void DrawList(const vk::CommandBuffer& cmdBuffer, u32 listType, bool sortTriangles, const List<PolyParam>& polys, u32 first, u32 last);
 	void DrawModVols(const vk::CommandBuffer& cmdBuffer, int first, int count);
 	void UploadMainBuffer(const VertexShaderUniforms& vertexUniforms, const FragmentShaderUniforms& fragmentUniforms);
+	void BindPipeline(const vk::CommandBuffer& cmdBuffer, vk::Pipeline pipeline)
+	{
+		if (pipeline != currentPipeline)
+		{
+			cmdBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline);
+			currentPipeline = pipeline;
+			drawStats.pipelineBinds++;
+		}
+	}
 
 	int imageIndex = 0;
 	int renderPass = 0;
@@ -189,6 +200,13 @@ private:
 	std::vector<std::vector<u32>> sortedIndexes;
 	u32 sortedIndexCount = 0;
 	bool perStripSorting = false;
+
+	vk::Pipeline currentPipeline;
+	struct DrawStats {
+		u32 drawCalls = 0;
+		u32 pipelineBinds = 0;
+		u32 descSetBinds = 0;
+	} drawStats;
 };
 
 class ScreenDrawer : public Drawer
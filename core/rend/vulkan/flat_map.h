@@ -0,0 +1,143 @@
+/*
+	Copyright 2021 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#pragma once
+#include "types.h"
+
+#include <functional>
+#include <utility>
+#include <vector>
+
+//
+// Open-addressing hash map with linear probing for the per-poly lookups of the renderer.
+// Entries can't be erased individually. clear() keeps the allocated table so that
+// it can be reused each frame without allocating, and only touches the used slots.
+// Values must be default constructible and movable.
+//
+template<typename K, typename V, typename Hash = std::hash<K>>
+class FlatMap
+{
+public:
+	FlatMap(u32 initialCapacity = 64)
+	{
+		u32 capacity = 16;
+		while (capacity < initialCapacity)
+			capacity *= 2;
+		allocate(capacity);
+	}
+
+	V *find(const K& key)
+	{
+		u32 idx = slotIndex(key);
+		while (slots[idx].used)
+		{
+			if (slots[idx].key == key)
+				return &slots[idx].value;
+			idx = (idx + 1) & mask;
+		}
+		return nullptr;
+	}
+
+	// Returns the value associated with key, inserting a default-constructed one if needed
+	V& operator[](const K& key)
+	{
+		u32 idx = slotIndex(key);
+		while (slots[idx].used)
+		{
+			if (slots[idx].key == key)
+				return slots[idx].value;
+			idx = (idx + 1) & mask;
+		}
+		// Keep the load factor under 3/4
+		if ((usedSlots.size() + 1) * 4 > slots.size() * 3)
+		{
+			grow();
+			return (*this)[key];
+		}
+		slots[idx].used = true;
+		slots[idx].key = key;
+		usedSlots.push_back(idx);
+
+		return slots[idx].value;
+	}
+
+	// Calls f(key, value) for each entry, in insertion order
+	template<typename F>
+	void forEach(F f)
+	{
+		for (u32 idx : usedSlots)
+			f(slots[idx].key, slots[idx].value);
+	}
+
+	void clear()
+	{
+		for (u32 idx : usedSlots)
+		{
+			slots[idx].used = false;
+			slots[idx].value = V();
+		}
+		usedSlots.clear();
+	}
+
+	size_t size() const { return usedSlots.size(); }
+	bool empty() const { return usedSlots.empty(); }
+
+private:
+	struct Slot
+	{
+		K key;
+		V value;
+		bool used = false;
+	};
+
+	void allocate(u32 capacity)
+	{
+		slots.clear();
+		slots.resize(capacity);
+		mask = capacity - 1;
+		shift = 64;
+		while (capacity > 1)
+		{
+			shift--;
+			capacity >>= 1;
+		}
+		usedSlots.clear();
+		usedSlots.reserve(slots.size() * 3 / 4);
+	}
+
+	void grow()
+	{
+		std::vector<Slot> oldSlots = std::move(slots);
+		std::vector<u32> oldUsed = std::move(usedSlots);
+		allocate((u32)oldSlots.size() * 2);
+		for (u32 idx : oldUsed)
+			(*this)[oldSlots[idx].key] = std::move(oldSlots[idx].value);
+	}
+
+	// Fibonacci hashing so that keys with only a few significant bits are well spread
+	u32 slotIndex(const K& key) const
+	{
+		u64 h = (u64)Hash()(key);
+		return (u32)((h * 0x9E3779B97F4A7C15ull) >> shift) & mask;
+	}
+
+	std::vector<Slot> slots;
+	std::vector<u32> usedSlots;
+	u32 mask = 0;
+	u32 shift = 64;
+};
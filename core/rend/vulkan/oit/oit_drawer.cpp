@@ -499,6 +499,8 @@ vk::CommandBuffer OITTextureDrawer::NewFrame()
 
 	matrices.CalcMatrices(&pvrrc);
 
+	// The previous readback may still be using the color attachment buffer
+	FlushTextureToVRam();
 	textureAddr = FB_W_SOF1 & VRAM_MASK;
 	u32 origWidth = pvrrc.fb_X_CLIP.max + 1;
 	u32 origHeight = pvrrc.fb_Y_CLIP.max + 1;
@@ -656,15 +658,25 @@ void OITTextureDrawer::EndFrame()
 
 	if (config::RenderToTextureBuffer)
 	{
+		// Written to vram asynchronously. See TextureDrawer::EndRenderPass()
 		vk::Fence fence = commandPool->GetCurrentFence();
-		GetContext()->GetDevice().waitForFences(1, &fence, true, UINT64_MAX);
-
+		vk::Device device = GetContext()->GetDevice();
+		const BufferData *bufferData = colorAttachment->GetBufferData();
 		u16 *dst = (u16 *)&vram[textureAddr];
-
-		PixelBuffer<u32> tmpBuf;
-		tmpBuf.init(clippedWidth, clippedHeight);
-		colorAttachment->GetBufferData()->download(clippedWidth * clippedHeight * 4, tmpBuf.data());
-		WriteTextureToVRam(clippedWidth, clippedHeight, (u8 *)tmpBuf.data(), dst);
+		u32 fbWCtrl = FB_W_CTRL.full;
+		u32 lineStride = FB_W_LINESTRIDE.stride * 8;
+		WriteTextureToVRamAsync([=]() {
+			try {
+				device.waitForFences(1, &fence, true, UINT64_MAX);
+			} catch (const vk::SystemError& e) {
+				WARN_LOG(RENDERER, "Render to texture readback failed: %s", e.what());
+				return;
+			}
+			PixelBuffer<u32> tmpBuf;
+			tmpBuf.init(clippedWidth, clippedHeight);
+			bufferData->download(clippedWidth * clippedHeight * 4, tmpBuf.data());
+			WriteTextureToVRam(clippedWidth, clippedHeight, (u8 *)tmpBuf.data(), dst, fbWCtrl, lineStride);
+		});
 	}
 	else
 	{
@@ -23,7 +23,7 @@
 #include "rend/osd.h"
 #include "quad.h"
 
-void PipelineManager::CreateModVolPipeline(ModVolMode mode, int cullMode)
+vk::UniquePipeline PipelineManager::CreateModVolPipeline(ModVolMode mode, int cullMode)
 {
 	// Vertex input state
 	vk::PipelineVertexInputStateCreateInfo pipelineVertexInputStateCreateInfo;
@@ -163,13 +163,24 @@ void PipelineManager::CreateModVolPipeline(ModVolMode mode, int cullMode)
 	  renderPass                                  // renderPass
 	);
 
-	modVolPipelines[hash(mode, cullMode)] =
-			GetContext()->GetDevice().createGraphicsPipelineUnique(GetContext()->GetPipelineCache(),
+	return GetContext()->GetDevice().createGraphicsPipelineUnique(GetContext()->GetPipelineCache(),
 					graphicsPipelineCreateInfo);
 }
 
-void PipelineManager::CreatePipeline(u32 listType, bool sortTriangles, const PolyParam& pp, bool gpuPalette)
+vk::UniquePipeline PipelineManager::CreatePipeline(u32 pipehash)
 {
+	// Decode the pipeline key. See hash()
+	const u32 listType = ((pipehash >> 5) & 3) << 1;
+	const bool sortTriangles = pipehash & (1 << 26);
+	const bool gpuPalette = pipehash & (1 << 27);
+	const u32 shadInstr = (pipehash >> 7) & 3;
+	const u32 fogCtrl = (pipehash >> 12) & 3;
+	const u32 srcInstr = (pipehash >> 14) & 7;
+	const u32 dstInstr = (pipehash >> 17) & 7;
+	const bool zWriteDis = pipehash & (1 << 20);
+	const u32 cullMode = (pipehash >> 21) & 3;
+	const u32 depthMode = (pipehash >> 23) & 7;
+
 	vk::PipelineVertexInputStateCreateInfo pipelineVertexInputStateCreateInfo = GetMainVertexInputStateCreateInfo();
 
 	// Input assembly state
@@ -186,8 +197,8 @@ void PipelineManager::CreatePipeline(u32 listType, bool sortTriangles, const Pol
 	  false,                                        // depthClampEnable
 	  false,                                        // rasterizerDiscardEnable
 	  vk::PolygonMode::eFill,                       // polygonMode
-	  pp.isp.CullMode == 3 ? vk::CullModeFlagBits::eBack
-			  : pp.isp.CullMode == 2 ? vk::CullModeFlagBits::eFront
+	  cullMode == 3 ? vk::CullModeFlagBits::eBack
+			  : cullMode == 2 ? vk::CullModeFlagBits::eFront
 			  : vk::CullModeFlagBits::eNone,        // cullMode
 	  vk::FrontFace::eCounterClockwise,             // frontFace
 	  false,                                        // depthBiasEnable
@@ -203,7 +214,7 @@ void PipelineManager::CreatePipeline(u32 listType, bool sortTriangles, const Pol
 	if (listType == ListType_Punch_Through || sortTriangles)
 		depthOp = vk::CompareOp::eGreaterOrEqual;
 	else
-		depthOp = depthOps[pp.isp.DepthMode];
+		depthOp = depthOps[depthMode];
 	bool depthWriteEnable;
 	if (sortTriangles && !config::PerStripSorting)
 		// FIXME temporary work-around for intel driver bug
@@ -215,14 +226,14 @@ void PipelineManager::CreatePipeline(u32 listType, bool sortTriangles, const Pol
 		if (listType == ListType_Punch_Through)
 			depthWriteEnable = true;
 		else
-			depthWriteEnable = !pp.isp.ZWriteDis;
+			depthWriteEnable = !zWriteDis;
 	}
 
 	bool shadowed = listType == ListType_Opaque || listType == ListType_Punch_Through;
 	vk::StencilOpState stencilOpState;
 	if (shadowed)
 	{
-		if (pp.pcw.Shadow != 0)
+		if (pipehash & (1 << 3))
 			stencilOpState = vk::StencilOpState(vk::StencilOp::eKeep, vk::StencilOp::eReplace, vk::StencilOp::eKeep, vk::CompareOp::eAlways, 0, 0x80, 0x80);
 		else
 			stencilOpState = vk::StencilOpState(vk::StencilOp::eKeep, vk::StencilOp::eReplace, vk::StencilOp::eKeep, vk::CompareOp::eAlways, 0, 0x80, 0);
@@ -247,8 +258,8 @@ void PipelineManager::CreatePipeline(u32 listType, bool sortTriangles, const Pol
 	// Apparently punch-through polys support blending, or at least some combinations
 	if (listType == ListType_Translucent || listType == ListType_Punch_Through)
 	{
-		u32 src = pp.tsp.SrcInstr;
-		u32 dst = pp.tsp.DstInstr;
+		u32 src = srcInstr;
+		u32 dst = dstInstr;
 		pipelineColorBlendAttachmentState =
 		{
 		  true,                          // blendEnable
@@ -289,20 +300,20 @@ void PipelineManager::CreatePipeline(u32 listType, bool sortTriangles, const Pol
 	vk::DynamicState dynamicStates[2] = { vk::DynamicState::eViewport, vk::DynamicState::eScissor };
 	vk::PipelineDynamicStateCreateInfo pipelineDynamicStateCreateInfo(vk::PipelineDynamicStateCreateFlags(), 2, dynamicStates);
 
-	vk::ShaderModule vertex_module = shaderManager->GetVertexShader(VertexShaderParams{ pp.pcw.Gouraud == 1 });
+	vk::ShaderModule vertex_module = shaderManager->GetVertexShader(VertexShaderParams{ (pipehash & 1) != 0 });
 	FragmentShaderParams params = {};
 	params.alphaTest = listType == ListType_Punch_Through;
-	params.bumpmap = pp.tcw.PixelFmt == PixelBumpMap;
-	params.clamping = pp.tsp.ColorClamp && (pvrrc.fog_clamp_min != 0 || pvrrc.fog_clamp_max != 0xffffffff);
-	params.insideClipTest = (pp.tileclip >> 28) == 3;
-	params.fog = config::Fog ? pp.tsp.FogCtrl : 2;
-	params.gouraud = pp.pcw.Gouraud;
-	params.ignoreTexAlpha = pp.tsp.IgnoreTexA || pp.tcw.PixelFmt == Pixel565;
-	params.offset = pp.pcw.Offset;
-	params.shaderInstr = pp.tsp.ShadInstr;
-	params.texture = pp.pcw.Texture;
-	params.trilinear = pp.pcw.Texture && pp.tsp.FilterMode > 1 && listType != ListType_Punch_Through && pp.tcw.MipMapped == 1;
-	params.useAlpha = pp.tsp.UseAlpha;
+	params.bumpmap = pipehash & (1 << 28);
+	params.clamping = pipehash & (1 << 11);
+	params.insideClipTest = pipehash & (1 << 4);
+	params.fog = fogCtrl;
+	params.gouraud = pipehash & 1;
+	params.ignoreTexAlpha = pipehash & (1 << 9);
+	params.offset = pipehash & (1 << 1);
+	params.shaderInstr = shadInstr;
+	params.texture = pipehash & (1 << 2);
+	params.trilinear = pipehash & (1 << 29);
+	params.useAlpha = pipehash & (1 << 10);
 	params.palette = gpuPalette;
 	vk::ShaderModule fragment_module = shaderManager->GetFragmentShader(params);
 
@@ -328,10 +339,63 @@ void PipelineManager::CreatePipeline(u32 listType, bool sortTriangles, const Pol
 	  renderPass                                  // renderPass
 	);
 
-	pipelines[hash(listType, sortTriangles, &pp, gpuPalette)] = GetContext()->GetDevice().createGraphicsPipelineUnique(GetContext()->GetPipelineCache(),
+	return GetContext()->GetDevice().createGraphicsPipelineUnique(GetContext()->GetPipelineCache(),
 			graphicsPipelineCreateInfo);
 }
 
+vk::Pipeline PipelineManager::AddPipeline(FlatMap<u32, vk::UniquePipeline>& map, u32 key)
+{
+	vk::UniquePipeline& pipeline = map[key & ~ModVolKey];
+	{
+		std::lock_guard<std::mutex> lock(precompiledMutex);
+		auto it = precompiledPipelines.find(key);
+		if (it != precompiledPipelines.end())
+		{
+			pipeline = std::move(it->second);
+			precompiledPipelines.erase(it);
+			return *pipeline;
+		}
+	}
+	// Pipeline compiled on first use
+	shaderCache.add(key);
+	shaderCache.firstUseCompiles++;
+	pipeline = CreatePipelineFromKey(key);
+
+	return *pipeline;
+}
+
+void PipelineManager::StartPrecompile()
+{
+	shaderCache.load();
+	if (!renderPass)
+		return;
+	std::vector<u32> keys = shaderCache.getKeys();
+	if (keys.empty())
+		return;
+	precompileThread = std::thread(&PipelineManager::Precompile, this, std::move(keys));
+}
+
+void PipelineManager::Precompile(std::vector<u32> keys)
+{
+	u32 count = 0;
+	for (u32 key : keys)
+	{
+		if (stopPrecompile)
+			break;
+		try {
+			vk::UniquePipeline pipeline = CreatePipelineFromKey(key);
+			std::lock_guard<std::mutex> lock(precompiledMutex);
+			precompiledPipelines[key] = std::move(pipeline);
+			count++;
+		} catch (const vk::SystemError& e) {
+			WARN_LOG(RENDERER, "Pipeline precompilation failed: %s", e.what());
+			break;
+		}
+	}
+	shaderCache.precompiled += count;
+	DEBUG_LOG(RENDERER, "%d/%d pipelines precompiled", count, (int)keys.size());
+}
+
 void OSDPipeline::CreatePipeline()
 {
 	// Vertex input state
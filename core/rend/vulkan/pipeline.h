@@ -20,10 +20,17 @@
 */
 #pragma once
 #include "vulkan.h"
+#include "flat_map.h"
 #include "shaders.h"
 #include "texture.h"
 #include "utils.h"
 #include "vulkan_context.h"
+#include "hw/pvr/Renderer_if.h"
+#include "rend/shader_cache.h"
+
+#include <atomic>
+#include <mutex>
+#include <thread>
 
 class DescriptorSets
 {
@@ -87,10 +94,17 @@ public:
 
 	void SetTexture(Texture *texture, TSP tsp)
 	{
-		auto& inFlight = perPolyDescSetsInFlight;
-		std::pair<Texture *, u32> index = std::make_pair(texture, tsp.full & SamplerManager::TSP_Mask);
-		if (inFlight.find(index) != inFlight.end())
+		TexKey index = std::make_pair(texture, tsp.full & SamplerManager::TSP_Mask);
+		// Consecutive polys often use the same texture and sampler
+		if (index == lastIndex)
+			return;
+		lastIndex = index;
+		vk::UniqueDescriptorSet& descSet = perPolyDescSetsInFlight[index];
+		if (descSet)
+		{
+			lastDescSet = *descSet;
 			return;
+		}
 
 		if (perPolyDescSets.empty())
 		{
@@ -100,33 +114,41 @@ public:
 		}
 		vk::DescriptorImageInfo imageInfo(samplerManager->GetSampler(tsp), texture->GetReadOnlyImageView(), vk::ImageLayout::eShaderReadOnlyOptimal);
 
-		std::vector<vk::WriteDescriptorSet> writeDescriptorSets;
-		writeDescriptorSets.emplace_back(*perPolyDescSets.back(), 0, 0, 1, vk::DescriptorType::eCombinedImageSampler, &imageInfo, nullptr, nullptr);
-
-		GetContext()->GetDevice().updateDescriptorSets(writeDescriptorSets, nullptr);
-		inFlight[index] = std::move(perPolyDescSets.back());
+		vk::WriteDescriptorSet writeDescriptorSet(*perPolyDescSets.back(), 0, 0, 1, vk::DescriptorType::eCombinedImageSampler, &imageInfo, nullptr, nullptr);
+		GetContext()->GetDevice().updateDescriptorSets(1, &writeDescriptorSet, 0, nullptr);
+		descSet = std::move(perPolyDescSets.back());
 		perPolyDescSets.pop_back();
+		lastDescSet = *descSet;
 	}
 
 	void BindPerFrameDescriptorSets(vk::CommandBuffer cmdBuffer)
 	{
 		cmdBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, pipelineLayout, 0, 1, &perFrameDescSetsInFlight.back().get(), 0, nullptr);
+		boundDescSet = nullptr;
 	}
 
-	void BindPerPolyDescriptorSets(vk::CommandBuffer cmdBuffer, Texture *texture, TSP tsp)
+	// Binds the descriptor set of the last SetTexture() call. Returns false if it was already bound.
+	bool BindPerPolyDescriptorSets(vk::CommandBuffer cmdBuffer)
 	{
-		cmdBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, pipelineLayout, 1, 1,
-				&perPolyDescSetsInFlight[std::make_pair(texture, tsp.full & SamplerManager::TSP_Mask)].get(), 0, nullptr);
+		if (lastDescSet == boundDescSet)
+			return false;
+		cmdBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, pipelineLayout, 1, 1, &lastDescSet, 0, nullptr);
+		boundDescSet = lastDescSet;
+		return true;
 	}
 
 	void Reset()
 	{
-		for (auto& pair : perPolyDescSetsInFlight)
-			perPolyDescSets.emplace_back(std::move(pair.second));
+		perPolyDescSetsInFlight.forEach([this](const TexKey&, vk::UniqueDescriptorSet& descSet) {
+			perPolyDescSets.emplace_back(std::move(descSet));
+		});
 		perPolyDescSetsInFlight.clear();
 		for (auto& descset : perFrameDescSetsInFlight)
 			perFrameDescSets.emplace_back(std::move(descset));
 		perFrameDescSetsInFlight.clear();
+		lastIndex = TexKey();
+		lastDescSet = nullptr;
+		boundDescSet = nullptr;
 	}
 
 private:
@@ -139,7 +161,17 @@ private:
 	std::vector<vk::UniqueDescriptorSet> perFrameDescSets;
 	std::vector<vk::UniqueDescriptorSet> perFrameDescSetsInFlight;
 	std::vector<vk::UniqueDescriptorSet> perPolyDescSets;
-	std::map<std::pair<Texture *, u32>, vk::UniqueDescriptorSet> perPolyDescSetsInFlight;
+	using TexKey = std::pair<Texture *, u32>;
+	struct TexKeyHash
+	{
+		size_t operator()(const TexKey& key) const {
+			return (size_t)key.first ^ ((size_t)key.second << 3);
+		}
+	};
+	FlatMap<TexKey, vk::UniqueDescriptorSet, TexKeyHash> perPolyDescSetsInFlight;
+	TexKey lastIndex;
+	vk::DescriptorSet lastDescSet;
+	vk::DescriptorSet boundDescSet;
 
 	SamplerManager* samplerManager = nullptr;
 };
@@ -147,7 +179,12 @@ private:
 class PipelineManager
 {
 public:
-	virtual ~PipelineManager() = default;
+	PipelineManager(const char *cacheSuffix = ".vkpipe") : shaderCache(cacheSuffix) {}
+	virtual ~PipelineManager()
+	{
+		StopPrecompile();
+		shaderCache.save();
+	}
 
 	void Init(ShaderManager *shaderManager, vk::RenderPass renderPass)
 	{
@@ -177,6 +214,7 @@ public:
 
 		if (this->renderPass != renderPass)
 		{
+			StopPrecompile();
 			this->renderPass = renderPass;
 			Reset();
 		}
@@ -185,30 +223,40 @@ public:
 	vk::Pipeline GetPipeline(u32 listType, bool sortTriangles, const PolyParam& pp, bool gpuPalette)
 	{
 		u32 pipehash = hash(listType, sortTriangles, &pp, gpuPalette);
-		const auto &pipeline = pipelines.find(pipehash);
-		if (pipeline != pipelines.end())
-			return pipeline->second.get();
+		vk::UniquePipeline *pipeline = pipelines.find(pipehash);
+		if (pipeline != nullptr)
+			return pipeline->get();
 
-		CreatePipeline(listType, sortTriangles, pp, gpuPalette);
-
-		return *pipelines[pipehash];
+		return AddPipeline(pipelines, pipehash);
 	}
 
 	vk::Pipeline GetModifierVolumePipeline(ModVolMode mode, int cullMode)
 	{
 		u32 pipehash = hash(mode, cullMode);
-		const auto &pipeline = modVolPipelines.find(pipehash);
-		if (pipeline != modVolPipelines.end())
-			return pipeline->second.get();
-		CreateModVolPipeline(mode, cullMode);
+		vk::UniquePipeline *pipeline = modVolPipelines.find(pipehash);
+		if (pipeline != nullptr)
+			return pipeline->get();
 
-		return *modVolPipelines[pipehash];
+		return AddPipeline(modVolPipelines, pipehash | ModVolKey);
 	}
 
 	void Reset()
 	{
+		StopPrecompile();
 		pipelines.clear();
 		modVolPipelines.clear();
+		precompiledPipelines.clear();
+		StartPrecompile();
+	}
+
+	// Start over with the pipelines of the new game
+	void CheckGameChange()
+	{
+		if (!shaderCache.isStale())
+			return;
+		// Pipelines may still be in use by previous frames
+		GetContext()->WaitIdle();
+		Reset();
 	}
 
 	vk::PipelineLayout GetPipelineLayout() const { return *pipelineLayout; }
@@ -216,20 +264,51 @@ public:
 	vk::DescriptorSetLayout GetPerPolyDSLayout() const { return *perPolyLayout; }
 	vk::RenderPass GetRenderPass() const { return renderPass; }
 
+protected:
+	// Must be called by derived classes destructors if they own the render pass
+	void StopPrecompile()
+	{
+		if (precompileThread.joinable())
+		{
+			stopPrecompile = true;
+			precompileThread.join();
+		}
+		stopPrecompile = false;
+	}
+
 private:
-	void CreateModVolPipeline(ModVolMode mode, int cullMode);
+	// Modifier volume pipeline keys are flagged in the shader cache
+	static constexpr u32 ModVolKey = 0x80000000;
+
+	vk::UniquePipeline CreateModVolPipeline(ModVolMode mode, int cullMode);
+	vk::UniquePipeline CreatePipeline(u32 pipehash);
+	vk::UniquePipeline CreatePipelineFromKey(u32 key)
+	{
+		if (key & ModVolKey)
+			return CreateModVolPipeline((ModVolMode)((key >> 2) & 7), key & 3);
+		else
+			return CreatePipeline(key);
+	}
+	vk::Pipeline AddPipeline(FlatMap<u32, vk::UniquePipeline>& map, u32 key);
+	void StartPrecompile();
+	void Precompile(std::vector<u32> keys);
 
+	// The key fully describes the pipeline so that it can be created from it alone
 	u32 hash(u32 listType, bool sortTriangles, const PolyParam *pp, bool gpuPalette) const
 	{
 		u32 hash = pp->pcw.Gouraud | (pp->pcw.Offset << 1) | (pp->pcw.Texture << 2) | (pp->pcw.Shadow << 3)
 			| (((pp->tileclip >> 28) == 3) << 4);
 		hash |= ((listType >> 1) << 5);
 		bool ignoreTexAlpha = pp->tsp.IgnoreTexA || pp->tcw.PixelFmt == Pixel565;
+		bool clamping = pp->tsp.ColorClamp && (pvrrc.fog_clamp_min != 0 || pvrrc.fog_clamp_max != 0xffffffff);
 		hash |= (pp->tsp.ShadInstr << 7) | (ignoreTexAlpha << 9) | (pp->tsp.UseAlpha << 10)
-			| (pp->tsp.ColorClamp << 11) | ((config::Fog ? pp->tsp.FogCtrl : 2) << 12) | (pp->tsp.SrcInstr << 14)
+			| (clamping << 11) | ((config::Fog ? pp->tsp.FogCtrl : 2) << 12) | (pp->tsp.SrcInstr << 14)
 			| (pp->tsp.DstInstr << 17);
 		hash |= (pp->isp.ZWriteDis << 20) | (pp->isp.CullMode << 21) | (pp->isp.DepthMode << 23);
 		hash |= ((u32)sortTriangles << 26) | ((u32)gpuPalette << 27);
+		bool bumpmap = pp->tcw.PixelFmt == PixelBumpMap;
+		bool trilinear = pp->pcw.Texture && pp->tsp.FilterMode > 1 && listType != ListType_Punch_Through && pp->tcw.MipMapped == 1;
+		hash |= ((u32)bumpmap << 28) | ((u32)trilinear << 29);
 
 		return hash;
 	}
@@ -264,10 +343,15 @@ private:
 				full ? vertexInputAttributeDescriptions : vertexInputLightAttributeDescriptions);
 	}
 
-	void CreatePipeline(u32 listType, bool sortTriangles, const PolyParam& pp, bool gpuPalette);
+	FlatMap<u32, vk::UniquePipeline> pipelines;
+	FlatMap<u32, vk::UniquePipeline> modVolPipelines;
 
-	std::map<u32, vk::UniquePipeline> pipelines;
-	std::map<u32, vk::UniquePipeline> modVolPipelines;
+	// Background precompilation of the pipelines used in previous runs
+	ShaderCache shaderCache;
+	std::thread precompileThread;
+	std::atomic<bool> stopPrecompile { false };
+	std::mutex precompiledMutex;
+	std::map<u32, vk::UniquePipeline> precompiledPipelines;
 
 	vk::UniquePipelineLayout pipelineLayout;
 	vk::UniqueDescriptorSetLayout perFrameLayout;
@@ -283,8 +367,15 @@ protected:
 class RttPipelineManager : public PipelineManager
 {
 public:
+	RttPipelineManager() : PipelineManager(".vkrttpipe") {}
+	~RttPipelineManager() override {
+		StopPrecompile();
+	}
+
 	void Init(ShaderManager *shaderManager)
 	{
+		// The previous render pass is about to be destroyed
+		StopPrecompile();
 		// RTT render pass
 		renderToTextureBuffer = config::RenderToTextureBuffer;
 	    vk::AttachmentDescription attachmentDescriptions[] = {
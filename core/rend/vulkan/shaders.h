@@ -24,6 +24,7 @@
 
 #include <glm/glm.hpp>
 #include <map>
+#include <mutex>
 
 struct VertexShaderParams
 {
@@ -83,12 +84,14 @@ public:
 	vk::ShaderModule GetFragmentShader(const FragmentShaderParams& params) { return getShader(fragmentShaders, params); }
 	vk::ShaderModule GetModVolVertexShader()
 	{
+		std::lock_guard<std::mutex> lock(mutex);
 		if (!modVolVertexShader)
 			modVolVertexShader = compileModVolVertexShader();
 		return *modVolVertexShader;
 	}
 	vk::ShaderModule GetModVolShader()
 	{
+		std::lock_guard<std::mutex> lock(mutex);
 		if (!modVolShader)
 			modVolShader = compileModVolFragmentShader();
 		return *modVolShader;
@@ -131,6 +134,8 @@ private:
 	template<typename T>
 	vk::ShaderModule getShader(std::map<u32, vk::UniqueShaderModule>& map, T params)
 	{
+		// Pipelines can be precompiled on a background thread
+		std::lock_guard<std::mutex> lock(mutex);
 		auto it = map.find(params.hash());
 		if (it != map.end())
 			return it->second.get();
@@ -155,4 +160,5 @@ private:
 	vk::UniqueShaderModule quadFragmentShader;
 	vk::UniqueShaderModule osdVertexShader;
 	vk::UniqueShaderModule osdFragmentShader;
+	std::mutex mutex;
 };
@@ -77,6 +77,7 @@ protected:
 public:
 	void Term() override
 	{
+		TermTextureToVRam();
 		GetContext()->PresentFrame(nullptr, nullptr, vk::Extent2D());
 #ifdef LIBRETRO
 		overlay->Term();
@@ -126,6 +127,8 @@ public:
 
 	bool Process(TA_context* ctx) override
 	{
+		// Render to texture results must be in vram before textures are updated
+		FlushTextureToVRam();
 		if (KillTex)
 			textureCache.Clear();
 
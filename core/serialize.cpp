@@ -2,6 +2,7 @@
 #include "types.h"
 #include "hw/aica/dsp.h"
 #include "hw/aica/aica.h"
+#include "hw/aica/aica_if.h"
 #include "hw/aica/sgc_if.h"
 #include "hw/arm7/arm7.h"
 #include "hw/holly/sb.h"
@@ -248,6 +249,8 @@ bool dc_serialize(void **data, unsigned int *total_size)
 	if ( p_sh4rcb == NULL )
 		return false ;
 
+	libAICA_Sync();
+
 	REICAST_S(version) ;
 	REICAST_S(aica_interr) ;
 	REICAST_S(aica_reg_L) ;
@@ -873,6 +876,8 @@ bool dc_unserialize(void **data, unsigned int *total_size)
 
 	*total_size = 0 ;
 
+	libAICA_Sync();
+
 	REICAST_US(version) ;
 	if (version >= V5_LIBRETRO && version <= V13_LIBRETRO)
 		return dc_unserialize_libretro(data, total_size, version);
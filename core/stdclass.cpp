@@ -6,11 +6,10 @@
 #include <cstring>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <thread>
 #include <vector>
 
-#ifdef _WIN32
-	#include <algorithm>
-#endif
+#include <algorithm>
 
 static std::string user_config_dir;
 static std::string user_data_dir;
@@ -200,3 +199,15 @@ void cResetEvent::Wait()
 
     state = false;
 }
+
+void parallelFor(u32 count, const std::function<void(u32, u32)>& fn)
+{
+	u32 threadCount = std::max(1u, std::min(std::thread::hardware_concurrency(), 16u));
+	u32 chunk = (count + threadCount - 1) / threadCount;
+	std::vector<std::thread> threads;
+	for (u32 begin = chunk; begin < count; begin += chunk)
+		threads.emplace_back(fn, begin, std::min(begin + chunk, count));
+	fn(0, std::min(chunk, count));
+	for (auto& thread : threads)
+		thread.join();
+}
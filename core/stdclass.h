@@ -5,6 +5,7 @@
 #include <mutex>
 #include <algorithm>
 #include <cctype>
+#include <functional>
 #include <thread>
 
 #ifdef __ANDROID__
@@ -50,6 +51,9 @@ public :
 	void Wait();	//Wait for signal , then reset[if auto]
 };
 
+// Calls fn(begin, end) on ranges covering [0, count) from several threads
+void parallelFor(u32 count, const std::function<void(u32, u32)>& fn);
+
 void set_user_config_dir(const std::string& dir);
 void set_user_data_dir(const std::string& dir);
 void add_system_config_dir(const std::string& dir);
@@ -73,6 +77,7 @@ size_t get_last_slash_pos(const std::string& path);
 
 bool mem_region_lock(void *start, std::size_t len);
 bool mem_region_unlock(void *start, std::size_t len);
+bool mem_region_set_noaccess(void *start, std::size_t len);
 bool mem_region_set_exec(void *start, std::size_t len);
 
 class VArray2 {
@@ -24,6 +24,14 @@ bool mem_region_unlock(void *start, size_t len)
 	return true;
 }
 
+bool mem_region_set_noaccess(void *start, size_t len)
+{
+	DWORD old;
+	if (!VirtualProtect(start, len, PAGE_NOACCESS, &old))
+		die("VirtualProtect failed ..\n");
+	return true;
+}
+
 static void *mem_region_reserve(void *start, size_t len)
 {
 	DWORD type = MEM_RESERVE;
@@ -50,6 +50,7 @@
 #include "hw/maple/maple_cfg.h"
 #include "hw/pvr/spg.h"
 #include "hw/naomi/naomi_cart.h"
+#include "hw/aica/aica_if.h"
 #include "imgread/common.h"
 #include "LogManager.h"
 #include "cheats.h"
@@ -514,6 +515,10 @@ static void update_variables(bool first_startup)
 		DEBUG_LOG(COMMON, "Got height: %u", (int)config::RenderResolution);
 	}
 
+	var.key = CORE_OPTION_NAME "_aica_sync_window";
+	if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+		config::AicaSyncWindow = atoi(var.value);
+
 	var.key = CORE_OPTION_NAME "_boot_to_bios";
 	if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
 	{
@@ -886,6 +891,8 @@ void retro_run()
 			gui_display_notification(e.what(), 5000);
 			environ_cb(RETRO_ENVIRONMENT_SHUTDOWN, NULL);
 		}
+		// Samples must not be pushed by the aica thread outside of retro_run
+		libAICA_Sync();
 	}
 
 	if (config::RendererType.isOpenGL())
@@ -235,6 +235,34 @@ struct retro_core_option_v2_definition option_defs_us[] = {
       "disabled",
 #endif
    },
+   {
+      CORE_OPTION_NAME "_gdrom_read_ahead",
+      "GD-ROM Read-Ahead",
+      NULL,
+      "Reads the next disc sectors on a background thread. Reduces stalls when the disc image is on a slow storage device.",
+      NULL,
+      NULL,
+      {
+         { "disabled", NULL },
+         { "enabled",  NULL },
+         { NULL, NULL },
+      },
+      "enabled",
+   },
+   {
+      CORE_OPTION_NAME "_gdrom_instant_loading",
+      "GD-ROM Instant Loading (inaccurate)",
+      NULL,
+      "Completes HLE BIOS disc reads immediately instead of emulating the transfer time. Requires HLE BIOS. May break some games.",
+      NULL,
+      NULL,
+      {
+         { "disabled", NULL },
+         { "enabled",  NULL },
+         { NULL, NULL },
+      },
+      "disabled",
+   },
    {/* TODO: needs explanation */
       CORE_OPTION_NAME "_mipmapping",
       "Mipmapping",
@@ -386,6 +414,20 @@ struct retro_core_option_v2_definition option_defs_us[] = {
       },
       "auto",
    },
+   {
+      CORE_OPTION_NAME "_dynarec_superblocks",
+      "Dynarec Superblocks",
+      NULL,
+      "Recompiles frequently executed code as longer blocks that follow unconditional branches. Only used by the x64 dynarec.",
+      NULL,
+      NULL,
+      {
+         { "disabled", NULL },
+         { "enabled",  NULL },
+         { NULL, NULL },
+      },
+      "enabled",
+   },
    {
       CORE_OPTION_NAME "_force_wince",
       "Force Windows CE Mode",
@@ -470,6 +512,37 @@ struct retro_core_option_v2_definition option_defs_us[] = {
       "enabled",
 #endif
    },
+   {
+      CORE_OPTION_NAME "_threaded_aica",
+      "Threaded Sound Emulation",
+      NULL,
+      "Runs the sound CPU, the sound generator and the DSP on their own thread. Improves performance on multi-core CPUs. The output is identical.",
+      NULL,
+      NULL,
+      {
+         { "disabled", NULL },
+         { "enabled",  NULL },
+         { NULL, NULL },
+      },
+      "disabled",
+   },
+   {
+      CORE_OPTION_NAME "_aica_sync_window",
+      "Threaded Sound Sync Window",
+      NULL,
+      "Maximum number of 32-sample batches the sound thread can lag behind the main CPU. Higher values reduce waiting between threads. Only used when 'Threaded Sound Emulation' is enabled.",
+      NULL,
+      NULL,
+      {
+         { "1",  NULL },
+         { "2",  NULL },
+         { "4",  NULL },
+         { "8",  NULL },
+         { "16", NULL },
+         { NULL, NULL },
+      },
+      "4",
+   },
    {
       CORE_OPTION_NAME "_anisotropic_filtering",
       "Anisotropic Filtering",
@@ -562,6 +635,20 @@ struct retro_core_option_v2_definition option_defs_us[] = {
       },
       "enabled",
    },
+   {
+      CORE_OPTION_NAME "_shader_precompile",
+      "Precompile Shaders",
+      NULL,
+      "Compiles the shaders and pipelines used by the game during previous sessions when the game starts. Reduces stuttering the first time effects are displayed.",
+      NULL,
+      "video",
+      {
+         { "disabled", NULL },
+         { "enabled",  NULL },
+         { NULL, NULL },
+      },
+      "enabled",
+   },
    {
       CORE_OPTION_NAME "_delay_frame_swapping",
       "Delay Frame Swapping",
@@ -642,6 +729,20 @@ struct retro_core_option_v2_definition option_defs_us[] = {
       },
       "disabled",
    },
+   {
+      CORE_OPTION_NAME "_predecrypt_roms",
+      "Pre-Decrypt Naomi/Atomiswave ROMs (Restart Required)",
+      NULL,
+      "Decrypts the whole cartridge ROM when the game is loaded, using all CPU cores. Reduces the cost of ROM reads for encrypted Atomiswave and M4 cartridges but doubles their memory usage.",
+      NULL,
+      NULL,
+      {
+         { "disabled", NULL },
+         { "enabled",  NULL },
+         { NULL, NULL },
+      },
+      "disabled",
+   },
    {
       CORE_OPTION_NAME "_custom_textures",
       "Load Custom Textures",
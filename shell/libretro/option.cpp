@@ -26,6 +26,7 @@ namespace config {
 Option<bool> DynarecEnabled("", true);
 Option<bool> DynarecIdleSkip("", true);
 Option<bool> DynarecSafeMode(CORE_OPTION_NAME "_div_matching");
+Option<bool> DynarecSuperblocks(CORE_OPTION_NAME "_dynarec_superblocks", true);
 
 // General
 
@@ -49,6 +50,8 @@ Option<int> AudioBufferSize("", 5644);	// 128 ms
 Option<int> AudioBufferSize("", 2822);	// 64 ms
 #endif
 Option<bool> AutoLatency("");
+Option<bool> ThreadedAica(CORE_OPTION_NAME "_threaded_aica");
+Option<int> AicaSyncWindow("", 4);
 
 OptionString AudioBackend("", "auto");
 
@@ -86,6 +89,7 @@ Option<int> AutoSkipFrame(CORE_OPTION_NAME "_auto_skip_frame", 0);
 Option<int> RenderResolution("", 480);
 Option<bool> VSync("", true);
 Option<bool> ThreadedRendering(CORE_OPTION_NAME "_threaded_rendering", true);
+Option<bool> ShaderPrecompile(CORE_OPTION_NAME "_shader_precompile", true);
 Option<int> AnisotropicFiltering(CORE_OPTION_NAME "_anisotropic_filtering");
 Option<bool> PowerVR2Filter(CORE_OPTION_NAME "_pvr2_filtering");
 Option<u64> PixelBufferSize("", 512 * 1024 * 1024);
@@ -98,6 +102,9 @@ Option<bool> UseReios(CORE_OPTION_NAME "_hle_bios");
 
 Option<bool> OpenGlChecks("", false);
 Option<bool> FastGDRomLoad(CORE_OPTION_NAME "_gdrom_fast_loading", false);
+Option<bool> InstantGDRomLoad(CORE_OPTION_NAME "_gdrom_instant_loading", false);
+Option<bool> GDRomReadAhead(CORE_OPTION_NAME "_gdrom_read_ahead", true);
+Option<bool> PreDecryptRoms(CORE_OPTION_NAME "_predecrypt_roms", false);
 
 //Option<std::vector<std::string>, false> ContentPath("");
 //Option<bool, false> HideLegacyNaomiRoms("", true);
@@ -112,6 +112,13 @@ std::string getVulkanCachePath()
 	return std::string(game_dir_no_slash) + std::string(path_default_slash()) + "vulkan_pipeline.cache";
 }
 
+std::string getShaderCachePath(const std::string& suffix)
+{
+	if (content_name[0] == '\0')
+		return "";
+	return std::string(game_dir_no_slash) + std::string(path_default_slash()) + content_name + suffix;
+}
+
 std::string getTextureLoadPath(const std::string& gameId)
 {
 	return std::string(retro_get_system_directory()) + "/dc/textures/"
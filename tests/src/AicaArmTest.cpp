@@ -5,6 +5,9 @@
 #include "hw/aica/aica_if.h"
 #include "hw/arm7/arm7_rec.h"
 
+#include <chrono>
+#include <cstdio>
+
 extern bool Arm7Enabled;
 
 void dc_init();
@@ -1085,4 +1088,42 @@ TEST_F(AicaArmTest, ConditionRegAllocTest)
 	ASSERT_EQ(arm_Reg[1].I, 0);
 	ASSERT_EQ(arm_Reg[2].I, 22);
 }
+
+// Run with --gtest_also_run_disabled_tests
+TEST_F(AicaArmTest, DISABLED_MixLoopBenchmark)
+{
+	u32 ops[] = {
+			0xe3a00801,	// mov r0, #0x10000
+			0xe3a01000,	// mov r1, #0
+			0xe3a03000,	// mov r3, #0
+			0xe7902101,	// loop: ldr r2, [r0, r1, lsl #2]
+			0xeb000004,	// bl mix
+			0xe7803101,	// str r3, [r0, r1, lsl #2]
+			0xe2844001,	// add r4, r4, #1
+			0xe2811001,	// add r1, r1, #1
+			0xe20110ff,	// and r1, r1, #0xff
+			0xeafffff8,	// b loop
+			0xe0233292,	// mix: mla r3, r2, r2, r3
+			0xe1a0f00e	// mov pc, lr
+	};
+	for (u32 i = 0; i < ARRAY_SIZE(ops); i++)
+		*(u32*)&aica_ram[0x2000 + i * 4] = ops[i];
+	for (u32 i = 0; i < 0x400; i += 4)
+		*(u32*)&aica_ram[0x10000 + i] = i * 0x01010101;
+	flush();
+	arm_Reg[R15_ARM_NEXT].I = 0x2000;
+	arm_Reg[4].I = 0;
+
+	const u32 seconds = 10;
+	const u32 samples = 44100 * seconds;
+	auto start = std::chrono::steady_clock::now();
+	for (u32 i = 0; i < samples; i++)
+	{
+		arm_Reg[CYCL_CNT].I += ARM_CYCLES_PER_SAMPLE;
+		arm_mainloop(arm_Reg, EntryPoints);
+	}
+	double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	printf("ARM7 dynarec, load/call/store loop: %.1f M iterations/s, %.1f ms per emulated second\n",
+			arm_Reg[4].I / s / 1e6, s * 1e3 / seconds);
+}
 }
@@ -0,0 +1,372 @@
+#include "gtest/gtest.h"
+#include "types.h"
+#include "hw/mem/_vmem.h"
+#include "hw/aica/aica.h"
+#include "hw/aica/aica_if.h"
+#include "hw/aica/dsp.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+void dc_init();
+void dc_reset(bool hard);
+
+class AicaDspTest : public ::testing::Test {
+protected:
+	void SetUp() override {
+		if (!_vmem_reserve())
+			die("_vmem_reserve failed");
+		dc_init();
+		dc_reset(true);
+	}
+
+	struct Inst {
+		u32 TRA = 0, TWT = 0, TWA = 0;
+		u32 XSEL = 0, YSEL = 0, IRA = 0, IWT = 0, IWA = 0;
+		u32 TABLE = 0, MWT = 0, MRD = 0, EWT = 0, EWA = 0, ADRL = 0, FRCL = 0, SHIFT = 0, YRL = 0, NEGB = 0, ZERO = 0, BSEL = 0;
+		u32 MASA = 0, ADREB = 0, NXADR = 0;
+	};
+
+	void setInst(int step, const Inst& i)
+	{
+		u32 *mpro = &DSPData->MPRO[step * 4];
+		mpro[0] = (i.TRA << 9) | (i.TWT << 8) | (i.TWA << 1);
+		mpro[1] = (i.XSEL << 15) | (i.YSEL << 13) | (i.IRA << 7) | (i.IWT << 6) | (i.IWA << 1);
+		mpro[2] = (i.TABLE << 15) | (i.MWT << 14) | (i.MRD << 13) | (i.EWT << 12) | (i.EWA << 8)
+				| (i.ADRL << 7) | (i.FRCL << 6) | (i.SHIFT << 4) | (i.YRL << 3) | (i.NEGB << 2) | (i.ZERO << 1) | i.BSEL;
+		mpro[3] = (i.MASA << 9) | (i.ADREB << 8) | (i.NXADR << 7);
+	}
+
+	// Assembles a step written as "NAME" (bit set) or "NAME=value" fields separated by spaces
+	static Inst parseInst(const char *text)
+	{
+		static const struct {
+			const char *name;
+			u32 Inst::*field;
+		} fields[] = {
+			{ "TRA", &Inst::TRA }, { "TWT", &Inst::TWT }, { "TWA", &Inst::TWA },
+			{ "XSEL", &Inst::XSEL }, { "YSEL", &Inst::YSEL }, { "IRA", &Inst::IRA }, { "IWT", &Inst::IWT }, { "IWA", &Inst::IWA },
+			{ "TABLE", &Inst::TABLE }, { "MWT", &Inst::MWT }, { "MRD", &Inst::MRD }, { "EWT", &Inst::EWT }, { "EWA", &Inst::EWA },
+			{ "ADRL", &Inst::ADRL }, { "FRCL", &Inst::FRCL }, { "SHIFT", &Inst::SHIFT }, { "YRL", &Inst::YRL },
+			{ "NEGB", &Inst::NEGB }, { "ZERO", &Inst::ZERO }, { "BSEL", &Inst::BSEL },
+			{ "MASA", &Inst::MASA }, { "ADREB", &Inst::ADREB }, { "NXADR", &Inst::NXADR },
+		};
+		Inst inst;
+		std::istringstream stream(text);
+		std::string token;
+		while (stream >> token)
+		{
+			size_t equal = token.find('=');
+			std::string name = token.substr(0, equal);
+			u32 value = equal == std::string::npos ? 1 : strtoul(token.c_str() + equal + 1, nullptr, 0);
+			bool found = false;
+			for (const auto& field : fields)
+				if (name == field.name)
+				{
+					inst.*field.field = value;
+					found = true;
+				}
+			EXPECT_TRUE(found) << name;
+		}
+		return inst;
+	}
+
+	struct Step {
+		int step;
+		const char *inst;
+		u16 coef;
+	};
+
+	void loadProgram(const std::vector<Step>& steps, const std::vector<u16>& madrs)
+	{
+		memset(DSPData->MPRO, 0, sizeof(DSPData->MPRO));
+		memset(DSPData->COEF, 0, sizeof(DSPData->COEF));
+		memset(DSPData->MADRS, 0, sizeof(DSPData->MADRS));
+		for (const Step& step : steps)
+		{
+			setInst(step.step, parseInst(step.inst));
+			DSPData->COEF[step.step] = step.coef;
+		}
+		for (size_t i = 0; i < madrs.size(); i++)
+			DSPData->MADRS[i] = madrs[i];
+	}
+
+	// Random program with about half the steps empty and memory accesses on odd steps only
+	void randomProgram()
+	{
+		memset(DSPData->MPRO, 0, sizeof(DSPData->MPRO));
+		for (int step = 0; step < 128; step++)
+		{
+			if (rand() & 1)
+				continue;
+			Inst i;
+			i.TRA = rand() & 0x7f;
+			i.TWT = (rand() & 3) == 0;
+			i.TWA = rand() & 0x7f;
+			i.XSEL = rand() & 1;
+			i.YSEL = rand() & 3;
+			i.IRA = rand() % 0x33;
+			i.IWT = (rand() & 7) == 0;
+			i.IWA = rand() & 0x1f;
+			if (step & 1)
+			{
+				i.TABLE = rand() & 1;
+				i.MWT = (rand() & 3) == 0;
+				i.MRD = (rand() & 3) == 0;
+				i.MASA = rand() & 0x3f;
+				i.ADREB = rand() & 1;
+				i.NXADR = rand() & 1;
+			}
+			i.EWT = (rand() & 3) == 0;
+			i.EWA = rand() & 0xf;
+			i.ADRL = (rand() & 7) == 0;
+			i.FRCL = (rand() & 3) == 0;
+			i.SHIFT = rand() & 3;
+			i.YRL = (rand() & 3) == 0;
+			i.NEGB = rand() & 1;
+			i.ZERO = (rand() & 3) == 0;
+			i.BSEL = rand() & 1;
+			setInst(step, i);
+		}
+		for (u32& coef : DSPData->COEF)
+			coef = rand() & 0xfff8;
+		for (u32& madrs : DSPData->MADRS)
+			madrs = rand() & 0xffff;
+	}
+
+	void resetState()
+	{
+		memset(dsp::state.TEMP, 0, sizeof(dsp::state.TEMP));
+		memset(dsp::state.MEMS, 0, sizeof(dsp::state.MEMS));
+		memset(dsp::state.MIXS, 0, sizeof(dsp::state.MIXS));
+		memset(dsp::state.MEMVAL, 0, sizeof(dsp::state.MEMVAL));
+		memset(DSPData->EFREG, 0, sizeof(DSPData->EFREG));
+		dsp::state.MDEC_CT = 1;
+		dsp::state.RBL = 0x8000 - 1;
+		dsp::state.RBP = 0;
+		// The delay lines and tables start with some data
+		u32 seed = 5678;
+		for (u32 i = 0; i < RamSize; i += 2)
+			*(u16 *)&aica_ram[i] = nextRandom(seed);
+	}
+
+	static u32 nextRandom(u32& seed)
+	{
+		seed = seed * 1103515245 + 12345;
+		return seed >> 8;
+	}
+
+	// Runs the current program for a number of samples and returns everything it produced
+	std::vector<s32> run(void (*step)())
+	{
+		std::vector<s32> out;
+		u32 seed = 1234;
+		for (int sample = 0; sample < 256; sample++)
+		{
+			for (s32& mixs : dsp::state.MIXS)
+				mixs = (nextRandom(seed) & 0xfffff) - 0x80000;
+			DSPData->EXTS[0] = nextRandom(seed) & 0xffff;
+			DSPData->EXTS[1] = nextRandom(seed) & 0xffff;
+			step();
+			for (u32 efreg : DSPData->EFREG)
+				out.push_back(efreg);
+		}
+		out.insert(out.end(), std::begin(dsp::state.TEMP), std::end(dsp::state.TEMP));
+		out.insert(out.end(), std::begin(dsp::state.MEMS), std::end(dsp::state.MEMS));
+		out.push_back(dsp::state.MDEC_CT);
+		for (u32 i = 0; i < RamSize; i += 4)
+			out.push_back(*(s32 *)&aica_ram[i]);
+		return out;
+	}
+
+	// Runs the program with the recompiler and the dataflow analysis,
+	// and compares the results with the interpreter running every step.
+	void compare()
+	{
+		resetState();
+		dsp::state.dirty = true;
+		std::vector<s32> compiled = run(dsp::step);
+		ASSERT_FALSE(dsp::state.stopped);
+
+		for (dsp::StepInfo& info : dsp::stepInfo)
+			info.nop = false;
+		resetState();
+		std::vector<s32> reference = run(dsp::runStepInterpreter);
+
+		ASSERT_EQ(reference.size(), compiled.size());
+		for (size_t i = 0; i < reference.size(); i++)
+			ASSERT_EQ(reference[i], compiled[i]) << describe(i);
+	}
+
+	// Where the i-th value returned by run() comes from
+	static std::string describe(size_t i)
+	{
+		const size_t efregs = 256 * 16;
+		if (i < efregs)
+			return "EFREG[" + std::to_string(i % 16) + "] of sample " + std::to_string(i / 16);
+		i -= efregs;
+		if (i < 128)
+			return "TEMP[" + std::to_string(i) + "]";
+		i -= 128;
+		if (i < 32)
+			return "MEMS[" + std::to_string(i) + "]";
+		i -= 32;
+		if (i == 0)
+			return "MDEC_CT";
+		return "aica_ram[" + std::to_string((i - 1) * 4) + "]";
+	}
+
+	static const u32 RamSize = 0x30000;
+};
+
+TEST_F(AicaDspTest, AnalysisTest)
+{
+	memset(DSPData->MPRO, 0, sizeof(DSPData->MPRO));
+	Inst i;
+	i.EWT = 1;
+	i.EWA = 2;
+	setInst(10, i);
+	dsp::AnalyseProgram();
+	for (int step = 0; step < 128; step++)
+	{
+		if (step == 9)
+		{
+			// ACC is used by the next step
+			ASSERT_FALSE(dsp::stepInfo[step].nop);
+			ASSERT_TRUE(dsp::stepInfo[step].accUsed);
+		}
+		else if (step == 10)
+		{
+			ASSERT_FALSE(dsp::stepInfo[step].nop);
+			ASSERT_FALSE(dsp::stepInfo[step].accUsed);
+		}
+		else
+			ASSERT_TRUE(dsp::stepInfo[step].nop);
+	}
+
+	// FRC_REG written at step 20 and read at step 31
+	memset(DSPData->MPRO, 0, sizeof(DSPData->MPRO));
+	i = Inst();
+	i.FRCL = 1;
+	setInst(20, i);
+	i = Inst();
+	i.YSEL = 0;
+	i.XSEL = 1;
+	setInst(31, i);
+	i = Inst();
+	i.TWT = 1;
+	setInst(32, i);
+	dsp::AnalyseProgram();
+	ASSERT_TRUE(dsp::stepInfo[20].frcUsed);
+	ASSERT_TRUE(dsp::stepInfo[31].accUsed);
+	ASSERT_TRUE(dsp::stepInfo[31].inputsUsed);
+	ASSERT_TRUE(dsp::stepInfo[19].accUsed);		// SHIFTED is needed by FRCL
+	ASSERT_TRUE(dsp::stepInfo[18].nop);
+}
+
+TEST_F(AicaDspTest, BitExactTest)
+{
+	srand(42);
+	for (int program = 0; program < 20; program++)
+	{
+		randomProgram();
+		compare();
+	}
+}
+
+// Stereo feedback echo of the first send bus, plus the CD audio inputs
+TEST_F(AicaDspTest, EchoTest)
+{
+	loadProgram({
+		{ 1, "MRD MASA=0", 0 },						// delayed sample
+		{ 3, "IWT IWA=0", 0 },
+		{ 4, "XSEL IRA=0x20 YSEL=1 ZERO", 0x4000 },	// MIXS0 * 0.5
+		{ 5, "XSEL IRA=0 YSEL=1 BSEL", 0x4cc8 },	// + delayed * 0.6
+		{ 6, "YSEL=1 BSEL", 0 },
+		{ 7, "MWT MASA=1 EWT EWA=0", 0 },
+		{ 8, "XSEL IRA=0 YSEL=1 ZERO", 0x5998 },	// delayed * 0.7
+		{ 9, "EWT EWA=1", 0 },
+		{ 10, "XSEL IRA=0x30 YSEL=1 ZERO", 0x2000 },
+		{ 11, "XSEL IRA=0x31 YSEL=1 BSEL", 0x2000 },
+		{ 12, "EWT EWA=2 SHIFT=1", 0 },
+	}, { 0x40, 0 });
+	compare();
+}
+
+// Four comb filters in the ring buffer followed by two allpass filters in TEMP
+TEST_F(AicaDspTest, ReverbTest)
+{
+	loadProgram({
+		{ 0, "XSEL IRA=0x20 YSEL=1 ZERO", 0x2000 },
+		{ 1, "XSEL IRA=0x21 YSEL=1 BSEL", 0x2000 },
+		{ 2, "TWT TWA=0", 0 },					// input
+		{ 3, "MRD MASA=0", 0 },					// comb 0
+		{ 5, "IWT IWA=0", 0 },
+		{ 6, "XSEL IRA=0 YSEL=1", 0x5998 },		// input + delayed * feedback
+		{ 7, "MWT MASA=1 TRA=1 XSEL IRA=0 YSEL=1 ZERO", 0x4000 },
+		{ 8, "TWT TWA=1", 0 },					// sum of the combs
+		{ 9, "MRD MASA=2", 0 },					// comb 1
+		{ 11, "IWT IWA=1", 0 },
+		{ 12, "XSEL IRA=1 YSEL=1", 0x5668 },
+		{ 13, "MWT MASA=3 TRA=1 XSEL IRA=1 YSEL=1", 0x4000 },
+		{ 14, "TWT TWA=1", 0 },
+		{ 15, "MRD MASA=4", 0 },					// comb 2
+		{ 17, "IWT IWA=2", 0 },
+		{ 18, "XSEL IRA=2 YSEL=1", 0x5334 },
+		{ 19, "MWT MASA=5 TRA=1 XSEL IRA=2 YSEL=1", 0x4000 },
+		{ 20, "TWT TWA=1", 0 },
+		{ 21, "MRD MASA=6", 0 },					// comb 3
+		{ 23, "IWT IWA=3", 0 },
+		{ 24, "XSEL IRA=3 YSEL=1", 0x4cc8 },
+		{ 25, "MWT MASA=7 TRA=1 XSEL IRA=3 YSEL=1", 0x4000 },
+		{ 26, "TWT TWA=1", 0 },
+		{ 27, "TRA=40 YSEL=1 ZERO", 0x5998 },			// allpass: w = x + g * w[-20]
+		{ 28, "TRA=1 YSEL=1 BSEL", 0x7ff8 },
+		{ 29, "TWT TWA=20", 0 },
+		{ 30, "TRA=20 YSEL=1 ZERO", 0xa668 },			// y = w[-20] - g * w
+		{ 31, "TRA=40 YSEL=1 BSEL", 0x7ff8 },
+		{ 32, "EWT EWA=3 SHIFT=1 TWT TWA=2", 0 },
+		{ 33, "TRA=73 YSEL=1 ZERO", 0x4cc8 },			// allpass of 13 samples
+		{ 34, "TRA=2 YSEL=1 BSEL", 0x7ff8 },
+		{ 35, "TWT TWA=60", 0 },
+		{ 36, "TRA=60 YSEL=1 ZERO", 0xb338 },
+		{ 37, "TRA=73 YSEL=1 BSEL", 0x7ff8 },
+		{ 38, "EWT EWA=4 SHIFT=2", 0 },
+	}, { 0x25, 0, 0x2029, 0x2000, 0x402b, 0x4000, 0x602f, 0x6000 });
+	compare();
+}
+
+// Chorus: the delay line is read at an offset modulated by an LFO, with linear interpolation
+TEST_F(AicaDspTest, ChorusTest)
+{
+	loadProgram({
+		{ 0, "TRA=21 YSEL=1", 0x0100 },				// LFO kept in TEMP: read at 21, written at 20
+		{ 1, "XSEL IRA=0x31 YSEL=1 BSEL", 0x0040 },
+		{ 2, "TWT TWA=20", 0 },
+		{ 3, "TRA=20 YSEL=1 ZERO", 0x7ff8 },
+		{ 4, "ADRL FRCL SHIFT=3", 0 },				// whole and fractional offsets
+		{ 5, "MRD MASA=4 ADREB", 0 },
+		{ 7, "MRD MASA=4 ADREB NXADR IWT IWA=2", 0 },
+		{ 9, "IWT IWA=3", 0 },
+		{ 10, "XSEL IRA=3 YSEL=0 ZERO", 0 },		// a + (b - a) * frc
+		{ 11, "XSEL IRA=2 YSEL=0 NEGB BSEL", 0 },
+		{ 12, "XSEL IRA=2 YSEL=1 NEGB BSEL", 0x7ff8 },
+		{ 13, "EWT EWA=6", 0 },
+		{ 14, "XSEL IRA=0x20 YSEL=1 ZERO", 0x7ff8 },
+		{ 15, "MWT MASA=5 EWT EWA=7", 0 },
+		{ 16, "XSEL IRA=0x21 YRL", 0 },				// Y_REG as multiplier
+		{ 17, "XSEL IRA=0x22 YSEL=2 ZERO", 0 },
+		{ 18, "XSEL IRA=0x22 YSEL=3 BSEL", 0 },
+		{ 19, "EWT EWA=8 SHIFT=1", 0 },
+		{ 20, "EWT EWA=9 SHIFT=2", 0 },
+		{ 21, "MRD TABLE MASA=6", 0 },				// table lookup
+		{ 23, "IWT IWA=4", 0 },
+		{ 24, "XSEL IRA=4 YSEL=1 ZERO", 0x4000 },
+		{ 25, "EWT EWA=10", 0 },
+	}, { 0, 0, 0, 0, 0x100, 0, 0x200 });
+	compare();
+}
@@ -0,0 +1,173 @@
+#include "gtest/gtest.h"
+#include "types.h"
+#include "emulator.h"
+#include "hw/mem/_vmem.h"
+#include "hw/aica/aica_if.h"
+#include "hw/sh4/sh4_interpreter.h"
+#include "hw/sh4/sh4_mem.h"
+#include "oslib/audiostream.h"
+#include "cfg/option.h"
+
+#include <algorithm>
+#include <vector>
+
+// Captures the samples pushed to the audio backend
+static std::vector<s16> capturedSamples;
+
+static void captureInit()
+{
+}
+
+static u32 capturePush(const void *data, u32 frames, bool wait)
+{
+	const s16 *samples = (const s16 *)data;
+	capturedSamples.insert(capturedSamples.end(), samples, samples + frames * 2);
+	return 1;
+}
+
+static void captureTerm()
+{
+}
+
+static audiobackend_t audiobackend_capture = {
+	"capture",
+	"Test capture",
+	&captureInit,
+	&capturePush,
+	&captureTerm,
+	nullptr
+};
+static bool capture = RegisterAudioBackend(&audiobackend_capture);
+
+class AicaThreadTest : public ::testing::Test {
+protected:
+	void SetUp() override {
+		if (!_vmem_reserve())
+			die("_vmem_reserve failed");
+		dc_init();
+		mem_map_default();
+		config::AudioBackend.override("capture");
+		InitAudio();
+	}
+
+	void TearDown() override {
+		TermAudio();
+		config::ThreadedAica.override(false);
+		config::AudioBackend.override("auto");
+	}
+
+	void writeChannel(u32 channel, u32 reg, u32 value)
+	{
+		WriteMem_aica_reg(channel * 0x80 + reg, value, 2);
+	}
+
+	// Plays two looping channels for about 0.4 s, changing the pitch of the first one
+	// and keying off the second one half way through
+	std::vector<s16> render(bool threaded)
+	{
+		config::ThreadedAica.override(threaded);
+		dc_reset(true);
+
+		// Start on a new audio buffer
+		size_t size = capturedSamples.size();
+		while (capturedSamples.size() == size)
+			WriteSample(0, 0);
+		capturedSamples.clear();
+
+		srand(42);
+		for (u32 i = 0; i < 0x10000; i++)
+			aica_ram[i] = (u8)rand();
+
+		WriteMem_aica_reg(0x2800, 0xf, 2);		// MVOL
+		for (u32 ch = 0; ch < 2; ch++)
+		{
+			writeChannel(ch, 0x04, ch * 0x8000);	// SA
+			writeChannel(ch, 0x08, 0);				// LSA
+			writeChannel(ch, 0x0C, 0x3000);			// LEA
+			writeChannel(ch, 0x10, 0x1f);			// AR
+			writeChannel(ch, 0x14, 0x1f);			// RR
+			writeChannel(ch, 0x24, 0x0f00 | (ch == 0 ? 0x0f : 0x1f));	// DISDL, DIPAN
+			writeChannel(ch, 0x28, 0x20);			// LPOFF
+		}
+		writeChannel(0, 0x18, 0x0123);				// FNS
+		writeChannel(1, 0x18, 0x7a00);				// OCT -1
+		writeChannel(1, 0x00, 0x4000 | 0x0080 | 0x0200);	// KYONB, 8-bit PCM, loop
+		writeChannel(0, 0x00, 0xC000 | 0x0200);		// KYONEX, KYONB, 16-bit PCM, loop
+
+		for (int i = 0; i < 200000; i++)
+		{
+			if (i == 100000)
+			{
+				writeChannel(0, 0x18, 0x0800);		// OCT 1
+				writeChannel(1, 0x00, 0x8000 | 0x0080 | 0x0200);	// KYONEX with KYONB cleared
+			}
+			UpdateSystem();
+		}
+		libAICA_Sync();
+
+		return capturedSamples;
+	}
+
+	// The arm7 increments the word at 0x100 and copies the word at 0x104, written by the sh4, to 0x108.
+	// Returns the values seen by the sh4 through the area 0 handlers.
+	std::vector<u32> runArm(bool threaded)
+	{
+		config::ThreadedAica.override(threaded);
+		dc_reset(true);
+
+		static const u32 code[] = {
+			0xe3a00c01,		// mov r0, #0x100
+			// loop:
+			0xe5901000,		// ldr r1, [r0]
+			0xe2811001,		// add r1, r1, #1
+			0xe5801000,		// str r1, [r0]
+			0xe5902004,		// ldr r2, [r0, #4]
+			0xe5802008,		// str r2, [r0, #8]
+			0xeafffffa,		// b loop
+		};
+		memcpy(&aica_ram[0], code, sizeof(code));
+		WriteMem_aica_reg(0x2C00, 0, 1);		// ARMRST: start the arm7
+		// Start right after a batch so that both runs are in phase
+		while (_vmem_ReadMem32(0x00800100) == 0)
+			UpdateSystem();
+
+		std::vector<u32> values;
+		for (u32 i = 0; i < 100000; i++)
+		{
+			if (i % 1000 == 0)
+			{
+				_vmem_WriteMem32(0x00800104, i);
+				values.push_back(_vmem_ReadMem32(0x00800100));
+				values.push_back(_vmem_ReadMem32(0x00800108));
+			}
+			UpdateSystem();
+		}
+		WriteMem_aica_reg(0x2C00, 1, 1);		// ARMRST: stop the arm7
+		libAICA_Sync();
+
+		return values;
+	}
+};
+
+TEST_F(AicaThreadTest, Determinism)
+{
+	// Threaded first so that the thread is stopped by the inline run
+	std::vector<s16> threaded = render(true);
+	std::vector<s16> inlined = render(false);
+
+	ASSERT_FALSE(inlined.empty());
+	ASSERT_TRUE(std::any_of(inlined.begin(), inlined.end(), [](s16 sample) { return sample != 0; }));
+	ASSERT_EQ(inlined.size(), threaded.size());
+	ASSERT_TRUE(inlined == threaded);
+}
+
+TEST_F(AicaThreadTest, ArmAramAccess)
+{
+	std::vector<u32> threaded = runArm(true);
+	std::vector<u32> inlined = runArm(false);
+
+	// The arm7 ran and copied the values written by the sh4
+	ASSERT_NE(0u, inlined[inlined.size() - 2]);
+	ASSERT_EQ(98000u, inlined.back());
+	ASSERT_TRUE(inlined == threaded);
+}
@@ -0,0 +1,189 @@
+#include "gtest/gtest.h"
+#include "types.h"
+#include "log/AsyncLog.h"
+
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+class AsyncLogTest : public ::testing::Test {
+protected:
+	void SetUp() override {
+		log.reset(new AsyncLog([this](LogTypes::LOG_LEVELS level, LogTypes::LOG_TYPE type,
+				const char* file, int line, double time, const char* text) {
+			write(text);
+		}, []() {}));
+	}
+
+	void TearDown() override {
+		unblockWriter();
+		log.reset();
+	}
+
+	void write(const char *text)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		messages.push_back(text);
+		writing = true;
+		cond.notify_all();
+		cond.wait(lock, [this]() { return !blocked; });
+	}
+
+	bool post(const char *format, ...)
+	{
+		va_list args;
+		va_start(args, format);
+		bool rc = log->Post(LogTypes::LOG_LEVELS::LINFO, LogTypes::COMMON, __FILE__, __LINE__, 0.0, format, args);
+		va_end(args);
+		return rc;
+	}
+
+	void writeSync(const char *format, ...)
+	{
+		va_list args;
+		va_start(args, format);
+		log->WriteSync(LogTypes::LOG_LEVELS::LWARNING, LogTypes::COMMON, __FILE__, __LINE__, 0.0, format, args);
+		va_end(args);
+	}
+
+	// Messages written once all the queued ones are
+	std::vector<std::string> drain()
+	{
+		unblockWriter();
+		log.reset();
+		return messages;
+	}
+
+	void unblockWriter()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		blocked = false;
+		cond.notify_all();
+	}
+
+	std::unique_ptr<AsyncLog> log;
+	std::mutex mutex;
+	std::condition_variable cond;
+	std::vector<std::string> messages;
+	bool blocked = false;
+	bool writing = false;
+};
+
+TEST_F(AsyncLogTest, Format)
+{
+	const char str[] = "string";
+	// Not null-terminated
+	const char buf[4] = { 'a', 'b', 'c', 'd' };
+	ASSERT_TRUE(post("%d %u %x %lld %zu %c %%", -1, 42u, 0xbeef, 1LL << 40, (size_t)7, 'z'));
+	ASSERT_TRUE(post("[%*d] [%-*d] [%.*d]", 5, 42, 4, 1, 3, 7));
+	ASSERT_TRUE(post("[%s] [%8s] [%-8s|] [%.3s] [%.*s]", str, str, str, str, 2, str));
+	ASSERT_TRUE(post("[%.4s] [%.*s] [%*.*s]", buf, 4, buf, 6, 2, buf));
+	ASSERT_TRUE(post("%.*s", -1, str));
+	ASSERT_TRUE(post("%s", (const char *)nullptr));
+	ASSERT_TRUE(post("%.2f %e %p", 3.14159, 1e10, (void *)0x1234));
+
+	std::vector<std::string> msgs = drain();
+	ASSERT_EQ(7u, msgs.size());
+	char expected[128];
+	snprintf(expected, sizeof(expected), "%d %u %x %lld %zu %c %%", -1, 42u, 0xbeef, 1LL << 40, (size_t)7, 'z');
+	ASSERT_EQ(expected, msgs[0]);
+	ASSERT_EQ("[   42] [1   ] [007]", msgs[1]);
+	ASSERT_EQ("[string] [  string] [string  |] [str] [st]", msgs[2]);
+	ASSERT_EQ("[abcd] [abcd] [    ab]", msgs[3]);
+	ASSERT_EQ("string", msgs[4]);
+	ASSERT_EQ("(null)", msgs[5]);
+	snprintf(expected, sizeof(expected), "%.2f %e %p", 3.14159, 1e10, (void *)0x1234);
+	ASSERT_EQ(expected, msgs[6]);
+}
+
+#ifndef _WIN32
+TEST_F(AsyncLogTest, PrecisionDoesntReadPastString)
+{
+	// The string ends right before an inaccessible page
+	long pageSize = sysconf(_SC_PAGESIZE);
+	u8 *pages = (u8 *)mmap(nullptr, pageSize * 2, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	ASSERT_NE(MAP_FAILED, (void *)pages);
+	mprotect(pages + pageSize, pageSize, PROT_NONE);
+	char *str = (char *)pages + pageSize - 3;
+	memcpy(str, "xyz", 3);
+
+	ASSERT_TRUE(post("%.3s %.*s", str, 2, str));
+	std::vector<std::string> msgs = drain();
+	munmap(pages, pageSize * 2);
+	ASSERT_EQ(1u, msgs.size());
+	ASSERT_EQ("xyz xy", msgs[0]);
+}
+#endif
+
+TEST_F(AsyncLogTest, OrderAcrossThreads)
+{
+	const int threadCount = 4;
+	const int perThread = 100;
+	std::mutex orderMutex;
+	int next = 0;
+	std::vector<std::thread> threads;
+	for (int t = 0; t < threadCount; t++)
+		threads.emplace_back([&]() {
+			for (int i = 0; i < perThread; i++)
+			{
+				// Posted in the order of the counter
+				std::lock_guard<std::mutex> lock(orderMutex);
+				post("%d", next++);
+			}
+		});
+	for (auto& thread : threads)
+		thread.join();
+
+	std::vector<std::string> msgs = drain();
+	ASSERT_EQ((size_t)(threadCount * perThread), msgs.size());
+	for (int i = 0; i < threadCount * perThread; i++)
+		ASSERT_EQ(std::to_string(i), msgs[i]);
+}
+
+TEST_F(AsyncLogTest, Overflow)
+{
+	// Hold the writer on the first message so that the ring buffer fills up
+	blocked = true;
+	ASSERT_TRUE(post("%d", 0));
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		cond.wait(lock, [this]() { return writing; });
+	}
+	// The first message is still in the ring buffer
+	int posted = 1;
+	while (post("%d", posted))
+		posted++;
+	ASSERT_GT(posted, 1);
+	ASSERT_FALSE(post("%d", posted));
+
+	std::vector<std::string> msgs = drain();
+	ASSERT_EQ((size_t)posted, msgs.size());
+	for (int i = 0; i < posted; i++)
+		ASSERT_EQ(std::to_string(i), msgs[i]);
+}
+
+TEST_F(AsyncLogTest, WriteSync)
+{
+	post("%s", "first");
+	post("%s", "second");
+	writeSync("%s", "warning");
+	// Queued messages are written first, before WriteSync returns
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		ASSERT_EQ(3u, messages.size());
+		ASSERT_EQ("first", messages[0]);
+		ASSERT_EQ("second", messages[1]);
+		ASSERT_EQ("warning", messages[2]);
+	}
+	post("%s", "third");
+	std::vector<std::string> msgs = drain();
+	ASSERT_EQ(4u, msgs.size());
+	ASSERT_EQ("third", msgs[3]);
+}
@@ -0,0 +1,118 @@
+#include "gtest/gtest.h"
+#include "types.h"
+#include "emulator.h"
+#include "hw/mem/_vmem.h"
+#include "hw/holly/sb.h"
+#include "hw/pvr/pvr_regs.h"
+#include "hw/pvr/ta.h"
+#include "hw/pvr/ta_ctx.h"
+#include "hw/sh4/sh4_mem.h"
+#include "hw/sh4/sh4_mmr.h"
+#include "hw/sh4/modules/dmac.h"
+
+#include <chrono>
+#include <cstdio>
+
+class DmacTest : public ::testing::Test {
+protected:
+	void SetUp() override {
+		if (!_vmem_reserve())
+			die("_vmem_reserve failed");
+		dc_init();
+		mem_map_default();
+		dc_reset(true);
+	}
+
+	void TearDown() override {
+		tactx_Term();
+	}
+
+	void ch2Dma(u32 src, u32 dst, u32 len)
+	{
+		DMAC_DMAOR.full = 0x8201;
+		DMAC_SAR(2) = src;
+		SB_C2DSTAT = dst;
+		SB_C2DLEN = len;
+		DMAC_Ch2St();
+	}
+
+	// Opaque triangle strips of 8 vertices, then the end of list
+	void buildTaList(u32 addr, u32 len)
+	{
+		const u32 records = len / 32;
+		for (u32 i = 0; i < records; i++, addr += 32)
+		{
+			u32 pcw;
+			if (i == records - 1)
+				pcw = ParamType_End_Of_List << 29;
+			else if (i % 9 == 0)
+				pcw = ParamType_Polygon_or_Modifier_Volume << 29;
+			else
+				pcw = (ParamType_Vertex_Parameter << 29) | (i % 9 == 8 ? 1 << 28 : 0);
+			WriteMem32_nommu(addr, pcw);
+			for (u32 j = 4; j < 32; j += 4)
+				WriteMem32_nommu(addr + j, i * 32 + j);
+		}
+	}
+
+	static const u32 Src = 0x0C100000;
+};
+
+TEST_F(DmacTest, Texture32)
+{
+	SB_LMMODE0 = 1;
+	for (u32 i = 0; i < 0x1000; i += 4)
+		WriteMem32_nommu(Src + i, i * 0x01010101);
+	ch2Dma(Src, 0x11200000, 0x1000);
+	for (u32 i = 0; i < 0x1000; i += 4)
+		ASSERT_EQ(i * 0x01010101, ReadMem32_nommu(0xa5200000 + i));
+	ASSERT_EQ(0u, SB_C2DLEN);
+}
+
+TEST_F(DmacTest, Texture32NotFromRam)
+{
+	// The source isn't in system RAM: copied word by word
+	SB_LMMODE0 = 1;
+	for (u32 i = 0; i < 0x1000; i += 4)
+		WriteMem32_nommu(0xa5100000 + i, ~i);
+	ch2Dma(0x05100000, 0x11200000, 0x1000);
+	for (u32 i = 0; i < 0x1000; i += 4)
+		ASSERT_EQ(~i, ReadMem32_nommu(0xa5200000 + i));
+}
+
+TEST_F(DmacTest, TaList)
+{
+	const u32 len = 9 * 32 * 4 + 32;
+	buildTaList(Src, len);
+	ta_vtx_ListInit();
+	SB_ISTNRM = 0;
+	ch2Dma(Src, 0x10000000, len);
+	ASSERT_EQ(len, (u32)(ta_tad.thd_data - ta_tad.thd_root));
+	ASSERT_EQ(0, memcmp(ta_tad.thd_root, GetMemPtr(Src, len), len));
+	// End of opaque list interrupt
+	ASSERT_NE(0u, SB_ISTNRM & (1 << (u8)holly_OPAQUE));
+}
+
+// Run with --gtest_also_run_disabled_tests
+TEST_F(DmacTest, DISABLED_Ch2Benchmark)
+{
+	const u32 len = 64 * 1024;
+	const int loops = 4000;
+
+	SB_LMMODE0 = 1;
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < loops; i++)
+		ch2Dma(Src, 0x11000000, len);
+	double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	printf("Ch2 DMA, 32-bit texture path: %.0f MB/s\n", (double)len * loops / s / 1e6);
+
+	buildTaList(Src, len);
+	start = std::chrono::steady_clock::now();
+	for (int i = 0; i < loops; i++)
+	{
+		ta_vtx_ListInit();
+		ch2Dma(Src, 0x10000000, len);
+	}
+	s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	printf("Ch2 DMA, TA polygon path: %.0f MB/s\n", (double)len * loops / s / 1e6);
+}
@@ -0,0 +1,108 @@
+#include "gtest/gtest.h"
+#include "types.h"
+#include "emulator.h"
+#include "cfg/option.h"
+#include "hw/mem/_vmem.h"
+#include "hw/holly/sb.h"
+#include "hw/maple/maple_cfg.h"
+#include "hw/maple/maple_devs.h"
+#include "hw/maple/maple_helper.h"
+#include "hw/sh4/sh4_mem.h"
+#include "input/gamepad_device.h"
+
+#include <chrono>
+#include <cstdio>
+
+class MapleTest : public ::testing::Test {
+protected:
+	void SetUp() override {
+		if (!_vmem_reserve())
+			die("_vmem_reserve failed");
+		dc_init();
+		mem_map_default();
+		dc_reset(true);
+		mcfg_DestroyDevices();
+		for (int bus = 0; bus < MAPLE_PORTS; bus++)
+		{
+			config::MapleMainDevices[bus] = MDT_SegaController;
+			config::MapleExpansionDevices[bus][0] = MDT_None;
+			config::MapleExpansionDevices[bus][1] = MDT_None;
+			kcode[bus] = ~0;
+			rt[bus] = lt[bus] = 0;
+			joyx[bus] = joyy[bus] = 0;
+		}
+		mcfg_CreateDevices();
+		buildDmaList();
+	}
+
+	void TearDown() override {
+		mcfg_DestroyDevices();
+	}
+
+	// One GetCondition frame per controller, as sent by games every vblank
+	void buildDmaList()
+	{
+		u32 addr = DmaList;
+		for (u32 bus = 0; bus < MAPLE_PORTS; bus++)
+		{
+			WriteMem32_nommu(addr, (bus == MAPLE_PORTS - 1 ? 0x80000000 : 0) | (bus << 16) | 1);
+			WriteMem32_nommu(addr + 4, response(bus));
+			u32 reci = maple_GetAddress(bus, 5);
+			WriteMem32_nommu(addr + 8, MDCF_GetCondition | (reci << 8) | ((bus << 6) << 16) | (1 << 24));
+			WriteMem32_nommu(addr + 12, MFID_0_Input);
+			addr += 16;
+		}
+	}
+
+	static u32 response(u32 bus)
+	{
+		return ResponseBase + bus * 0x20;
+	}
+
+	void doDma()
+	{
+		SB_MDEN = 1;
+		SB_MDSTAR = DmaList;
+		sb_WriteMem(SB_MDST_addr, 1, 4);
+	}
+
+	static const u32 DmaList = 0x0C001000;
+	static const u32 ResponseBase = 0x0C002000;
+};
+
+TEST_F(MapleTest, GetCondition)
+{
+	doDma();
+	for (u32 bus = 0; bus < MAPLE_PORTS; bus++)
+	{
+		u32 reci = maple_GetAddress(bus, 5);
+		ASSERT_EQ(MDRS_DataTransfer | ((bus << 6) << 8) | (reci << 16) | (3 << 24), ReadMem32_nommu(response(bus)));
+		ASSERT_EQ((u32)MFID_0_Input, ReadMem32_nommu(response(bus) + 4));
+		ASSERT_EQ(0x0000ffffu, ReadMem32_nommu(response(bus) + 8));
+		ASSERT_EQ(0x80808080u, ReadMem32_nommu(response(bus) + 12));
+	}
+
+	// The response must follow the input state
+	kcode[1] &= ~DC_BTN_A;
+	rt[1] = 0x40;
+	joyx[2] = -0x20;
+	doDma();
+	ASSERT_EQ(0x0000ffffu, ReadMem32_nommu(response(0) + 8));
+	ASSERT_EQ(0x0040fffbu, ReadMem32_nommu(response(1) + 8));
+	ASSERT_EQ(0x80808060u, ReadMem32_nommu(response(2) + 12));
+
+	kcode[1] = ~0;
+	doDma();
+	ASSERT_EQ(0x0040ffffu, ReadMem32_nommu(response(1) + 8));
+}
+
+// Run with --gtest_also_run_disabled_tests
+TEST_F(MapleTest, DISABLED_DmaBenchmark)
+{
+	const int vblanks = 100000;
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < vblanks; i++)
+		doDma();
+	double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+	printf("Maple DMA, %d controllers: %.0f ns per vblank\n", MAPLE_PORTS, ns / vblanks);
+}
@@ -0,0 +1,79 @@
+#include "gtest/gtest.h"
+#include "types.h"
+#include "emulator.h"
+#include "hw/mem/_vmem.h"
+#include "hw/sh4/sh4_mem.h"
+#include "hw/sh4/sh4_mmr.h"
+#include "hw/sh4/modules/mmu.h"
+#include "hw/sh4/interpr/sh4_opcodes.h"
+
+class MmuTest : public ::testing::Test {
+protected:
+	void SetUp() override {
+		if (!_vmem_reserve())
+			die("_vmem_reserve failed");
+		dc_init();
+		mem_map_default();
+		dc_reset(true);
+		CCN_PTEH.reg_data = 0;
+	}
+
+	void TearDown() override {
+		mmu_flush_table();
+	}
+
+	// 4 KB page, valid, private
+	void ldtlb(u32 entry, u32 vaddr, u32 paddr, u32 asid)
+	{
+		CCN_MMUCR.URC = entry;
+		CCN_PTEH.reg_data = vaddr | asid;
+		CCN_PTEL.reg_data = (paddr & 0x1ffffc00) | (1 << 8) | (1 << 4);
+		CCN_PTEA.reg_data = 0;
+		i0000_0000_0011_1000(0x0038);
+	}
+
+	static const u32 VAddr = 0x00400000;
+	static const u32 PAddr = 0x0c100000;
+};
+
+TEST_F(MmuTest, LdtlbDropsOldEntry)
+{
+	ldtlb(5, VAddr, PAddr, 0);
+	// Translation cached by the dynarec
+	mmuAddressLUT[VAddr >> 12] = PAddr;
+
+	// The entry is replaced by an unrelated one
+	ldtlb(5, 0x00800000, PAddr, 0);
+	ASSERT_EQ(0u, mmuAddressLUT[VAddr >> 12]);
+}
+
+TEST_F(MmuTest, LdtlbDropsSavedAsidTable)
+{
+	ldtlb(5, VAddr, PAddr, 1);
+	CCN_PTEH.reg_data = 1;
+	mmuAddressLUT[VAddr >> 12] = PAddr;
+	// Switch to ASID 2: the LUT of ASID 1 is saved
+	mmuAddressLUTSwitchAsid(1, 2);
+	ASSERT_EQ(0u, mmuAddressLUT[VAddr >> 12]);
+
+	// Entry replaced while ASID 2 is current
+	ldtlb(5, 0x00800000, PAddr, 2);
+	mmuAddressLUTSwitchAsid(2, 1);
+	ASSERT_EQ(0u, mmuAddressLUT[VAddr >> 12]);
+}
+
+TEST_F(MmuTest, AddressArrayWriteDropsOldEntry)
+{
+	ldtlb(7, VAddr, PAddr, 0);
+	mmuAddressLUT[VAddr >> 12] = PAddr;
+
+	// Remap the entry through the UTLB address array
+	WriteMem32_nommu(0xF6000000 | (7 << 8), 0x00800000 | (1 << 8));
+	ASSERT_EQ(0u, mmuAddressLUT[VAddr >> 12]);
+
+	ldtlb(7, VAddr, PAddr, 0);
+	mmuAddressLUT[VAddr >> 12] = PAddr;
+	// Associative write clearing V
+	WriteMem32_nommu(0xF6000080, VAddr);
+	ASSERT_EQ(0u, mmuAddressLUT[VAddr >> 12]);
+}
@@ -0,0 +1,165 @@
+#include "gtest/gtest.h"
+#include "types.h"
+#include "cfg/option.h"
+#include "hw/naomi/naomi_regs.h"
+#include "hw/naomi/decrypt.h"
+#include "hw/naomi/awcartridge.h"
+#include "hw/naomi/awave_regs.h"
+#include "hw/naomi/m4cartridge.h"
+
+#include <cstdlib>
+
+// Known answers are hashes of the output of the original scalar implementations
+
+static const u32 CartSize = 1024 * 1024;
+
+static u32 hash(u32 h, const void *data, u32 size)
+{
+	const u8 *p = (const u8 *)data;
+	for (u32 i = 0; i < size; i++)
+		h = (h ^ p[i]) * 16777619;
+	return h;
+}
+
+static void fillRom(u8 *rom)
+{
+	u32 x = 42;
+	for (u32 i = 0; i < CartSize; i++)
+	{
+		x = x * 1103515245 + 12345;
+		rom[i] = x >> 16;
+	}
+}
+
+class TestAWCartridge : public AWCartridge
+{
+public:
+	TestAWCartridge() : AWCartridge(CartSize) { fillRom(RomPtr); }
+};
+
+class TestM4Cartridge : public M4Cartridge
+{
+public:
+	TestM4Cartridge() : M4Cartridge(CartSize) { fillRom(RomPtr); }
+};
+
+class NaomiDecryptTest : public ::testing::Test {
+protected:
+	void TearDown() override {
+		config::PreDecryptRoms = false;
+	}
+
+	// Reads a whole Atomiswave cart for a few keys
+	u32 awDecrypt()
+	{
+		u32 h = 2166136261;
+		for (u32 key = 0; key < 0x100; key += 0x13)
+		{
+			TestAWCartridge cart;
+			cart.SetKey(key);
+			cart.Init();
+			for (u32 offset = 0; offset < CartSize; )
+			{
+				cart.WriteMem(AW_EPR_OFFSETL_addr, (offset / 2) & 0xffff, 2);
+				cart.WriteMem(AW_EPR_OFFSETH_addr, (offset / 2) >> 16, 2);
+				u32 size = 32;
+				void *p = cart.GetDmaPtr(size);
+				h = hash(h, &size, sizeof(size));
+				h = hash(h, p, size);
+				offset += std::max(size, 2u);
+			}
+		}
+		return h;
+	}
+
+	// Reads a few encrypted streams from an M4 cart, starting at aligned and unaligned offsets
+	u32 m4Decrypt()
+	{
+		u32 h = 2166136261;
+		for (u32 key = 0; key < 4; key++)
+		{
+			TestM4Cartridge cart;
+			u8 *keyData = (u8 *)malloc(2048);
+			for (u32 i = 0; i < 2048; i++)
+				keyData[i] = i * 7 + key * 0x35;
+			cart.SetKey(0x5500 + key);
+			cart.SetKeyData(keyData);
+			cart.Init();
+			// enable decryption
+			cart.WriteMem(NAOMI_ROM_OFFSETH_addr, 0x4000, 2);
+			const u32 offsets[] = { 0, 0x1002, 0x20020, 0x4001e };
+			for (u32 start : offsets)
+			{
+				cart.WriteMem(NAOMI_DMA_OFFSETH_addr, start >> 16, 2);
+				cart.WriteMem(NAOMI_DMA_OFFSETL_addr, start & 0xffff, 2);
+				for (u32 total = 0; total < 0x18000; )
+				{
+					u32 size = 0x1234;
+					void *p = cart.GetDmaPtr(size);
+					h = hash(h, &size, sizeof(size));
+					h = hash(h, p, size);
+					cart.AdvancePtr(size);
+					total += size;
+				}
+			}
+		}
+		return h;
+	}
+};
+
+TEST_F(NaomiDecryptTest, AtomiswaveKnownAnswer)
+{
+	ASSERT_EQ(0x78466978u, awDecrypt());
+}
+
+TEST_F(NaomiDecryptTest, AtomiswavePreDecrypt)
+{
+	config::PreDecryptRoms = true;
+	ASSERT_EQ(0x78466978u, awDecrypt());
+}
+
+TEST_F(NaomiDecryptTest, M4KnownAnswer)
+{
+	ASSERT_EQ(0x894de4b0u, m4Decrypt());
+}
+
+TEST_F(NaomiDecryptTest, M4PreDecrypt)
+{
+	config::PreDecryptRoms = true;
+	ASSERT_EQ(0x894de4b0u, m4Decrypt());
+}
+
+// 315-5881 block cipher used by M2/M3 carts
+TEST_F(NaomiDecryptTest, M2KnownAnswer)
+{
+	struct {
+		u32 gameKey;
+		u16 sequenceKey;
+		u16 counter;
+		u16 data;
+		u16 expected;
+	} const vectors[] = {
+		{ 0x0008ad01, 0xcc6c, 0x4e4f, 0xa745, 0x469d },
+		{ 0x000a8f06, 0x5892, 0x1390, 0xd258, 0xf4c8 },
+		{ 0x0002a305, 0x7d22, 0x2ee8, 0xf311, 0xee58 },
+		{ 0x000ee834, 0xaaa1, 0xcd28, 0x3131, 0x1144 },
+		{ 0x00000000, 0x73be, 0x1265, 0x2ed9, 0xc679 },
+		{ 0xffffffff, 0x0142, 0x6973, 0xc66c, 0xfb83 },
+		{ 0x0007f0fe, 0xcace, 0x242d, 0x0fc6, 0x3654 },
+		{ 0x00165f39, 0x4823, 0xd754, 0x3da0, 0x3042 },
+	};
+	for (const auto& v : vectors)
+		ASSERT_EQ(v.expected, cryptoBlockDecrypt(v.gameKey, v.sequenceKey, v.counter, v.data));
+
+	u32 h = 2166136261;
+	u32 x = 42;
+	for (int i = 0; i < 100000; i++)
+	{
+		x = x * 1103515245 + 12345;
+		u32 gameKey = x;
+		x = x * 1103515245 + 12345;
+		u16 data = cryptoBlockDecrypt(gameKey, x >> 16, x, i);
+		h = hash(h, &data, sizeof(data));
+	}
+	ASSERT_EQ(0x0162cd8eu, h);
+}
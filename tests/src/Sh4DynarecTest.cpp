@@ -0,0 +1,427 @@
+#include "gtest/gtest.h"
+#include "types.h"
+#include "emulator.h"
+#include "hw/mem/_vmem.h"
+#include "hw/aica/aica_if.h"
+#include "hw/pvr/pvr_mem.h"
+#include "hw/sh4/sh4_if.h"
+#include "hw/sh4/sh4_mem.h"
+#include "hw/sh4/sh4_sched.h"
+#include "hw/sh4/dyna/blockmanager.h"
+#include "hw/sh4/sh4_interpreter.h"
+#include "oslib/oslib.h"
+#include "cfg/option.h"
+#include "profiler/profiler.h"
+
+#include <chrono>
+#include <cstdio>
+#include <set>
+
+#if FEAT_SHREC != DYNAREC_NONE
+
+static const u32 StartPc = 0x8C010000;
+static const u32 StackTop = 0x8C0F0000;
+
+static sh4_if *runningCpu;
+
+static int stopCpu(int tag, int cycles, int jitter)
+{
+	runningCpu->Stop();
+	return 0;
+}
+
+class Sh4DynarecTest : public ::testing::Test {
+protected:
+	void SetUp() override {
+		if (!_vmem_reserve())
+			die("_vmem_reserve failed");
+		dc_init();
+		// SetUp reserves a new address space for each test but RAM is still mapped in the first one
+		_vmem_init_mappings();
+		mem_map_default();
+		dc_reset(true);
+		os_InstallFaultHandler();
+		ctx = &p_sh4rcb->cntx;
+		Get_Sh4Recompiler(&sh4);
+		runningCpu = &sh4;
+		schedId = sh4_sched_register(0, stopCpu);
+	}
+
+	void TearDown() override {
+		// Stops the aica thread
+		config::ThreadedAica.override(false);
+		dc_reset(true);
+		// Drop the blocks and make the code pages writable again
+		bm_ResetCache();
+		bm_Reset();
+		sh4_sched_unregister(schedId);
+		os_UninstallFaultHandler();
+	}
+
+	// Calls a function with a stack frame in a loop. r1 counts the calls,
+	// r4 and r5 accumulate the values of r1 through locals on the stack
+	void writeCallLoop()
+	{
+		static const u16 code[] = {
+			0xE100,		// mov #0, r1
+			0xE400,		// mov #0, r4
+			// loop:
+			0xB003,		// bsr func
+			0x0009,		// nop
+			0x7101,		// add #1, r1
+			0xAFFB,		// bra loop
+			0x0009,		// nop
+			// func:
+			0x2FE6,		// mov.l r14, @-r15
+			0x4F22,		// sts.l pr, @-r15
+			0x6EF3,		// mov r15, r14
+			0x7FF0,		// add #-16, r15
+			0x1F11,		// mov.l r1, @(4, r15)
+			0x53F1,		// mov.l @(4, r15), r3
+			0x343C,		// add r3, r4
+			0x1F42,		// mov.l r4, @(8, r15)
+			0x55F2,		// mov.l @(8, r15), r5
+			0x6FE3,		// mov r14, r15
+			0x4F26,		// lds.l @r15+, pr
+			0x000B,		// rts
+			0x6EF6,		// mov.l @r15+, r14
+		};
+		for (size_t i = 0; i < ARRAY_SIZE(code); i++)
+			_vmem_WriteMem16(StartPc + i * 2, code[i]);
+		ctx->pc = StartPc;
+		ctx->r[14] = 0;
+		ctx->r[15] = StackTop;
+	}
+
+	// r4 adds 2 for each odd value of the counter r1. The T value computed at the end of the loop
+	// is dead and each iteration reloads FPSCR from a literal.
+	void writeTBitLoop(u32 pc = StartPc)
+	{
+		static const u16 code[] = {
+			0xE100,		// mov #0, r1
+			0xE201,		// mov #1, r2
+			0xE400,		// mov #0, r4
+			0xE500,		// mov #0, r5
+			// loop:
+			0xD306,		// mov.l @(24, pc), r3
+			0x436A,		// lds r3, fpscr
+			0xF010,		// fadd fr1, fr0
+			0x6013,		// mov r1, r0
+			0xC801,		// tst #1, r0
+			0x8900,		// bt skip
+			0x7402,		// add #2, r4
+			// skip:
+			0x4200,		// shll r2
+			0x352C,		// add r2, r5
+			0x3526,		// cmp/hi r2, r5
+			0x7101,		// add #1, r1
+			0xAFF3,		// bra loop
+			0x0009,		// nop
+			0x0009,
+			0x0001, 0x0004,	// .long 0x00040001
+		};
+		for (size_t i = 0; i < ARRAY_SIZE(code); i++)
+			_vmem_WriteMem16(pc + i * 2, code[i]);
+		ctx->pc = pc;
+	}
+
+	// Reads the register at addr forever
+	void writePollingLoop(u32 pc, u32 addr)
+	{
+		const u16 code[] = {
+			// loop:
+			0xD102,		// mov.l @(8, pc), r1
+			0x6012,		// mov.l @r1, r0
+			0xAFFC,		// bra loop
+			0x0009,		// nop
+			0x0009,
+			0x0009,
+			(u16)addr, (u16)(addr >> 16),
+		};
+		for (size_t i = 0; i < ARRAY_SIZE(code); i++)
+			_vmem_WriteMem16(pc + i * 2, code[i]);
+		ctx->pc = pc;
+	}
+
+	// r2 adds the literal to itself each iteration. The loop branches over the literal pool,
+	// so the block at StartPc + 4 is turned into a superblock once it's hot.
+	void writeSuperblockLoop()
+	{
+		static const u16 code[] = {
+			0xE100,		// mov #0, r1
+			0xE200,		// mov #0, r2
+			// loop:
+			0x7101,		// add #1, r1
+			0xD302,		// mov.l @(8, pc), r3
+			0xA004,		// bra part2
+			0x0009,		// nop
+			0x0009,
+			0x0009,
+			0x0003, 0x0000,	// .long 3
+			// part2:
+			0x323C,		// add r3, r2
+			0xAFF5,		// bra loop
+			0x0009,		// nop
+		};
+		for (size_t i = 0; i < ARRAY_SIZE(code); i++)
+			_vmem_WriteMem16(StartPc + i * 2, code[i]);
+		ctx->pc = StartPc;
+	}
+
+	bool isIdleLoop(u32 addr)
+	{
+		// Each loop on its own page so that it isn't compiled with SMC checks
+		const u32 pc = StartPc + (testedLoops++) * PAGE_SIZE;
+		writePollingLoop(pc, addr);
+		run(SH4_TIMESLICE * 4);
+		RuntimeBlockInfoPtr block = bm_GetBlock(pc);
+		return block != nullptr && block->idle_loop;
+	}
+
+	void run(int cycles)
+	{
+		sh4_sched_request(schedId, cycles);
+		sh4.Run();
+	}
+
+	sh4_if sh4;
+	Sh4Context *ctx = nullptr;
+	int schedId = -1;
+	u32 testedLoops = 0;
+};
+
+// Without the fast memory mapping, memory ops go through the software TLB
+class Sh4DynarecNoVmemTest : public Sh4DynarecTest {
+protected:
+	void SetUp() override {
+		settings.dynarec.disable_nvmem = true;
+		// The buffers of the previous tests are in their reserved address space and mustn't be freed
+		p_sh4rcb = nullptr;
+		mem_b.data = nullptr;
+		vram.data = nullptr;
+		aica_ram.data = nullptr;
+		Sh4DynarecTest::SetUp();
+	}
+
+	void TearDown() override {
+		Sh4DynarecTest::TearDown();
+		settings.dynarec.disable_nvmem = false;
+	}
+};
+
+TEST_F(Sh4DynarecTest, CallLoop)
+{
+	writeCallLoop();
+	run(SH4_TIMESLICE * 100);
+
+	// The cpu stops between blocks, so either before or after r1 is incremented
+	u32 calls = ctx->r[1];
+	ASSERT_GT(calls, 100u);
+	ASSERT_TRUE(ctx->r[4] == calls * (calls - 1) / 2 || ctx->r[4] == calls * (calls + 1) / 2);
+	ASSERT_EQ(ctx->r[4], ctx->r[5]);
+	ASSERT_EQ(StackTop, ctx->r[15]);
+	ASSERT_EQ(0u, ctx->r[14]);
+}
+
+TEST_F(Sh4DynarecNoVmemTest, CallLoop)
+{
+	ASSERT_FALSE(_nvmem_enabled());
+	writeCallLoop();
+	prof.counters.memtlb.miss = 0;
+	prof.counters.memtlb.uncached = 0;
+	run(SH4_TIMESLICE * 100);
+
+	u32 calls = ctx->r[1];
+	ASSERT_GT(calls, 100u);
+	ASSERT_TRUE(ctx->r[4] == calls * (calls - 1) / 2 || ctx->r[4] == calls * (calls + 1) / 2);
+	ASSERT_EQ(ctx->r[4], ctx->r[5]);
+	ASSERT_EQ(StackTop, ctx->r[15]);
+#if FEAT_SHREC == DYNAREC_JIT && (HOST_CPU == CPU_X64 || HOST_CPU == CPU_ARM64)
+	// All the stack accesses are in the same page
+	ASSERT_EQ(1u, prof.counters.memtlb.miss);
+	ASSERT_EQ(0u, prof.counters.memtlb.uncached);
+#endif
+}
+
+TEST_F(Sh4DynarecTest, IdleLoop)
+{
+	config::DynarecIdleSkip.override(true);
+	// Changed by scheduler events only
+	ASSERT_TRUE(isIdleLoop(0xA05F6900));	// SB_ISTNRM
+	ASSERT_TRUE(isIdleLoop(0xA05F810C));	// SPG_STATUS
+	ASSERT_TRUE(isIdleLoop(0xFFD80010));	// TMU TCR0
+	// Can change at any time
+	ASSERT_FALSE(isIdleLoop(0xFFD8000C));	// TMU TCNT0
+	ASSERT_FALSE(isIdleLoop(0xA0702C00));	// aica registers
+	ASSERT_FALSE(isIdleLoop(0xA0800000));	// aica ram
+	ASSERT_FALSE(isIdleLoop(0x8C100000));	// system ram
+	config::DynarecIdleSkip.reset();
+}
+
+TEST_F(Sh4DynarecTest, AicaRamThreaded)
+{
+	// The aica ram views are protected once the aica thread starts:
+	// the compiled accesses must fault and go through the area 0 handlers
+	config::ThreadedAica.override(true);
+	static const u16 code[] = {
+		0xD003,		// mov.l @(12, pc), r0
+		0xE100,		// mov #0, r1
+		// loop:
+		0x2012,		// mov.l r1, @r0
+		0x7101,		// add #1, r1
+		0x6202,		// mov.l @r0, r2
+		0xAFFB,		// bra loop
+		0x0009,		// nop
+		0x0009,
+		0x0100, 0xA080,	// .long 0xA0800100
+	};
+	for (size_t i = 0; i < ARRAY_SIZE(code); i++)
+		_vmem_WriteMem16(StartPc + i * 2, code[i]);
+	ctx->pc = StartPc;
+	run(SH4_TIMESLICE * 1000);
+
+	ASSERT_GT(ctx->r[1], 100u);
+	ASSERT_EQ(ctx->r[1] - 1, ctx->r[2]);
+	ASSERT_EQ(ctx->r[2], _vmem_ReadMem32(0x00800100));
+}
+
+TEST_F(Sh4DynarecTest, TBitLoop)
+{
+	writeTBitLoop();
+	run(SH4_TIMESLICE * 100);
+
+	// The cpu stops between blocks, so r4 may already count the current value
+	u32 count = ctx->r[1];
+	ASSERT_GT(count, 100u);
+	ASSERT_TRUE(ctx->r[4] == count / 2 * 2 || ctx->r[4] == (count + 1) / 2 * 2);
+	ASSERT_EQ(0x00040001u, ctx->fpscr.full);
+}
+
+TEST_F(Sh4DynarecTest, Superblock)
+{
+	const u32 loop = StartPc + 4;
+	writeSuperblockLoop();
+	run(SH4_TIMESLICE * 200);
+	RuntimeBlockInfoPtr block = bm_GetBlock(loop);
+	ASSERT_NE(nullptr, block);
+	ASSERT_TRUE(block->superblock);
+	ASSERT_TRUE(block->read_only);
+	// The literal pool that is branched over isn't part of the block
+	ASSERT_EQ(2u, block->sh4_check_ranges.size());
+	ASSERT_EQ(loop, block->sh4_check_ranges[0].addr);
+	ASSERT_EQ(8u, block->sh4_check_ranges[0].size);
+	ASSERT_EQ(StartPc + 0x14, block->sh4_check_ranges[1].addr);
+	ASSERT_EQ(6u, block->sh4_check_ranges[1].size);
+	ASSERT_TRUE(ctx->r[2] == ctx->r[1] * 3 || ctx->r[2] == (ctx->r[1] - 1) * 3);
+
+	// Writing to the protected page discards the block, which must be sampled again to be a superblock
+	_vmem_WriteMem32(StartPc + 0x10, 5);
+	ASSERT_EQ(nullptr, bm_GetBlock(loop));
+	run(SH4_TIMESLICE * 4);
+	block = bm_GetBlock(loop);
+	ASSERT_NE(nullptr, block);
+	ASSERT_FALSE(block->superblock);
+
+	// Now compiled with SMC checks, that don't cover the literal pool
+	run(SH4_TIMESLICE * 200);
+	block = bm_GetBlock(loop);
+	ASSERT_NE(nullptr, block);
+	ASSERT_TRUE(block->superblock);
+	ASSERT_FALSE(block->read_only);
+	ASSERT_EQ(2u, block->sh4_check_ranges.size());
+	_vmem_WriteMem32(StartPc + 0x10, 7);
+	u32 r1 = ctx->r[1];
+	u32 r2 = ctx->r[2];
+	run(SH4_TIMESLICE * 4);
+	ASSERT_EQ(block, bm_GetBlock(loop));
+	u32 iterations = ctx->r[1] - r1;
+	ASSERT_GT(iterations, 0u);
+	ASSERT_EQ(r2 + iterations * 7, ctx->r[2]);
+}
+
+// Run with --gtest_also_run_disabled_tests
+TEST_F(Sh4DynarecTest, DISABLED_TBitLoopBenchmark)
+{
+	for (int safeMode = 1; safeMode >= 0; safeMode--)
+	{
+		config::DynarecSafeMode.override(safeMode);
+		// Rewriting the code of the previous run would add SMC checks to the blocks
+		const u32 pc = StartPc + safeMode * PAGE_SIZE;
+		writeTBitLoop(pc);
+		// Compile the blocks first
+		run(SH4_TIMESLICE);
+		std::set<RuntimeBlockInfoPtr> blocks;
+		for (u32 addr = pc; addr < pc + 0x24; addr += 2)
+		{
+			RuntimeBlockInfoPtr block = bm_GetBlock(addr);
+			if (block != nullptr)
+				blocks.insert(block);
+		}
+		u32 count = ctx->r[1];
+		auto start = std::chrono::steady_clock::now();
+		run(SH4_MAIN_CLOCK);
+		double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		count = ctx->r[1] - count;
+		printf("SH4 dynarec, T bit loop%s: %.1f M iterations/s, %u blocks",
+				safeMode ? " (safe mode)" : "", count / s / 1e6, (u32)blocks.size());
+#if FEAT_SHREC == DYNAREC_JIT
+		// The C++ backend has no host code
+		u32 codeSize = 0;
+		for (const RuntimeBlockInfoPtr& block : blocks)
+			codeSize += block->host_code_size;
+		printf(", %u bytes of host code", codeSize);
+#endif
+		printf("\n");
+	}
+	config::DynarecSafeMode.override(false);
+}
+
+// Run with --gtest_also_run_disabled_tests
+TEST_F(Sh4DynarecTest, DISABLED_CallLoopBenchmark)
+{
+	writeCallLoop();
+	// Compile the blocks first
+	run(SH4_TIMESLICE);
+	u32 calls = ctx->r[1];
+	auto start = std::chrono::steady_clock::now();
+	run(SH4_MAIN_CLOCK);
+	double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	calls = ctx->r[1] - calls;
+	printf("SH4 dynarec, call loop: %.1f M calls/s, %.0f ms per emulated second\n", calls / s / 1e6, s * 1e3);
+}
+
+// Run with --gtest_also_run_disabled_tests
+TEST_F(Sh4DynarecTest, DISABLED_IdleLoopBenchmark)
+{
+	for (int idleSkip = 0; idleSkip <= 1; idleSkip++)
+	{
+		config::DynarecIdleSkip.override(idleSkip);
+		const u32 pc = StartPc + idleSkip * PAGE_SIZE;
+		writePollingLoop(pc, 0xA05F6900);
+		run(SH4_TIMESLICE);
+		auto start = std::chrono::steady_clock::now();
+		run(SH4_MAIN_CLOCK);
+		double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		printf("SH4 dynarec, SB_ISTNRM polling loop%s: %.1f ms per emulated second\n",
+				idleSkip ? " (idle skip)" : "", s * 1e3);
+	}
+	config::DynarecIdleSkip.reset();
+}
+
+// Run with --gtest_also_run_disabled_tests
+TEST_F(Sh4DynarecNoVmemTest, DISABLED_CallLoopBenchmark)
+{
+	writeCallLoop();
+	run(SH4_TIMESLICE);
+	u32 calls = ctx->r[1];
+	prof.counters.memtlb.miss = 0;
+	auto start = std::chrono::steady_clock::now();
+	run(SH4_MAIN_CLOCK);
+	double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	calls = ctx->r[1] - calls;
+	// 8 memory accesses per call
+	printf("SH4 dynarec without fast mmap, call loop: %.1f M calls/s, %u TLB misses in %u accesses\n",
+			calls / s / 1e6, prof.counters.memtlb.miss, calls * 8);
+}
+
+#endif
@@ -19,6 +19,9 @@
 #include "sh4_ops.h"
 #include "emulator.h"
 #include "hw/sh4/sh4_mem.h"
+#include "hw/sh4/sh4_sched.h"
+#include "hw/sh4/sh4_interpreter.h"
+#include "oslib/oslib.h"
 
 class Sh4InterpreterTest : public Sh4OpTest {
 protected:
@@ -31,6 +34,13 @@ protected:
 		ctx = &p_sh4rcb->cntx;
 		Get_Sh4Interpreter(&sh4);
 	}
+	void TearDown() override
+	{
+		if (schedId != -1)
+			sh4_sched_unregister(schedId);
+		if (faultHandlerInstalled)
+			os_UninstallFaultHandler();
+	}
 	void PrepareOp(u16 op, u16 op2 = 0, u16 op3 = 0) override
 	{
 		ctx->pc = START_PC;
@@ -46,6 +56,9 @@ protected:
 		for (int i = 0; i < numOp; i++)
 			sh4.Step();
 	}
+
+	int schedId = -1;
+	bool faultHandlerInstalled = false;
 };
 
 TEST_F(Sh4InterpreterTest, MovRmRnTest)
@@ -89,3 +102,40 @@ TEST_F(Sh4InterpreterTest, CmpTest)
 	Sh4OpTest::CmpTest();
 }
 
+static sh4_if *runningCpu;
+
+static int stopCpu(int tag, int cycles, int jitter)
+{
+	runningCpu->Stop();
+	return 0;
+}
+
+// Run the interpreter main loop so that the decode cache is used
+TEST_F(Sh4InterpreterTest, DecodeCacheTest)
+{
+	// SetUp reserves a new address space for each test but RAM is still mapped in the first one
+	_vmem_init_mappings();
+	mem_map_default();
+	os_InstallFaultHandler();
+	faultHandlerInstalled = true;
+	runningCpu = &sh4;
+	schedId = sh4_sched_register(0, stopCpu);
+	const u32 loopPc = 0x8C010000;
+	_vmem_WriteMem16(loopPc, 0x7101);		// add #1, r1
+	_vmem_WriteMem16(loopPc + 2, 0xAFFD);	// bra loopPc
+	_vmem_WriteMem16(loopPc + 4, 0x0009);	// nop
+
+	ctx->pc = loopPc;
+	ctx->r[1] = 0;
+	sh4_sched_request(schedId, SH4_TIMESLICE * 10);
+	sh4.Run();
+	ASSERT_GT(ctx->r[1], 1u);
+
+	// The page is write-protected and must be decoded again
+	_vmem_WriteMem16(loopPc, 0xE12A);		// mov #42, r1
+	ctx->pc = loopPc;
+	ctx->r[1] = 0;
+	sh4_sched_request(schedId, SH4_TIMESLICE * 10);
+	sh4.Run();
+	ASSERT_EQ(ctx->r[1], 42u);
+}
@@ -0,0 +1,76 @@
+#include "gtest/gtest.h"
+#include "types.h"
+#include "rend/shader_cache.h"
+#include "cfg/option.h"
+#include "stdclass.h"
+#include "oslib/oslib.h"
+
+#include <cstdio>
+#include <cstring>
+
+class ShaderCacheTest : public ::testing::Test {
+protected:
+	void SetUp() override {
+		set_user_data_dir(::testing::TempDir());
+		strcpy(settings.imgread.ImagePath, "shader_cache_test.gdi");
+		config::ShaderPrecompile.override(true);
+		path = hostfs::getShaderCachePath(Suffix);
+		std::remove(path.c_str());
+	}
+
+	void TearDown() override {
+		std::remove(path.c_str());
+		settings.imgread.ImagePath[0] = '\0';
+		config::ShaderPrecompile.reset();
+	}
+
+	// Saves a key without data and a key with a binary
+	void saveCache(u32 tag)
+	{
+		ShaderCache cache(Suffix);
+		cache.setBinaryTag(tag);
+		cache.load();
+		cache.add(1);
+		cache.setData(2, 0x1234, std::vector<u8>{ 1, 2, 3 });
+		cache.save();
+	}
+
+	const char *Suffix = ".testcache";
+	std::string path;
+};
+
+TEST_F(ShaderCacheTest, SameTag)
+{
+	saveCache(42);
+	ShaderCache cache(Suffix);
+	cache.setBinaryTag(42);
+	cache.load();
+	const auto& entries = cache.getEntries();
+	ASSERT_EQ(2u, entries.size());
+	ASSERT_TRUE(entries.at(1).data.empty());
+	ASSERT_EQ(0x1234u, entries.at(2).format);
+	ASSERT_EQ((std::vector<u8>{ 1, 2, 3 }), entries.at(2).data);
+}
+
+TEST_F(ShaderCacheTest, OtherTag)
+{
+	// Binaries from another driver or other shader sources are dropped
+	saveCache(42);
+	ShaderCache cache(Suffix);
+	cache.setBinaryTag(43);
+	cache.load();
+	const auto& entries = cache.getEntries();
+	ASSERT_EQ(2u, entries.size());
+	ASSERT_TRUE(entries.at(1).data.empty());
+	ASSERT_TRUE(entries.at(2).data.empty());
+
+	// The tag changes once the cache is loaded
+	saveCache(42);
+	ShaderCache cache2(Suffix);
+	cache2.setBinaryTag(42);
+	cache2.load();
+	ASSERT_FALSE(cache2.getEntries().at(2).data.empty());
+	cache2.setBinaryTag(43);
+	ASSERT_EQ(2u, cache2.getEntries().size());
+	ASSERT_TRUE(cache2.getEntries().at(2).data.empty());
+}
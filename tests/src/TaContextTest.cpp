@@ -0,0 +1,47 @@
+#include "gtest/gtest.h"
+#include "types.h"
+#include "hw/pvr/ta_ctx.h"
+
+class TaContextTest : public ::testing::Test {
+protected:
+	void SetUp() override {
+		tactx_Term();
+	}
+
+	void TearDown() override {
+		tactx_Term();
+	}
+};
+
+TEST_F(TaContextTest, RegrowOnAlloc)
+{
+	TA_context *ctx = tactx_Alloc();
+	u8 *root = ctx->tad.thd_root;
+	int passes = ctx->rend.render_passes.size;
+	u32 regrows = tactx_GetArenaStats().regrows;
+
+	// A frame needing more render passes than available
+	ctx->rend.render_passes.overrun_size = passes * 2;
+	ctx->rend.Overrun = true;
+	// The TA state may still point into the arena: Reset must not reallocate it
+	ctx->Reset();
+	ASSERT_EQ(root, ctx->tad.thd_root);
+	ASSERT_EQ(passes, ctx->rend.render_passes.size);
+
+	tactx_Recycle(ctx);
+	ASSERT_EQ(root, ctx->tad.thd_root);
+
+	// The pooled context is reallocated when it's reused
+	TA_context *ctx2 = tactx_Alloc();
+	ASSERT_EQ(ctx, ctx2);
+	ASSERT_GE(ctx2->rend.render_passes.size, passes * 2);
+	ASSERT_EQ(ctx2->tad.thd_root, ctx2->arena);
+	ASSERT_EQ(ctx2->rend.proc_start, ctx2->tad.thd_root);
+	ASSERT_EQ(regrows + 1, tactx_GetArenaStats().regrows);
+
+	// Large enough now
+	tactx_Recycle(ctx2);
+	TA_context *ctx3 = tactx_Alloc();
+	ASSERT_EQ(regrows + 1, tactx_GetArenaStats().regrows);
+	tactx_Recycle(ctx3);
+}
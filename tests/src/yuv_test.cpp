@@ -0,0 +1,87 @@
+#include "gtest/gtest.h"
+#include "types.h"
+#include "hw/pvr/yuv_conv.h"
+
+#include <cstdlib>
+#include <vector>
+
+class YuvTest : public ::testing::Test {
+protected:
+	void SetUp() override {
+		srand(42);
+		for (u8& b : in)
+			b = (u8)rand();
+	}
+
+	// Converts a macroblock in the middle of a 32x16 texture with both converters
+	void compare(void (*convert)(const u8 *, u8 *, u32), void (*scalar)(const u8 *, u8 *, u32))
+	{
+		const u32 stride = 32 * 2;
+		std::vector<u8> out(stride * 16 + 16, 0xcc);
+		std::vector<u8> ref(stride * 16 + 16, 0xcc);
+		// Unaligned destination
+		convert(in, &out[8], stride);
+		scalar(in, &ref[8], stride);
+		ASSERT_EQ(ref, out);
+	}
+
+	u8 in[512];
+};
+
+TEST_F(YuvTest, Yuv420Layout)
+{
+	const u32 stride = 16 * 2;
+	u8 out[stride * 16];
+	YUV420_ConvertScalar(in, out, stride);
+	const u8 *u = &in[0];
+	const u8 *v = &in[64];
+	const u8 *y = &in[128];
+	// top-left texel pair
+	ASSERT_EQ(u[0], out[0]);
+	ASSERT_EQ(y[0], out[1]);
+	ASSERT_EQ(v[0], out[2]);
+	ASSERT_EQ(y[1], out[3]);
+	// second line shares the chroma samples
+	ASSERT_EQ(u[0], out[stride]);
+	ASSERT_EQ(y[8], out[stride + 1]);
+	// top-right block
+	ASSERT_EQ(u[4], out[16]);
+	ASSERT_EQ(y[64], out[17]);
+	// bottom-left block
+	ASSERT_EQ(u[32], out[stride * 8]);
+	ASSERT_EQ(y[128], out[stride * 8 + 1]);
+	// bottom-right texel pair
+	ASSERT_EQ(u[63], out[stride * 15 + 28]);
+	ASSERT_EQ(y[254], out[stride * 15 + 29]);
+	ASSERT_EQ(v[63], out[stride * 15 + 30]);
+	ASSERT_EQ(y[255], out[stride * 15 + 31]);
+}
+
+TEST_F(YuvTest, Yuv422Layout)
+{
+	const u32 stride = 16 * 2;
+	u8 out[stride * 16];
+	YUV422_ConvertScalar(in, out, stride);
+	const u8 *u = &in[0];
+	const u8 *v = &in[128];
+	const u8 *y = &in[256];
+	ASSERT_EQ(u[0], out[0]);
+	ASSERT_EQ(y[0], out[1]);
+	ASSERT_EQ(v[0], out[2]);
+	ASSERT_EQ(y[1], out[3]);
+	// one chroma line per texel line
+	ASSERT_EQ(u[8], out[stride]);
+	ASSERT_EQ(v[8], out[stride + 2]);
+	ASSERT_EQ(u[127], out[stride * 15 + 28]);
+	ASSERT_EQ(y[255], out[stride * 15 + 31]);
+}
+
+TEST_F(YuvTest, Yuv420Simd)
+{
+	compare(YUV420_Convert, YUV420_ConvertScalar);
+}
+
+TEST_F(YuvTest, Yuv422Simd)
+{
+	compare(YUV422_Convert, YUV422_ConvertScalar);
+}